@@ -0,0 +1,501 @@
+/*
+ * benchuarray2.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/17/2026
+ *
+ * Purpose: Times UArray2 storage layouts against each other.
+ *          Runs a 3x3 box-sum stencil over a grid of ints stored
+ *          row-major (UArray2_new) and in Morton order
+ *          (UArray2_new_morton), once visiting cells row by row
+ *          and once in each array's storage order, and prints
+ *          nanoseconds per cell for each combination. Then runs
+ *          a relaxation that allocates a fresh grid per iteration
+ *          against a Pingpong_T, serially and on the shared pool.
+ *          Then sums one field of a grid of structs stored as an
+ *          array of structs and as a UArray2soa_T. Last, walks
+ *          16384-wide arrays and bitmaps column by column with and
+ *          without software prefetching, at several distances.
+ *
+ * Usage: benchuarray2 [width height [repeats]]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <time.h>
+#include "uarray2.h"
+#include "uarray2soa.h"
+#include "bit2.h"
+#include "pingpong.h"
+#include "pool.h"
+
+#define RELAX_ITERATIONS 50
+#define WIDE_COLS 16384       /* width of the column-walk arrays */
+#define WIDE_ROWS 2048        /* height of the column-walk arrays */
+
+/*
+ * Closure for the stencil apply function: the grid being read
+ * and a running checksum, so the work cannot be optimized away.
+ */
+typedef struct Stencil {
+        UArray2_T grid;
+        long sum;
+} Stencil;
+
+/*
+ * A multi-field element, as a distance transform might keep per
+ * cell. A pass reading only dist uses 8 of its 24 bytes.
+ */
+typedef struct Cell {
+        int label;
+        double dist;
+        unsigned flags;
+} Cell;
+
+/*
+ * name: now
+ *
+ * description: Returns a monotonic timestamp in seconds.
+ */
+static double now(void)
+{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*
+ * name: box_sum
+ *
+ * description: Apply function that adds the 3x3 neighbourhood of
+ * every interior cell to the checksum, reading each neighbour
+ * through UArray2_at.
+ */
+static void box_sum(int col, int row, UArray2_T grid, void *elem,
+                    void *cl)
+{
+        Stencil *st = cl;
+        (void)elem;
+
+        if (col == 0 || row == 0 || col == UArray2_width(grid) - 1 ||
+            row == UArray2_height(grid) - 1) {
+                return;
+        }
+        for (int dr = -1; dr <= 1; dr++) {
+                for (int dc = -1; dc <= 1; dc++) {
+                        st->sum += *(int *)UArray2_at(grid, col + dc,
+                                                      row + dr);
+                }
+        }
+}
+
+/*
+ * name: fill_cell
+ *
+ * description: Apply function giving each cell a value derived
+ * from its position.
+ */
+static void fill_cell(int col, int row, UArray2_T grid, void *elem,
+                      void *cl)
+{
+        (void)grid;
+        (void)cl;
+        *(int *)elem = (col * 31 + row * 17) & 0xff;
+}
+
+/*
+ * name: time_map
+ *
+ * description: Runs the stencil over grid repeats times with the
+ * given map function and prints nanoseconds per cell.
+ */
+static void time_map(const char *label, UArray2_T grid,
+                     void map(UArray2_T, UArray2_applyfun *, void *),
+                     int repeats)
+{
+        Stencil st = { grid, 0 };
+        double start = now();
+
+        for (int i = 0; i < repeats; i++) {
+                map(grid, box_sum, &st);
+        }
+
+        double seconds = now() - start;
+        double cells = (double)UArray2_width(grid) *
+                       UArray2_height(grid) * repeats;
+        printf("%-28s %8.2f ns/cell  (checksum %ld)\n", label,
+               1e9 * seconds / cells, st.sum);
+}
+
+/*
+ * name: relax_band
+ *
+ * description: Band function for one relaxation step: each cell
+ * of back becomes the average of its four neighbours in front,
+ * which are read through the ghost border at the edges.
+ */
+static void relax_band(UArray2_T front, UArray2_T back, int row0,
+                       int row1, void *cl)
+{
+        const char *src = UArray2_base(front);
+        char *dst  = UArray2_base(back);
+        long pitch = UArray2_pitch(front);
+        int width  = UArray2_width(front);
+        (void)cl;
+
+        for (int row = row0; row < row1; row++) {
+                const char *line = src + row * pitch;
+                const int *up   = (const int *)(line - pitch);
+                const int *mid  = (const int *)line;
+                const int *down = (const int *)(line + pitch);
+                int *out        = (int *)(dst + row * pitch);
+                for (int col = 0; col < width; col++) {
+                        out[col] = (up[col] + down[col] + mid[col - 1] +
+                                    mid[col + 1]) / 4;
+                }
+        }
+}
+
+/*
+ * name: relax_cell
+ *
+ * description: Apply function for the allocating relaxation: sets
+ * one cell of the new grid (the closure) from its clamped
+ * neighbours in the old one.
+ */
+static void relax_cell(int col, int row, UArray2_T old, void *elem,
+                       void *cl)
+{
+        UArray2_T new = cl;
+        int w = UArray2_width(old) - 1;
+        int h = UArray2_height(old) - 1;
+        int sum = *(int *)UArray2_at(old, col, row > 0 ? row - 1 : 0) +
+                  *(int *)UArray2_at(old, col, row < h ? row + 1 : h) +
+                  *(int *)UArray2_at(old, col > 0 ? col - 1 : 0, row) +
+                  *(int *)UArray2_at(old, col < w ? col + 1 : w, row);
+        (void)elem;
+        *(int *)UArray2_at(new, col, row) = sum / 4;
+}
+
+/*
+ * name: checksum
+ *
+ * description: Returns the sum of every element of an int grid.
+ */
+static long checksum(UArray2_T grid)
+{
+        long sum = 0;
+        for (int row = 0; row < UArray2_height(grid); row++) {
+                for (int col = 0; col < UArray2_width(grid); col++) {
+                        sum += *(int *)UArray2_at(grid, col, row);
+                }
+        }
+        return sum;
+}
+
+/*
+ * name: time_relax
+ *
+ * description: Runs RELAX_ITERATIONS relaxation steps starting
+ * from a copy of grid, first allocating and copying a new grid on
+ * every step, then on a Pingpong_T serially and on the shared
+ * pool, and prints nanoseconds per cell-step for each.
+ */
+static void time_relax(UArray2_T grid)
+{
+        int width  = UArray2_width(grid);
+        int height = UArray2_height(grid);
+        double cells = (double)width * height * RELAX_ITERATIONS;
+
+        double start = now();
+        UArray2_T old = UArray2_new(width, height, sizeof(int));
+        UArray2_copy(old, grid);
+        for (int i = 0; i < RELAX_ITERATIONS; i++) {
+                UArray2_T new = UArray2_new(width, height, sizeof(int));
+                UArray2_map_row_major(old, relax_cell, new);
+                UArray2_free(&old);
+                old = new;
+        }
+        double seconds = now() - start;
+        printf("%-28s %8.2f ns/cell  (checksum %ld)\n",
+               "relax, new grid per step", 1e9 * seconds / cells,
+               checksum(old));
+        UArray2_free(&old);
+
+        Pool_T pools[2] = { NULL, Pool_shared() };
+        for (int p = 0; p < 2; p++) {
+                char label[40];
+                Pingpong_T pair = Pingpong_new(width, height,
+                                               sizeof(int), 1);
+                UArray2_copy(Pingpong_front(pair), grid);
+
+                start = now();
+                Pingpong_iterate(pair, RELAX_ITERATIONS,
+                                 UARRAY2_BORDER_CLAMP, relax_band, NULL,
+                                 pools[p]);
+                seconds = now() - start;
+
+                snprintf(label, sizeof(label), "relax, pingpong x%d",
+                         pools[p] == NULL ? 1 : Pool_size(pools[p]));
+                printf("%-28s %8.2f ns/cell  (checksum %ld)\n", label,
+                       1e9 * seconds / cells,
+                       checksum(Pingpong_front(pair)));
+                Pingpong_free(&pair);
+        }
+}
+
+/*
+ * name: time_one_field
+ *
+ * description: Sums the dist field of a width-by-height grid of
+ * Cells, stored first as a UArray2 of Cells and then as a
+ * UArray2soa_T with one plane per field, and prints nanoseconds
+ * per cell for each.
+ */
+static void time_one_field(int width, int height, int repeats)
+{
+        UArray2soa_field fields[] = {
+                { offsetof(Cell, label), sizeof(int) },
+                { offsetof(Cell, dist),  sizeof(double) },
+                { offsetof(Cell, flags), sizeof(unsigned) }
+        };
+        UArray2_T aos   = UArray2_new(width, height, sizeof(Cell));
+        UArray2soa_T soa = UArray2soa_new(width, height, sizeof(Cell),
+                                          fields, 3);
+        for (int row = 0; row < height; row++) {
+                for (int col = 0; col < width; col++) {
+                        Cell cell = { col, (double)(col ^ row), 0 };
+                        *(Cell *)UArray2_at(aos, col, row) = cell;
+                        UArray2soa_put(soa, col, row, &cell);
+                }
+        }
+        double cells = (double)width * height * repeats;
+
+        double sum   = 0;
+        double start = now();
+        for (int r = 0; r < repeats; r++) {
+                for (int row = 0; row < height; row++) {
+                        const Cell *line = UArray2_at(aos, 0, row);
+                        for (int col = 0; col < width; col++) {
+                                sum += line[col].dist;
+                        }
+                }
+        }
+        printf("%-28s %8.2f ns/cell  (checksum %.0f)\n",
+               "one field, array of structs",
+               1e9 * (now() - start) / cells, sum);
+
+        sum   = 0;
+        start = now();
+        for (int r = 0; r < repeats; r++) {
+                for (int row = 0; row < height; row++) {
+                        const double *line = UArray2soa_row(soa, 1,
+                                                            row);
+                        for (int col = 0; col < width; col++) {
+                                sum += line[col];
+                        }
+                }
+        }
+        printf("%-28s %8.2f ns/cell  (checksum %.0f)\n",
+               "one field, UArray2soa",
+               1e9 * (now() - start) / cells, sum);
+
+        UArray2soa_free(&soa);
+        UArray2_free(&aos);
+}
+
+/*
+ * name: set_first_byte
+ *
+ * description: Apply function storing a position-derived byte in
+ * the first byte of each element, so every page is touched
+ * before a walk is timed.
+ */
+static void set_first_byte(int col, int row, UArray2_T grid,
+                           void *elem, void *cl)
+{
+        (void)grid;
+        (void)cl;
+        *(unsigned char *)elem = (unsigned char)(col ^ row);
+}
+
+/*
+ * name: set_bit
+ *
+ * description: Bit2 apply function setting every third bit, which
+ * also touches every page before a walk is timed.
+ */
+static void set_bit(int col, int row, Bit2_T bit2, int elem, void *cl)
+{
+        (void)elem;
+        (void)cl;
+        Bit2_put(bit2, col, row, (col + row) % 3 == 0);
+}
+
+/*
+ * name: add_first_byte
+ *
+ * description: Apply function adding the first byte of each
+ * element to the long at cl, so a walk does little besides load.
+ */
+static void add_first_byte(int col, int row, UArray2_T grid,
+                           void *elem, void *cl)
+{
+        (void)col;
+        (void)row;
+        (void)grid;
+        *(long *)cl += *(unsigned char *)elem;
+}
+
+/*
+ * name: add_bit
+ *
+ * description: Bit2 apply function adding each bit to the long at
+ * cl.
+ */
+static void add_bit(int col, int row, Bit2_T bit2, int elem,
+                    void *cl)
+{
+        (void)col;
+        (void)row;
+        (void)bit2;
+        *(long *)cl += elem;
+}
+
+/*
+ * name: print_walk
+ *
+ * description: Prints one line of the column-walk table: time per
+ * cell and speedup over the walk without prefetching.
+ */
+static void print_walk(const char *label, double seconds,
+                       double baseline, double cells, long sum)
+{
+        printf("%-28s %8.2f ns/cell  x%.2f  (checksum %ld)\n", label,
+               1e9 * seconds / cells, baseline / seconds, sum);
+}
+
+/*
+ * name: time_col_prefetch
+ *
+ * description: Walks WIDE_COLS x WIDE_ROWS arrays of 1-, 4-, 8-
+ * and 16-byte elements, and a bitmap of the same size, in
+ * column-major order: with the plain map, with the prefetching
+ * map's loop but no prefetches, and with the prefetching map at a
+ * range of distances (0 is the default for the element size).
+ * Speedups are over the loop without prefetches, so they measure
+ * prefetching alone. These runs chose the defaults in uarray2.c
+ * and bit2.c.
+ */
+static void time_col_prefetch(void)
+{
+        static const int sizes[] = { 1, 4, 8, 16 };
+        static const int distances[] = { 0, 4, 8, 16, 32, 64 };
+        int ndistances = sizeof(distances) / sizeof(distances[0]);
+        double cells = (double)WIDE_COLS * WIDE_ROWS;
+        char label[40];
+
+        printf("column walks over %d x %d\n", WIDE_COLS, WIDE_ROWS);
+        for (int i = 0; i < (int)(sizeof(sizes) / sizeof(sizes[0]));
+             i++) {
+                UArray2_T grid = UArray2_new(WIDE_COLS, WIDE_ROWS,
+                                             sizes[i]);
+                UArray2_map_row_major(grid, set_first_byte, NULL);
+                long sum = 0;
+                double start = now();
+                UArray2_map_col_major(grid, add_first_byte, &sum);
+                double plain = now() - start;
+
+                /* A lead of the full height never prefetches */
+                sum   = 0;
+                start = now();
+                UArray2_map_col_major_prefetch(grid, add_first_byte,
+                                               &sum, WIDE_ROWS);
+                double baseline = now() - start;
+                snprintf(label, sizeof(label), "%2d-byte, plain map",
+                         sizes[i]);
+                print_walk(label, plain, baseline, cells, sum);
+                snprintf(label, sizeof(label), "%2d-byte, no prefetch",
+                         sizes[i]);
+                print_walk(label, baseline, baseline, cells, sum);
+
+                for (int d = 0; d < ndistances; d++) {
+                        sum   = 0;
+                        start = now();
+                        UArray2_map_col_major_prefetch(grid,
+                                                       add_first_byte,
+                                                       &sum,
+                                                       distances[d]);
+                        snprintf(label, sizeof(label),
+                                 "%2d-byte, prefetch %d", sizes[i],
+                                 distances[d]);
+                        print_walk(label, now() - start, baseline,
+                                   cells, sum);
+                }
+                UArray2_free(&grid);
+        }
+
+        Bit2_T bits = Bit2_new(WIDE_COLS, WIDE_ROWS);
+        Bit2_map_row_major(bits, set_bit, NULL);
+        long sum = 0;
+        double start = now();
+        Bit2_map_col_major(bits, add_bit, &sum);
+        double plain = now() - start;
+
+        sum   = 0;
+        start = now();
+        Bit2_map_col_major_prefetch(bits, add_bit, &sum, WIDE_ROWS);
+        double baseline = now() - start;
+        print_walk("bits, plain map", plain, baseline, cells, sum);
+        print_walk("bits, no prefetch", baseline, baseline, cells, sum);
+        for (int d = 0; d < ndistances; d++) {
+                sum   = 0;
+                start = now();
+                Bit2_map_col_major_prefetch(bits, add_bit, &sum,
+                                            distances[d]);
+                snprintf(label, sizeof(label), "bits, prefetch %d",
+                         distances[d]);
+                print_walk(label, now() - start, baseline, cells, sum);
+        }
+        Bit2_free(&bits);
+}
+
+int main(int argc, char *argv[])
+{
+        int width   = argc > 2 ? atoi(argv[1]) : 2048;
+        int height  = argc > 2 ? atoi(argv[2]) : 2048;
+        int repeats = argc > 3 ? atoi(argv[3]) : 3;
+
+        if (width < 3 || height < 3 || repeats < 1) {
+                fprintf(stderr, "Usage: %s [width height [repeats]]\n",
+                        argv[0]);
+                return EXIT_FAILURE;
+        }
+
+        UArray2_T flat   = UArray2_new(width, height, sizeof(int));
+        UArray2_T morton = UArray2_new_morton(width, height,
+                                              sizeof(int));
+        UArray2_map_row_major(flat, fill_cell, NULL);
+        UArray2_map_row_major(morton, fill_cell, NULL);
+
+        printf("3x3 stencil over %d x %d ints, %d repeat(s)\n", width,
+               height, repeats);
+        time_map("row-major, row order", flat, UArray2_map_row_major,
+                 repeats);
+        time_map("morton, row order", morton, UArray2_map_row_major,
+                 repeats);
+        time_map("row-major, storage order", flat,
+                 UArray2_map_storage_order, repeats);
+        time_map("morton, storage order", morton,
+                 UArray2_map_storage_order, repeats);
+        time_relax(flat);
+        time_one_field(width, height, repeats);
+        time_col_prefetch();
+
+        UArray2_free(&morton);
+        UArray2_free(&flat);
+        return EXIT_SUCCESS;
+}
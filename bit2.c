@@ -4,29 +4,88 @@
  * Authors: Toye Adebayo & Teny Makuach
  * Date: 2/2/2026
  *
- * Purpose: Implements Bit2, a 2D bitmap built on top of
- *          Hanson's 1D Bit_T. Provides functions to create and
- *          free a bitmap, query its dimensions, get and put
- *          individual bits, and traverse all bits in row-major
- *          or column-major order.
+ * Purpose: Implements Bit2, a 2D bitmap of packed bits.
+ *          Provides functions to create and free a bitmap, query
+ *          its dimensions, get and put individual bits, and
+ *          traverse all bits in row-major or column-major order.
  *
- * Key Insight: The 2D bitmap is stored as one flat Bit_T
- *          vector. Each (col, row) maps to the 1D index
- *          row * width + col.
+ * Key Insight: The bitmap is stored as rows of 64-bit words,
+ *          each row starting on a new word (see bit2rep.h). Owning
+ *          the words, rather than going through Hanson's Bit_T,
+ *          lets bit access be inlined and lets whole words be
+ *          shifted and counted at once.
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdlib.h>
-#include "bit2.h"
-#include "bit.h"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stddef.h>
+#include "bit2rep.h"
+#include "pool.h"
+#include "pages.h"
 #include "mem.h"
 #include "assert.h"
 
+#define PARALLEL_CELLS 65536   /* fewer cells: no thread pool */
+#define BANDS_PER_THREAD 4     /* row bands per pool thread */
+#define CACHE_LINE 64          /* bytes; keeps accumulators apart */
+#define PREFETCH_AHEAD 16      /* coordinates prefetched ahead */
+#define PREFETCH_ROWS 4        /* rows ahead in column walks */
+#define SORT_COORDS 4096       /* fewer coordinates: no row sort */
+#define SORT_BYTES (1L << 20)  /* smaller bitmaps: no row sort */
+#define SNAP_MAGIC 0x53325442u /* "BT2S" read little-endian */
+#define SNAP_VERSION 1u
+#define SNAP_HEADER 4096       /* one page; the words follow */
+
+#if defined(__GNUC__)
+#define PREFETCH(addr, write) __builtin_prefetch((addr), (write))
+#else
+#define PREFETCH(addr, write) ((void)0)
+#endif
+
 #define T Bit2_T
-struct T {
-        int width;
-        int height;
-        Bit_T data;
-};
+
+/*
+ * Header of a file written by Bit2_save. The words follow at
+ * offset SNAP_HEADER, exactly as they are laid out in memory.
+ */
+typedef struct Snap_header {
+        uint32_t magic;
+        uint32_t version;
+        int32_t width;
+        int32_t height;
+        int32_t words_per_row;
+        int32_t unused;
+        uint64_t payload;     /* bytes after the header */
+        uint64_t checksum;    /* checksum of the payload */
+        uint64_t header_sum;  /* checksum of the fields above */
+} Snap_header;
+
+/*
+ * One first-touch zeroing by Bit2_new_flags.
+ */
+typedef struct Touch {
+        T bit2;
+        int nbands;
+} Touch;
+
+/*
+ * One Bit2_reduce, shared by its pool tasks. Thread t folds its
+ * rows into the accumulator at accs + t * acc_stride.
+ */
+typedef struct Reduce {
+        T bit2;
+        int nbands;
+        char *accs;
+        long acc_stride;
+        Bit2_reducefun *per_bit;
+        void *cl;
+} Reduce;
 
 /*
  * Bit2_new - see bit2.h for contract
@@ -38,13 +97,88 @@ T Bit2_new(int width, int height)
 
         T bit2;
         NEW(bit2);
-        bit2->width  = width;
-        bit2->height = height;
-        bit2->data   = Bit_new(width * height);
+        bit2->width         = width;
+        bit2->height        = height;
+        bit2->words_per_row = (width + BIT2_WORD_BITS - 1) /
+                              BIT2_WORD_BITS;
+        bit2->words         = CALLOC((long)height * bit2->words_per_row,
+                                     sizeof(uint64_t));
+        bit2->map           = NULL;
+        bit2->map_length    = 0;
+        bit2->paged         = 0;
 
         return bit2;
 }
 
+/*
+ * name: touch_rows
+ *
+ * description: Pool task zeroing the words of row band index, so
+ * their pages are first touched by the thread that Bit2_reduce
+ * and the conversions give those rows to.
+ */
+static void touch_rows(int index, int thread, void *cl)
+{
+        Touch *job = cl;
+        T bit2     = job->bit2;
+        long row0  = (long)bit2->height * index / job->nbands;
+        long row1  = (long)bit2->height * (index + 1) / job->nbands;
+        (void)thread;
+
+        memset(bit2->words + row0 * bit2->words_per_row, 0,
+               (row1 - row0) * bit2->words_per_row * sizeof(uint64_t));
+}
+
+/*
+ * Bit2_new_flags - see bit2.h for contract
+ */
+T Bit2_new_flags(int width, int height, int flags)
+{
+        assert(width > 0);
+        assert(height > 0);
+        assert((flags & ~(BIT2_ALLOC_HUGEPAGE |
+                          BIT2_ALLOC_POPULATE |
+                          BIT2_ALLOC_FIRST_TOUCH)) == 0);
+        assert(!((flags & BIT2_ALLOC_POPULATE) &&
+                 (flags & BIT2_ALLOC_FIRST_TOUCH)));
+
+        T bit2;
+        NEW(bit2);
+        bit2->width         = width;
+        bit2->height        = height;
+        bit2->words_per_row = (width + BIT2_WORD_BITS - 1) /
+                              BIT2_WORD_BITS;
+
+        int page_flags = 0;
+        if (flags & BIT2_ALLOC_HUGEPAGE) {
+                page_flags |= PAGES_HUGE;
+        }
+        if (flags & BIT2_ALLOC_POPULATE) {
+                page_flags |= PAGES_POPULATE;
+        }
+        bit2->map   = Pages_map((size_t)height * bit2->words_per_row *
+                                sizeof(uint64_t), page_flags,
+                                &bit2->map_length);
+        bit2->words = bit2->map;
+        bit2->paged = 1;
+
+        if (flags & BIT2_ALLOC_FIRST_TOUCH) {
+                /* Fresh pages read as zero; writing zero faults them */
+                if ((long)width * height >= PARALLEL_CELLS) {
+                        Pool_T pool = Pool_shared();
+                        Touch job;
+                        job.bit2   = bit2;
+                        job.nbands = Pool_size(pool) * BANDS_PER_THREAD;
+                        if (job.nbands > height) {
+                                job.nbands = height;
+                        }
+                        Pool_run_static(pool, job.nbands, touch_rows,
+                                        &job);
+                }
+        }
+        return bit2;
+}
+
 /*
  * Bit2_get - see bit2.h for contract
  */
@@ -54,8 +188,7 @@ int Bit2_get(T bit2, int col, int row)
         assert(col >= 0 && col < bit2->width);
         assert(row >= 0 && row < bit2->height);
 
-        int index = row * bit2->width + col;
-        return Bit_get(bit2->data, index);
+        return Bit2_fast_get(bit2, col, row);
 }
 
 /*
@@ -68,8 +201,7 @@ int Bit2_put(T bit2, int col, int row, int value)
         assert(row >= 0 && row < bit2->height);
         assert(value == 0 || value == 1);
 
-        int index = row * bit2->width + col;
-        return Bit_put(bit2->data, index, value);
+        return Bit2_fast_put(bit2, col, row, value);
 }
 
 /*
@@ -100,12 +232,50 @@ void Bit2_map_col_major(T bit2, Bit2_applyfun *apply, void *cl)
 
         for (int col = 0; col < bit2->width; col++) {
                 for (int row = 0; row < bit2->height; row++) {
-                        int elem = Bit2_get(bit2, col, row);
+                        int elem = Bit2_fast_get(bit2, col, row);
                         apply(col, row, bit2, elem, cl);
                 }
         }
 }
 
+/*
+ * Bit2_map_col_major_prefetch - see bit2.h for contract
+ */
+void Bit2_map_col_major_prefetch(T bit2, Bit2_applyfun *apply,
+                                 void *cl, int distance)
+{
+        assert(bit2 != NULL);
+        assert(apply != NULL);
+        assert(distance >= 0);
+
+        if (distance == BIT2_PREFETCH_DEFAULT) {
+                distance = PREFETCH_ROWS;
+        }
+        int height = bit2->height;
+        int lead   = distance < height ? distance : height;
+        long pitch = bit2->words_per_row;
+
+        for (int col = 0; col < bit2->width; col++) {
+                const uint64_t *word  = bit2->words +
+                                        col / BIT2_WORD_BITS;
+                const uint64_t *ahead = word + lead * pitch;
+                int shift = col % BIT2_WORD_BITS;
+                int row = 0;
+                for (; row < height - lead; row++) {
+                        PREFETCH(ahead, 0);
+                        apply(col, row, bit2, (int)(*word >> shift) & 1,
+                              cl);
+                        word  += pitch;
+                        ahead += pitch;
+                }
+                for (; row < height; row++) {
+                        apply(col, row, bit2, (int)(*word >> shift) & 1,
+                              cl);
+                        word += pitch;
+                }
+        }
+}
+
 /*
  * Bit2_map_row_major - see bit2.h for contract
  */
@@ -116,12 +286,60 @@ void Bit2_map_row_major(T bit2, Bit2_applyfun *apply, void *cl)
 
         for (int row = 0; row < bit2->height; row++) {
                 for (int col = 0; col < bit2->width; col++) {
-                        int elem = Bit2_get(bit2, col, row);
+                        int elem = Bit2_fast_get(bit2, col, row);
                         apply(col, row, bit2, elem, cl);
                 }
         }
 }
 
+/*
+ * Bit2_map_row_major_until - see bit2.h for contract
+ */
+Bit2_pos Bit2_map_row_major_until(T bit2, Bit2_stopfun *apply,
+                                  void *cl)
+{
+        assert(bit2 != NULL);
+        assert(apply != NULL);
+
+        for (int row = 0; row < bit2->height; row++) {
+                for (int col = 0; col < bit2->width; col++) {
+                        int elem = Bit2_fast_get(bit2, col, row);
+                        if (apply(col, row, bit2, elem, cl) ==
+                            BIT2_STOP) {
+                                Bit2_pos stop = { col, row };
+                                return stop;
+                        }
+                }
+        }
+
+        Bit2_pos nowhere = { -1, -1 };
+        return nowhere;
+}
+
+/*
+ * Bit2_map_col_major_until - see bit2.h for contract
+ */
+Bit2_pos Bit2_map_col_major_until(T bit2, Bit2_stopfun *apply,
+                                  void *cl)
+{
+        assert(bit2 != NULL);
+        assert(apply != NULL);
+
+        for (int col = 0; col < bit2->width; col++) {
+                for (int row = 0; row < bit2->height; row++) {
+                        int elem = Bit2_fast_get(bit2, col, row);
+                        if (apply(col, row, bit2, elem, cl) ==
+                            BIT2_STOP) {
+                                Bit2_pos stop = { col, row };
+                                return stop;
+                        }
+                }
+        }
+
+        Bit2_pos nowhere = { -1, -1 };
+        return nowhere;
+}
+
 /*
  * Bit2_free - see bit2.h for contract
  */
@@ -130,6 +348,382 @@ void Bit2_free(T *bit2)
         assert(bit2 != NULL);
         assert(*bit2 != NULL);
 
-        Bit_free(&((*bit2)->data));
+        if ((*bit2)->paged) {
+                Pages_unmap((*bit2)->map, (*bit2)->map_length);
+        } else if ((*bit2)->map != NULL) {
+                munmap((*bit2)->map, (*bit2)->map_length);
+        } else {
+                FREE((*bit2)->words);
+        }
         FREE(*bit2);
 }
+
+/*
+ * name: popcount
+ *
+ * description: Returns the number of 1 bits in word.
+ */
+static inline int popcount(uint64_t word)
+{
+#if defined(__GNUC__)
+        return __builtin_popcountll(word);
+#else
+        word = word - ((word >> 1) & 0x5555555555555555ull);
+        word = (word & 0x3333333333333333ull) +
+               ((word >> 2) & 0x3333333333333333ull);
+        word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0full;
+        return (int)((word * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+/*
+ * Bit2_count - see bit2.h for contract
+ */
+long Bit2_count(T bit2)
+{
+        assert(bit2 != NULL);
+
+        long nwords = (long)bit2->height * bit2->words_per_row;
+        long count = 0;
+        for (long i = 0; i < nwords; i++) {
+                count += popcount(bit2->words[i]);
+        }
+        return count;
+}
+
+/*
+ * name: reduce_rows
+ *
+ * description: Pool task for Bit2_reduce: folds every bit of
+ * band index into the running thread's accumulator.
+ */
+static void reduce_rows(int index, int thread, void *cl)
+{
+        Reduce *job = cl;
+        T bit2 = job->bit2;
+        void *acc = job->accs + thread * job->acc_stride;
+        int row0 = (int)((long)bit2->height * index / job->nbands);
+        int row1 = (int)((long)bit2->height * (index + 1) /
+                         job->nbands);
+
+        for (int row = row0; row < row1; row++) {
+                for (int col = 0; col < bit2->width; col++) {
+                        job->per_bit(col, row,
+                                     Bit2_fast_get(bit2, col, row),
+                                     acc, job->cl);
+                }
+        }
+}
+
+/*
+ * Bit2_reduce - see bit2.h for contract
+ */
+void Bit2_reduce(T bit2, void *acc, int acc_size,
+                 Bit2_combinefun *combine, Bit2_reducefun *per_bit,
+                 void *cl)
+{
+        assert(bit2 != NULL);
+        assert(acc != NULL);
+        assert(acc_size > 0);
+        assert(combine != NULL && per_bit != NULL);
+
+        Reduce job;
+        Pool_T pool = NULL;
+        int nthreads = 1;
+
+        job.bit2   = bit2;
+        job.nbands = 1;
+        if ((long)bit2->width * bit2->height >= PARALLEL_CELLS) {
+                pool = Pool_shared();
+                nthreads = Pool_size(pool);
+                job.nbands = nthreads * BANDS_PER_THREAD;
+                if (job.nbands > bit2->height) {
+                        job.nbands = bit2->height;
+                }
+        }
+        job.acc_stride = (acc_size + CACHE_LINE - 1) / CACHE_LINE *
+                         CACHE_LINE;
+        job.accs       = ALLOC(nthreads * job.acc_stride);
+        job.per_bit    = per_bit;
+        job.cl         = cl;
+        for (int t = 0; t < nthreads; t++) {
+                memcpy(job.accs + t * job.acc_stride, acc, acc_size);
+        }
+
+        if (pool == NULL) {
+                reduce_rows(0, 0, &job);
+        } else {
+                Pool_run_static(pool, job.nbands, reduce_rows,
+                                &job);
+        }
+
+        for (int t = 0; t < nthreads; t++) {
+                combine(acc, job.accs + t * job.acc_stride, cl);
+        }
+        FREE(job.accs);
+}
+
+/*
+ * name: check_coords
+ *
+ * description: Checks every coordinate of a batch up front, so
+ * the loops of Bit2_get_many and Bit2_put_many need no checks.
+ *
+ * CRE: a coordinate lies outside bit2.
+ */
+static void check_coords(T bit2, const Bit2_pos *coords, int n)
+{
+        for (int i = 0; i < n; i++) {
+                assert(coords[i].col >= 0 &&
+                       coords[i].col < bit2->width);
+                assert(coords[i].row >= 0 &&
+                       coords[i].row < bit2->height);
+        }
+}
+
+/*
+ * name: word_at
+ *
+ * description: Returns the word holding bit (col, row), unchecked.
+ */
+static inline uint64_t *word_at(T bit2, Bit2_pos pos)
+{
+        return &bit2->words[(long)pos.row * bit2->words_per_row +
+                            pos.col / BIT2_WORD_BITS];
+}
+
+/*
+ * name: row_order
+ *
+ * description: For a large batch on a bitmap too big for the
+ * cache, returns the indices 0 .. n - 1 of coords stably sorted
+ * by row (a counting sort), as UArray2_gather does, so that the
+ * batch sweeps the words top to bottom. Stability keeps repeated
+ * coordinates in their original order, so the last of them still
+ * wins in Bit2_put_many.
+ *
+ * Returns:
+ *   a new array of n indices, or NULL if sorting does not pay
+ */
+static int *row_order(T bit2, const Bit2_pos *coords, int n)
+{
+        if (n < SORT_COORDS ||
+            (long)bit2->height * bit2->words_per_row *
+            (long)sizeof(uint64_t) < SORT_BYTES) {
+                return NULL;
+        }
+
+        int *start = CALLOC(bit2->height + 1, sizeof(int));
+        int *order = ALLOC(n * (long)sizeof(int));
+
+        for (int i = 0; i < n; i++) {
+                start[coords[i].row + 1]++;
+        }
+        for (int row = 0; row < bit2->height; row++) {
+                start[row + 1] += start[row];
+        }
+        for (int i = 0; i < n; i++) {
+                order[start[coords[i].row]++] = i;
+        }
+
+        FREE(start);
+        return order;
+}
+
+/*
+ * Bit2_get_many - see bit2.h for contract
+ */
+void Bit2_get_many(T bit2, const Bit2_pos *coords, int n,
+                   unsigned char *out)
+{
+        assert(bit2 != NULL);
+        assert(n >= 0);
+        assert(n == 0 || (coords != NULL && out != NULL));
+        check_coords(bit2, coords, n);
+
+        int *order = row_order(bit2, coords, n);
+        for (int k = 0; k < n; k++) {
+                int i = order == NULL ? k : order[k];
+                if (k + PREFETCH_AHEAD < n) {
+                        int ahead = k + PREFETCH_AHEAD;
+                        if (order != NULL) {
+                                ahead = order[ahead];
+                        }
+                        PREFETCH(word_at(bit2, coords[ahead]), 0);
+                }
+                out[i] = (unsigned char)(*word_at(bit2, coords[i]) >>
+                                         (coords[i].col %
+                                          BIT2_WORD_BITS) & 1);
+        }
+        if (order != NULL) {
+                FREE(order);
+        }
+}
+
+/*
+ * Bit2_put_many - see bit2.h for contract
+ */
+void Bit2_put_many(T bit2, const Bit2_pos *coords, int n,
+                   const unsigned char *values)
+{
+        assert(bit2 != NULL);
+        assert(n >= 0);
+        assert(n == 0 || (coords != NULL && values != NULL));
+        check_coords(bit2, coords, n);
+        for (int i = 0; i < n; i++) {
+                assert(values[i] == 0 || values[i] == 1);
+        }
+
+        int *order = row_order(bit2, coords, n);
+        for (int k = 0; k < n; k++) {
+                int i = order == NULL ? k : order[k];
+                if (k + PREFETCH_AHEAD < n) {
+                        int ahead = k + PREFETCH_AHEAD;
+                        if (order != NULL) {
+                                ahead = order[ahead];
+                        }
+                        PREFETCH(word_at(bit2, coords[ahead]), 1);
+                }
+                uint64_t *word = word_at(bit2, coords[i]);
+                uint64_t mask  = (uint64_t)1 <<
+                                 (coords[i].col % BIT2_WORD_BITS);
+                *word = (*word & ~mask) | ((uint64_t)values[i] * mask);
+        }
+        if (order != NULL) {
+                FREE(order);
+        }
+}
+
+/*
+ * name: checksum
+ *
+ * description: Folds n words into a running 64-bit checksum, the
+ * same word-at-a-time FNV-1a variant that UArray2_save uses.
+ *
+ * Parameters:
+ *   sum   - checksum so far; SNAP_MAGIC to start
+ *   words - words to fold in
+ *   n     - number of words
+ *
+ * Returns:
+ *   the updated checksum
+ */
+static uint64_t checksum(uint64_t sum, const uint64_t *words, size_t n)
+{
+        for (size_t i = 0; i < n; i++) {
+                sum = (sum ^ words[i]) * 0x100000001b3ull;
+                sum ^= sum >> 29;
+        }
+        return sum;
+}
+
+/*
+ * name: write_all
+ *
+ * description: Writes n bytes at offset in fd, retrying short
+ * writes.
+ *
+ * CRE: a write fails.
+ */
+static void write_all(int fd, const void *buf, size_t n, off_t offset)
+{
+        const char *bytes = buf;
+        while (n > 0) {
+                ssize_t done = pwrite(fd, bytes, n, offset);
+                assert(done > 0);
+                bytes  += done;
+                n      -= done;
+                offset += done;
+        }
+}
+
+/*
+ * Bit2_save - see bit2.h for contract
+ */
+void Bit2_save(T bit2, const char *path)
+{
+        assert(bit2 != NULL);
+        assert(path != NULL);
+
+        int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        assert(fd >= 0);
+
+        size_t nwords = (size_t)bit2->height * bit2->words_per_row;
+        Snap_header header;
+        memset(&header, 0, sizeof(header));
+        header.magic         = SNAP_MAGIC;
+        header.version       = SNAP_VERSION;
+        header.width         = bit2->width;
+        header.height        = bit2->height;
+        header.words_per_row = bit2->words_per_row;
+        header.payload       = nwords * sizeof(uint64_t);
+        header.checksum      = checksum(SNAP_MAGIC, bit2->words,
+                                        nwords);
+        header.header_sum    = checksum(SNAP_MAGIC,
+                                        (const uint64_t *)&header,
+                                        offsetof(Snap_header,
+                                                 header_sum) / 8);
+
+        write_all(fd, &header, sizeof(header), 0);
+        write_all(fd, bit2->words, header.payload, SNAP_HEADER);
+        int rc = close(fd);
+        assert(rc == 0);
+}
+
+/*
+ * Bit2_load - see bit2.h for contract
+ */
+T Bit2_load(const char *path, int flags)
+{
+        assert(path != NULL);
+        int mode = flags & (BIT2_MAP_RDONLY | BIT2_MAP_PRIVATE);
+        assert(mode == BIT2_MAP_RDONLY ||
+               mode == BIT2_MAP_PRIVATE);
+        assert((flags & ~(mode | BIT2_LOAD_VERIFY)) == 0);
+
+        int fd = open(path, O_RDONLY);
+        assert(fd >= 0);
+
+        struct stat st;
+        int rc = fstat(fd, &st);
+        assert(rc == 0);
+
+        Snap_header header;
+        ssize_t n = pread(fd, &header, sizeof(header), 0);
+        assert(n == (ssize_t)sizeof(header));
+        assert(header.magic == SNAP_MAGIC);
+        assert(header.version == SNAP_VERSION);
+        assert(header.header_sum ==
+               checksum(SNAP_MAGIC, (const uint64_t *)&header,
+                        offsetof(Snap_header, header_sum) / 8));
+        assert(header.width > 0 && header.height > 0);
+        assert(header.words_per_row ==
+               (header.width + BIT2_WORD_BITS - 1) / BIT2_WORD_BITS);
+        assert(header.payload == (uint64_t)header.height *
+                                 header.words_per_row *
+                                 sizeof(uint64_t));
+        assert(st.st_size == SNAP_HEADER + (off_t)header.payload);
+
+        int prot = mode == BIT2_MAP_RDONLY ? PROT_READ
+                                              : PROT_READ | PROT_WRITE;
+        void *map = mmap(NULL, st.st_size, prot, MAP_PRIVATE, fd, 0);
+        assert(map != MAP_FAILED);
+        close(fd);            /* the mapping keeps the file open */
+
+        T bit2;
+        NEW(bit2);
+        bit2->width         = header.width;
+        bit2->height        = header.height;
+        bit2->words_per_row = header.words_per_row;
+        bit2->words         = (uint64_t *)((char *)map + SNAP_HEADER);
+        bit2->map           = map;
+        bit2->map_length    = st.st_size;
+        bit2->paged         = 0;
+
+        if (flags & BIT2_LOAD_VERIFY) {
+                assert(checksum(SNAP_MAGIC, bit2->words,
+                                header.payload / sizeof(uint64_t)) ==
+                       header.checksum);
+        }
+        return bit2;
+}
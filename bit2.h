@@ -12,7 +12,7 @@
  *          row-major or column-major order.
  *
  * Key Insight: Bit2 saves space by storing pixels as packed
- *          bits via Hanson's Bit_T. Because a single bit has
+ *          bits in 64-bit words. Because a single bit has
  *          no address, the interface uses put/get rather than
  *          an 'at' function that returns a pointer.
  */
@@ -35,6 +35,31 @@ typedef struct T *T;
  */
 extern T Bit2_new(int width, int height);
 
+/*
+ * Flags for Bit2_new_flags; 0 or more may be given, but not both
+ * POPULATE and FIRST_TOUCH.
+ */
+#define BIT2_ALLOC_HUGEPAGE    0x1
+#define BIT2_ALLOC_POPULATE    0x2
+#define BIT2_ALLOC_FIRST_TOUCH 0x4
+
+/*
+ * Bit2_new_flags
+ *
+ * Like Bit2_new, but the words are mapped directly from the
+ * kernel as the BIT2_ALLOC_* flags ask: transparent huge pages,
+ * pages faulted in up front, or pages zeroed in parallel by row
+ * bands on Pool_shared(), each by the thread that Bit2_reduce and
+ * the conversions of bit2conv.h later give those rows to (see
+ * Pool_run_static). All bits are 0. The flags have the values of
+ * the matching UARRAY2_ALLOC_* flags of uarray2.h.
+ *
+ * CRE: width <= 0 or height <= 0.
+ * CRE: flags has unknown bits, or both POPULATE and FIRST_TOUCH.
+ * CRE: memory cannot be mapped.
+ */
+extern T Bit2_new_flags(int width, int height, int flags);
+
 /*
  * Bit2_free
  *
@@ -105,6 +130,21 @@ typedef void Bit2_applyfun(int col, int row, T bit2, int elem,
 extern void Bit2_map_col_major(T bit2, Bit2_applyfun *apply,
                                void *cl);
 
+#define BIT2_PREFETCH_DEFAULT 0
+
+/*
+ * Bit2_map_col_major_prefetch
+ *
+ * Same as Bit2_map_col_major, but while visiting row r it
+ * prefetches the word distance rows further down the column, as
+ * UArray2_map_col_major_prefetch does. BIT2_PREFETCH_DEFAULT
+ * picks a distance measured with benchuarray2.
+ *
+ * CRE: bit2 is NULL, apply is NULL, or distance < 0.
+ */
+extern void Bit2_map_col_major_prefetch(T bit2, Bit2_applyfun *apply,
+                                        void *cl, int distance);
+
 /*
  * Bit2_map_row_major
  *
@@ -116,5 +156,175 @@ extern void Bit2_map_col_major(T bit2, Bit2_applyfun *apply,
 extern void Bit2_map_row_major(T bit2, Bit2_applyfun *apply,
                                void *cl);
 
+/*
+ * Bit2_pos
+ *
+ * A position in a bitmap, as returned by the stopping maps.
+ */
+typedef struct Bit2_pos {
+        int col;
+        int row;
+} Bit2_pos;
+
+#define BIT2_CONTINUE 0
+#define BIT2_STOP     1
+
+/*
+ * Bit2_stopfun
+ *
+ * Apply function for the stopping maps. Same parameters as
+ * Bit2_applyfun; returns BIT2_STOP to end the traversal at this
+ * bit or BIT2_CONTINUE to go on.
+ */
+typedef int Bit2_stopfun(int col, int row, T bit2, int elem,
+                         void *cl);
+
+/*
+ * Bit2_map_row_major_until / Bit2_map_col_major_until
+ *
+ * Like Bit2_map_row_major and Bit2_map_col_major, but stop as
+ * soon as apply returns BIT2_STOP. Return the position of the
+ * bit at which apply stopped, or {-1, -1} if it never did.
+ *
+ * CRE: bit2 is NULL or apply is NULL.
+ */
+extern Bit2_pos Bit2_map_row_major_until(T bit2, Bit2_stopfun *apply,
+                                         void *cl);
+extern Bit2_pos Bit2_map_col_major_until(T bit2, Bit2_stopfun *apply,
+                                         void *cl);
+
+/*
+ * Bit2_count
+ *
+ * Returns the number of 1 bits in the bitmap, counted a word at
+ * a time. The count is a long, since a bitmap can hold more than
+ * INT_MAX bits.
+ *
+ * CRE: bit2 is NULL.
+ */
+extern long Bit2_count(T bit2);
+
+/*
+ * Bit2_reducefun
+ *
+ * Folds the bit at (col, row) into the calling thread's private
+ * accumulator acc for Bit2_reduce.
+ */
+typedef void Bit2_reducefun(int col, int row, int bit, void *acc,
+                            void *cl);
+
+/*
+ * Bit2_combinefun
+ *
+ * Folds the accumulator other into acc for Bit2_reduce.
+ */
+typedef void Bit2_combinefun(void *acc, const void *other, void *cl);
+
+/*
+ * Bit2_reduce
+ *
+ * Folds every bit of the bitmap into acc, exactly as
+ * UArray2_reduce does for a UArray2: large bitmaps are split into
+ * bands of rows on Pool_shared(), each thread folds into its own
+ * copy of acc's initial value, and the copies are combined into
+ * acc at the end. The initial value must be an identity of
+ * combine, and the result must not depend on folding order.
+ *
+ * Parameters:
+ *   bit2     - the bitmap to reduce
+ *   acc      - initial value on entry, result on return
+ *   acc_size - size in bytes of the accumulator
+ *   combine  - folds one accumulator into another
+ *   per_bit  - folds one bit into an accumulator
+ *   cl       - closure passed to every call
+ *
+ * CRE: bit2, acc, combine or per_bit is NULL.
+ * CRE: acc_size <= 0.
+ */
+extern void Bit2_reduce(T bit2, void *acc, int acc_size,
+                        Bit2_combinefun *combine,
+                        Bit2_reducefun *per_bit, void *cl);
+
+/*
+ * Bit2_get_many
+ *
+ * Batched Bit2_get: sets out[i] to the bit at coords[i]. All
+ * coordinates are checked once up front. As in UArray2_gather,
+ * large batches on large bitmaps are visited sorted by row, and
+ * the words for coordinates a few entries ahead are prefetched.
+ *
+ * Parameters:
+ *   bit2   - the bitmap to read
+ *   coords - n positions within the bitmap, in any order
+ *   n      - number of coordinates; may be 0
+ *   out    - room for n values, each set to 0 or 1
+ *
+ * CRE: bit2 is NULL, or n < 0.
+ * CRE: n > 0 and coords or out is NULL.
+ * CRE: a coordinate lies outside the bitmap.
+ */
+extern void Bit2_get_many(T bit2, const Bit2_pos *coords, int n,
+                          unsigned char *out);
+
+/*
+ * Bit2_put_many
+ *
+ * Batched Bit2_put: sets the bit at coords[i] to values[i]. The
+ * last value given for a repeated coordinate wins, even when a
+ * large batch is visited sorted by row.
+ *
+ * Parameters:
+ *   bit2   - the bitmap to write
+ *   coords - n positions within the bitmap, in any order
+ *   n      - number of coordinates; may be 0
+ *   values - n values, each 0 or 1
+ *
+ * CRE: bit2 is NULL, or n < 0.
+ * CRE: n > 0 and coords or values is NULL.
+ * CRE: a coordinate lies outside the bitmap, or a value is not
+ *      0 or 1.
+ */
+extern void Bit2_put_many(T bit2, const Bit2_pos *coords, int n,
+                          const unsigned char *values);
+
+/*
+ * Bit2_save
+ *
+ * Writes a snapshot of bit2 to the file at path, replacing any
+ * file there, for a later Bit2_load: a one-page versioned header
+ * (width, height, words per row and checksums) followed by the
+ * packed words exactly as they sit in memory, starting on a page
+ * boundary, in this machine's byte order.
+ *
+ * CRE: bit2 or path is NULL.
+ * CRE: the file cannot be created or written.
+ */
+extern void Bit2_save(T bit2, const char *path);
+
+#define BIT2_MAP_RDONLY  0x1   /* bits may only be read */
+#define BIT2_MAP_PRIVATE 0x4   /* writes stay private to the bitmap */
+#define BIT2_LOAD_VERIFY 0x10  /* check the payload checksum */
+
+/*
+ * Bit2_load
+ *
+ * Returns the bitmap saved in the file at path by Bit2_save,
+ * mapped rather than read, as UArray2_load does: loading costs
+ * the same for any size of bitmap. flags is BIT2_MAP_RDONLY or
+ * BIT2_MAP_PRIVATE, optionally with BIT2_LOAD_VERIFY to check the
+ * payload checksum; they have the values of the UARRAY2_MAP_* and
+ * UARRAY2_LOAD_VERIFY flags of UArray2_load. Bit2_free unmaps the
+ * file.
+ *
+ * CRE: path is NULL, or flags is not a valid combination.
+ * CRE: the file cannot be opened or mapped, or is not a snapshot
+ *      of this version, or its header checksum is wrong.
+ * CRE: BIT2_LOAD_VERIFY is given and the payload checksum is
+ *      wrong.
+ * CRE: Bit2_put on a RDONLY bitmap (the process is killed by the
+ *      operating system).
+ */
+extern T Bit2_load(const char *path, int flags);
+
 #undef T
 #endif
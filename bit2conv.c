@@ -0,0 +1,540 @@
+/*
+ * bit2conv.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/17/2026
+ *
+ * Purpose: Implements the conversions of bit2conv.h between Bit2
+ *          bitmaps and UArray2 graymaps: thresholding, expansion
+ *          and the summed-area table of a bitmap.
+ *
+ * Key Insight: Both representations are visible here (bit2rep.h,
+ *          uarray2rep.h), so whole rows move between them: 64
+ *          comparisons are packed straight into a word, and a
+ *          word is expanded straight into a row of elements.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "bit2conv.h"
+#include "bit2rep.h"
+#include "uarray2rep.h"
+#include "pool.h"
+#include "mem.h"
+#include "assert.h"
+
+#define PARALLEL_CELLS 65536   /* fewer cells: no thread pool */
+#define BANDS_PER_THREAD 4     /* row bands per pool thread */
+#define STRIP_COLS 512         /* columns per column-pass task */
+
+#define T Bit2_T
+
+/*
+ * One UArray2_to_Bit2 or Bit2_to_UArray2 conversion, shared by its
+ * pool tasks. A packed word is ((gt & keep_gt) | (eq & keep_eq))
+ * ^ invert, where gt and eq hold the elements' "> threshold" and
+ * "== threshold" bits, which expresses all six Bit2_compare ops.
+ */
+typedef struct Convert {
+        T bit2;
+        UArray2_T array;
+        UArray2_elem type;
+        int nbands;
+        int64_t threshold;
+        uint64_t keep_gt;     /* all ones or 0 */
+        uint64_t keep_eq;     /* all ones or 0 */
+        uint64_t invert;      /* all ones or 0 */
+        int64_t values[2];    /* element for a 0 bit and a 1 bit */
+} Convert;
+
+/*
+ * One Bit2_integral build, shared by its pool tasks.
+ */
+typedef struct Summed {
+        T bit2;
+        UArray2_T sat;        /* the (width + 1) x (height + 1) table */
+        int nbands;           /* row bands in the first pass */
+        int nstrips;          /* column strips in the second pass */
+} Summed;
+
+/*
+ * name: summed_rows
+ *
+ * description: Pool task for the first pass of Bit2_integral:
+ * fills row r + 1 of the table with the running count of 1 bits
+ * along bitmap row r, for each row r in band index. The count is
+ * built straight from the words by shifting through each one, and
+ * a word of 0s just repeats the count.
+ */
+static void summed_rows(int index, int thread, void *cl)
+{
+        Summed *job = cl;
+        T bit2    = job->bit2;
+        int width = bit2->width;
+        int row0  = (int)((long)bit2->height * index / job->nbands);
+        int row1  = (int)((long)bit2->height * (index + 1) /
+                          job->nbands);
+        (void)thread;
+
+        for (int row = row0; row < row1; row++) {
+                const uint64_t *words = bit2->words +
+                                        (long)row * bit2->words_per_row;
+                int64_t *out = UArray2_fast_at(job->sat, 1, row + 1);
+                int64_t sum  = 0;
+
+                for (int col = 0; col < width; col += BIT2_WORD_BITS) {
+                        uint64_t word = words[col / BIT2_WORD_BITS];
+                        int n = width - col < BIT2_WORD_BITS
+                                ? width - col : BIT2_WORD_BITS;
+                        if (word == 0) {
+                                for (int b = 0; b < n; b++) {
+                                        out[col + b] = sum;
+                                }
+                                continue;
+                        }
+                        for (int b = 0; b < n; b++) {
+                                sum += (word >> b) & 1;
+                                out[col + b] = sum;
+                        }
+                }
+        }
+}
+
+/*
+ * name: summed_cols
+ *
+ * description: Pool task for the second pass of Bit2_integral:
+ * adds each row of the table into the next, for the columns of
+ * strip index, along contiguous rows as UArray2_integral does.
+ */
+static void summed_cols(int index, int thread, void *cl)
+{
+        Summed *job = cl;
+        UArray2_T sat = job->sat;
+        int col0 = (int)((long)sat->width * index / job->nstrips);
+        int col1 = (int)((long)sat->width * (index + 1) /
+                         job->nstrips);
+        (void)thread;
+
+        for (int row = 1; row < sat->height; row++) {
+                const int64_t *above = UArray2_fast_at(sat, 0, row - 1);
+                int64_t *here = UArray2_fast_at(sat, 0, row);
+                for (int col = col0; col < col1; col++) {
+                        here[col] += above[col];
+                }
+        }
+}
+
+/*
+ * Bit2_integral - see bit2conv.h for contract
+ */
+UArray2_T Bit2_integral(T bit2)
+{
+        assert(bit2 != NULL);
+
+        Summed job;
+        job.bit2    = bit2;
+        job.sat     = UArray2_new(bit2->width + 1, bit2->height + 1,
+                                  sizeof(int64_t));
+        job.nbands  = 1;
+        job.nstrips = 1;
+
+        if ((long)bit2->width * bit2->height < PARALLEL_CELLS) {
+                summed_rows(0, 0, &job);
+                summed_cols(0, 0, &job);
+                return job.sat;
+        }
+
+        /* Row counts, then add each row into the next */
+        Pool_T pool = Pool_shared();
+        job.nbands  = Pool_size(pool) * BANDS_PER_THREAD;
+        if (job.nbands > bit2->height) {
+                job.nbands = bit2->height;
+        }
+        job.nstrips = (job.sat->width + STRIP_COLS - 1) / STRIP_COLS;
+        Pool_run_static(pool, job.nbands, summed_rows, &job);
+        Pool_run(pool, job.nstrips, summed_cols, &job);
+        return job.sat;
+}
+
+/*
+ * name: elem_bytes
+ *
+ * description: Returns the size in bytes of an element of type.
+ */
+static int elem_bytes(UArray2_elem type)
+{
+        switch (type) {
+        case UARRAY2_ELEM_U8:  return 1;
+        case UARRAY2_ELEM_U16: return 2;
+        default:               return 4;
+        }
+}
+
+/*
+ * name: fits
+ *
+ * description: Returns 1 if value can be stored in an element of
+ * type, and 0 otherwise.
+ */
+static int fits(int64_t value, UArray2_elem type)
+{
+        switch (type) {
+        case UARRAY2_ELEM_U8:  return value >= 0 && value <= UINT8_MAX;
+        case UARRAY2_ELEM_U16: return value >= 0 && value <= UINT16_MAX;
+        case UARRAY2_ELEM_I32: return value >= INT32_MIN &&
+                                      value <= INT32_MAX;
+        default:               return value >= 0 && value <= UINT32_MAX;
+        }
+}
+
+/*
+ * name: read_elem
+ *
+ * description: Returns the element at p read as the given type.
+ */
+static inline int64_t read_elem(const char *p, UArray2_elem type)
+{
+        switch (type) {
+        case UARRAY2_ELEM_U8:  return *(const unsigned char *)p;
+        case UARRAY2_ELEM_U16: return *(const uint16_t *)p;
+        case UARRAY2_ELEM_I32: return *(const int32_t *)p;
+        default:               return *(const uint32_t *)p;
+        }
+}
+
+/*
+ * name: write_elem
+ *
+ * description: Stores value at p as the given type.
+ */
+static inline void write_elem(char *p, UArray2_elem type,
+                              int64_t value)
+{
+        switch (type) {
+        case UARRAY2_ELEM_U8:  *(unsigned char *)p = value; break;
+        case UARRAY2_ELEM_U16: *(uint16_t *)p = value;      break;
+        case UARRAY2_ELEM_I32: *(int32_t *)p = value;       break;
+        default:               *(uint32_t *)p = value;      break;
+        }
+}
+
+/*
+ * name: compare_run
+ *
+ * description: Compares n <= 64 contiguous elements at in with
+ * threshold, setting bit i of *gt where element i is greater and
+ * bit i of *eq where it is equal. Where SSE2 is available, 8- and
+ * 16-bit elements with a threshold in their range are compared 16
+ * at a time, with a bias flipping their top bit so that the
+ * signed SSE2 compares order them as unsigned, and movemask
+ * gathers the 16 results into 16 bits. The rest go one by one.
+ */
+static inline void compare_run(const char *in, int n,
+                               UArray2_elem type, int64_t threshold,
+                               uint64_t *gt, uint64_t *eq)
+{
+        uint64_t g = 0, e = 0;
+        int i = 0;
+
+#if defined(__SSE2__)
+        if (type == UARRAY2_ELEM_U8 && fits(threshold, type)) {
+                __m128i bias  = _mm_set1_epi8((char)0x80);
+                __m128i above = _mm_set1_epi8((char)(threshold ^ 0x80));
+                __m128i same  = _mm_set1_epi8((char)threshold);
+                for (; i + 16 <= n; i += 16) {
+                        __m128i x = _mm_loadu_si128((const __m128i *)
+                                                    (in + i));
+                        __m128i xg = _mm_cmpgt_epi8(_mm_xor_si128(x,
+                                                                  bias),
+                                                    above);
+                        __m128i xe = _mm_cmpeq_epi8(x, same);
+                        g |= (uint64_t)_mm_movemask_epi8(xg) << i;
+                        e |= (uint64_t)_mm_movemask_epi8(xe) << i;
+                }
+        } else if (type == UARRAY2_ELEM_U16 && fits(threshold, type)) {
+                __m128i bias  = _mm_set1_epi16((short)0x8000);
+                __m128i above = _mm_set1_epi16((short)(threshold ^
+                                                       0x8000));
+                __m128i same  = _mm_set1_epi16((short)threshold);
+                for (; i + 16 <= n; i += 16) {
+                        const __m128i *p = (const __m128i *)in + i / 8;
+                        __m128i lo = _mm_loadu_si128(p);
+                        __m128i hi = _mm_loadu_si128(p + 1);
+                        /* Pack the 16-bit masks to bytes, then move */
+                        __m128i xg = _mm_packs_epi16(
+                                _mm_cmpgt_epi16(_mm_xor_si128(lo, bias),
+                                                above),
+                                _mm_cmpgt_epi16(_mm_xor_si128(hi, bias),
+                                                above));
+                        __m128i xe = _mm_packs_epi16(
+                                _mm_cmpeq_epi16(lo, same),
+                                _mm_cmpeq_epi16(hi, same));
+                        g |= (uint64_t)_mm_movemask_epi8(xg) << i;
+                        e |= (uint64_t)_mm_movemask_epi8(xe) << i;
+                }
+        }
+#endif
+        int size = elem_bytes(type);
+        for (; i < n; i++) {
+                int64_t v = read_elem(in + (long)i * size, type);
+                g |= (uint64_t)(v > threshold) << i;
+                e |= (uint64_t)(v == threshold) << i;
+        }
+        *gt = g;
+        *eq = e;
+}
+
+/*
+ * name: pack_rows
+ *
+ * description: Pool task binarizing the rows of band index of a
+ * UArray2_to_Bit2 conversion, one word at a time. Rows of a flat
+ * array are read in place; other layouts are copied to a buffer.
+ */
+static void pack_rows(int index, int thread, void *cl)
+{
+        Convert *job    = cl;
+        T bit2          = job->bit2;
+        UArray2_T array = job->array;
+        int size = array->size;
+        int row0 = (int)((long)bit2->height * index / job->nbands);
+        int row1 = (int)((long)bit2->height * (index + 1) /
+                         job->nbands);
+        char *line = NULL;
+        (void)thread;
+
+        if (array->layout != UARRAY2_FLAT) {
+                line = ALLOC((long)bit2->width * size);
+        }
+        for (int row = row0; row < row1; row++) {
+                const char *in = array->elems + row * array->stride;
+                if (line != NULL) {
+                        for (int col = 0; col < bit2->width; col++) {
+                                memcpy(line + (long)col * size,
+                                       UArray2_get(array, col, row),
+                                       size);
+                        }
+                        in = line;
+                }
+                uint64_t *out = bit2->words +
+                                (long)row * bit2->words_per_row;
+                for (int w = 0; w < bit2->words_per_row; w++) {
+                        int col = w * BIT2_WORD_BITS;
+                        int n   = bit2->width - col < BIT2_WORD_BITS
+                                  ? bit2->width - col : BIT2_WORD_BITS;
+                        uint64_t valid = n == BIT2_WORD_BITS
+                                         ? ~(uint64_t)0
+                                         : ((uint64_t)1 << n) - 1;
+                        uint64_t gt, eq;
+                        compare_run(in + (long)col * size, n, job->type,
+                                    job->threshold, &gt, &eq);
+                        out[w] = ((gt & job->keep_gt) |
+                                  (eq & job->keep_eq)) ^
+                                 (job->invert & valid);
+                }
+        }
+        if (line != NULL) {
+                FREE(line);
+        }
+}
+
+#if defined(__SSE2__)
+/*
+ * name: expand_bytes
+ *
+ * description: Expands bits 16 at a time into bytes of out:
+ * values[0] for a 0 bit and values[1] for a 1. Each byte of a
+ * vector holding the 16 bits is ANDed with its own bit, and the
+ * compare result selects between the two values.
+ *
+ * Returns:
+ *   the number of bytes written (a multiple of 16); the caller
+ *   handles the rest
+ */
+static int expand_bytes(const uint64_t *words, int width, char *out,
+                        const int64_t *values)
+{
+        __m128i zero = _mm_set1_epi8((char)values[0]);
+        __m128i diff = _mm_set1_epi8((char)(values[0] ^ values[1]));
+        __m128i bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128,
+                                     1, 2, 4, 8, 16, 32, 64, -128);
+        int col = 0;
+
+        for (; col + 16 <= width; col += 16) {
+                uint64_t word = words[col / BIT2_WORD_BITS];
+                unsigned m = (word >> (col % BIT2_WORD_BITS)) & 0xffff;
+                __m128i x = _mm_unpacklo_epi64(
+                        _mm_set1_epi8((char)(m & 0xff)),
+                        _mm_set1_epi8((char)(m >> 8)));
+                __m128i set = _mm_cmpeq_epi8(_mm_and_si128(x, bits),
+                                             bits);
+                __m128i pick = _mm_and_si128(set, diff);
+                _mm_storeu_si128((__m128i *)(out + col),
+                                 _mm_xor_si128(zero, pick));
+        }
+        return col;
+}
+#endif
+
+/*
+ * name: expand_rows
+ *
+ * description: Pool task expanding the rows of band index of a
+ * Bit2_to_UArray2 conversion, 8-bit elements through
+ * expand_bytes where SSE2 is available.
+ */
+static void expand_rows(int index, int thread, void *cl)
+{
+        Convert *job    = cl;
+        T bit2          = job->bit2;
+        UArray2_T array = job->array;
+        int size  = array->size;
+        int width = bit2->width;
+        int row0  = (int)((long)bit2->height * index / job->nbands);
+        int row1  = (int)((long)bit2->height * (index + 1) /
+                          job->nbands);
+        (void)thread;
+
+        for (int row = row0; row < row1; row++) {
+                const uint64_t *words = bit2->words +
+                                        (long)row * bit2->words_per_row;
+                char *out = array->elems + row * array->stride;
+                int col = 0;
+#if defined(__SSE2__)
+                if (job->type == UARRAY2_ELEM_U8) {
+                        col = expand_bytes(words, width, out,
+                                           job->values);
+                }
+#endif
+                for (; col < width; col++) {
+                        int bit = (words[col / BIT2_WORD_BITS] >>
+                                   (col % BIT2_WORD_BITS)) & 1;
+                        write_elem(out + (long)col * size, job->type,
+                                   job->values[bit]);
+                }
+        }
+}
+
+/*
+ * name: run_convert
+ *
+ * description: Runs task over every row of job->bit2: as one band
+ * on the calling thread for small bitmaps, and otherwise as a few
+ * bands per thread of Pool_shared(), split by Pool_run_static so
+ * each thread gets the rows Bit2_new_flags had it first touch.
+ */
+static void run_convert(Convert *job, Pool_taskfun *task)
+{
+        T bit2 = job->bit2;
+
+        if ((long)bit2->width * bit2->height < PARALLEL_CELLS) {
+                job->nbands = 1;
+                task(0, 0, job);
+                return;
+        }
+        Pool_T pool = Pool_shared();
+        job->nbands = Pool_size(pool) * BANDS_PER_THREAD;
+        if (job->nbands > bit2->height) {
+                job->nbands = bit2->height;
+        }
+        Pool_run_static(pool, job->nbands, task, job);
+}
+
+/*
+ * UArray2_to_Bit2 - see bit2conv.h for contract
+ */
+T UArray2_to_Bit2(UArray2_T src, UArray2_elem type, Bit2_compare op,
+                  int64_t threshold)
+{
+        assert(src != NULL);
+        assert(type == UARRAY2_ELEM_U8 || type == UARRAY2_ELEM_U16 ||
+               type == UARRAY2_ELEM_I32 || type == UARRAY2_ELEM_U32);
+        assert(src->size == elem_bytes(type));
+        assert(op >= BIT2_LT && op <= BIT2_NE);
+
+        /* gt, eq and invert for each op, in Bit2_compare order */
+        static const int use_gt[] = { 1, 1, 1, 1, 0, 0 };
+        static const int use_eq[] = { 1, 0, 0, 1, 1, 1 };
+        static const int negate[] = { 1, 1, 0, 0, 0, 1 };
+
+        Convert job;
+        job.bit2      = Bit2_new(src->width, src->height);
+        job.array     = src;
+        job.type      = type;
+        job.threshold = threshold;
+        job.keep_gt   = use_gt[op] ? ~(uint64_t)0 : 0;
+        job.keep_eq   = use_eq[op] ? ~(uint64_t)0 : 0;
+        job.invert    = negate[op] ? ~(uint64_t)0 : 0;
+        run_convert(&job, pack_rows);
+        return job.bit2;
+}
+
+/*
+ * Bit2_to_UArray2 - see bit2conv.h for contract
+ */
+UArray2_T Bit2_to_UArray2(T src, UArray2_elem type, int64_t v0,
+                          int64_t v1)
+{
+        assert(src != NULL);
+        assert(type == UARRAY2_ELEM_U8 || type == UARRAY2_ELEM_U16 ||
+               type == UARRAY2_ELEM_I32 || type == UARRAY2_ELEM_U32);
+        assert(fits(v0, type) && fits(v1, type));
+
+        Convert job;
+        job.bit2      = src;
+        job.array     = UArray2_new(src->width, src->height,
+                                    elem_bytes(type));
+        job.type      = type;
+        job.values[0] = v0;
+        job.values[1] = v1;
+        run_convert(&job, expand_rows);
+        return job.array;
+}
+
+/*
+ * UArray2_otsu - see bit2conv.h for contract
+ */
+int64_t UArray2_otsu(UArray2_T uarray2, UArray2_elem type)
+{
+        assert(uarray2 != NULL);
+        assert(type == UARRAY2_ELEM_U8 || type == UARRAY2_ELEM_U16);
+
+        int nbins = type == UARRAY2_ELEM_U8 ? 1 << 8 : 1 << 16;
+        int64_t *counts = ALLOC(nbins * (long)sizeof(int64_t));
+        UArray2_histogram(uarray2, type, counts, nbins);
+
+        double total = (double)uarray2->width * uarray2->height;
+        double sum_all = 0;
+        for (int v = 0; v < nbins; v++) {
+                sum_all += (double)v * counts[v];
+        }
+
+        /* Class 0 is [0, t], class 1 is (t, nbins) */
+        double weight0 = 0, sum0 = 0, best_between = -1;
+        int64_t best = -1, largest = 0;
+        for (int t = 0; t < nbins; t++) {
+                if (counts[t] == 0) {
+                        continue;
+                }
+                largest  = t;
+                weight0 += counts[t];
+                sum0    += (double)t * counts[t];
+                double weight1 = total - weight0;
+                if (weight1 == 0) {
+                        break;
+                }
+                double diff = sum0 / weight0 -
+                              (sum_all - sum0) / weight1;
+                double between = weight0 * weight1 * diff * diff;
+                if (between > best_between) {
+                        best_between = between;
+                        best = t;
+                }
+        }
+        FREE(counts);
+        return best >= 0 ? best : largest;
+}
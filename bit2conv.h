@@ -0,0 +1,119 @@
+/*
+ * bit2conv.h
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/17/2026
+ *
+ * Purpose: Defines the conversions between Bit2 bitmaps and UArray2
+ *          graymaps: thresholding a graymap into a bitmap (with
+ *          Otsu's method to pick the threshold), expanding a
+ *          bitmap into a graymap, and building the summed-area
+ *          table of a bitmap.
+ *
+ * Key Insight: These are the only Bit2 operations that need
+ *          UArray2, so they live apart from bit2.h; a program that
+ *          uses bitmaps alone links bit2.o without uarray2.o.
+ */
+
+#ifndef BIT2CONV_INCLUDED
+#define BIT2CONV_INCLUDED
+
+#include <stdint.h>
+#include "bit2.h"
+#include "uarray2.h"
+
+#define T Bit2_T
+
+/*
+ * Bit2_integral
+ *
+ * Builds the summed-area table of the bitmap: a new
+ * (width + 1) by (height + 1) UArray2 of int64_t whose element
+ * (col, row) counts the 1 bits above and to the left of
+ * (col, row). Query it with UArray2_integral_sum to count the
+ * 1 bits in any rectangle in constant time. Each row's counts are
+ * built straight from its words, with no byte-per-bit copy of the
+ * bitmap.
+ *
+ * CRE: bit2 is NULL.
+ * CRE: memory allocation failure.
+ */
+extern UArray2_T Bit2_integral(T bit2);
+
+/*
+ * Bit2_compare
+ *
+ * How UArray2_to_Bit2 compares each element with its threshold;
+ * the bit is 1 where "element op threshold" holds.
+ */
+typedef enum {
+        BIT2_LT,              /* element <  threshold */
+        BIT2_LE,              /* element <= threshold */
+        BIT2_GT,              /* element >  threshold */
+        BIT2_GE,              /* element >= threshold */
+        BIT2_EQ,              /* element == threshold */
+        BIT2_NE               /* element != threshold */
+} Bit2_compare;
+
+/*
+ * UArray2_to_Bit2
+ *
+ * Binarizes a graymap: returns a new bitmap the size of src whose
+ * bit (col, row) is 1 exactly where element (col, row) of src,
+ * read as type, compares to threshold by op. Each run of 64
+ * comparisons is packed straight into a word; for 8- and 16-bit
+ * elements this uses SSE2 compares and movemask, 16 elements at a
+ * time. Large arrays are split into row bands on Pool_shared().
+ * For an adaptive threshold, pass UArray2_otsu(src, type) with
+ * BIT2_GT.
+ *
+ * Parameters:
+ *   src       - the graymap; any layout
+ *   type      - how its elements are read
+ *   op        - the comparison
+ *   threshold - the value compared against; any value, even one
+ *               outside the range of type
+ *
+ * Returns: A new Bit2_T, freed with Bit2_free.
+ *
+ * CRE: src is NULL, or its element size does not match type.
+ */
+extern T UArray2_to_Bit2(UArray2_T src, UArray2_elem type,
+                         Bit2_compare op, int64_t threshold);
+
+/*
+ * Bit2_to_UArray2
+ *
+ * Expands a bitmap into a new graymap the size of src, whose
+ * elements of the given type are v0 where the bit is 0 and v1
+ * where it is 1, for example 255 and 0 to print a PBM as a PGM.
+ * Bytes are expanded 16 at a time with SSE2, and large bitmaps
+ * are split into row bands on Pool_shared().
+ *
+ * Returns: A new flat UArray2_T, freed with UArray2_free.
+ *
+ * CRE: src is NULL.
+ * CRE: v0 or v1 is out of the range of type.
+ */
+extern UArray2_T Bit2_to_UArray2(T src, UArray2_elem type, int64_t v0,
+                                 int64_t v1);
+
+/*
+ * UArray2_otsu
+ *
+ * Returns the threshold that best splits the elements into a dark
+ * class (<= threshold) and a bright class (> threshold) by Otsu's
+ * method: the one maximizing the variance between the two
+ * classes' means, found in one pass over the parallel
+ * UArray2_histogram. If every element has the same value, that
+ * value is returned, so every element is in the dark class. Pass
+ * the result to UArray2_to_Bit2 with BIT2_GT to binarize.
+ *
+ * CRE: uarray2 is NULL.
+ * CRE: type is not UARRAY2_ELEM_U8 or UARRAY2_ELEM_U16, or the
+ *      element size of uarray2 does not match it.
+ */
+extern int64_t UArray2_otsu(UArray2_T uarray2, UArray2_elem type);
+
+#undef T
+#endif
@@ -0,0 +1,89 @@
+/*
+ * bit2rep.h
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/17/2026
+ *
+ * Purpose: Exposes the representation of Bit2_T, for bit2.c and
+ *          for hot loops that need bit access inlined. Clients
+ *          that only use bit2.h still see an opaque type.
+ *          Bit2_fast_get and Bit2_fast_put behave like Bit2_get
+ *          and Bit2_put but are static inline.
+ *
+ * Key Insight: Each row starts on a fresh 64-bit word, so bit
+ *          (col, row) is bit col % 64 of word
+ *          row * words_per_row + col / 64: a shift and a mask, no
+ *          call. Bits past width in a row's last word are always
+ *          0, so whole words can be counted with popcount. As in
+ *          uarray2rep.h, the fast accessors check their arguments
+ *          only when REP_DEBUG is defined.
+ */
+
+#ifndef BIT2REP_INCLUDED
+#define BIT2REP_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+#include "bit2.h"
+#include "assert.h"
+
+#ifdef REP_DEBUG
+#define REP_CHECK(e) assert(e)
+#else
+#define REP_CHECK(e) ((void)0)
+#endif
+
+#define BIT2_WORD_BITS 64
+
+#define T Bit2_T
+struct T {
+        int width;
+        int height;
+        int words_per_row;    /* ceil(width / 64) */
+        uint64_t *words;      /* height * words_per_row words */
+        void *map;            /* file mapping or pages, or NULL */
+        size_t map_length;    /* bytes mapped */
+        int paged;            /* 1 if map came from Pages_map */
+};
+
+/*
+ * Bit2_fast_get
+ *
+ * Same contract as Bit2_get; the CREs are checked only under
+ * REP_DEBUG.
+ */
+static inline int Bit2_fast_get(T bit2, int col, int row)
+{
+        REP_CHECK(bit2 != NULL);
+        REP_CHECK(col >= 0 && col < bit2->width);
+        REP_CHECK(row >= 0 && row < bit2->height);
+
+        uint64_t word = bit2->words[(long)row * bit2->words_per_row +
+                                    col / BIT2_WORD_BITS];
+        return (int)(word >> (col % BIT2_WORD_BITS)) & 1;
+}
+
+/*
+ * Bit2_fast_put
+ *
+ * Same contract as Bit2_put; the CREs are checked only under
+ * REP_DEBUG.
+ */
+static inline int Bit2_fast_put(T bit2, int col, int row, int value)
+{
+        REP_CHECK(bit2 != NULL);
+        REP_CHECK(col >= 0 && col < bit2->width);
+        REP_CHECK(row >= 0 && row < bit2->height);
+        REP_CHECK(value == 0 || value == 1);
+
+        uint64_t *word = &bit2->words[(long)row * bit2->words_per_row +
+                                      col / BIT2_WORD_BITS];
+        uint64_t mask  = (uint64_t)1 << (col % BIT2_WORD_BITS);
+        int previous   = (*word & mask) != 0;
+
+        *word = (*word & ~mask) | ((uint64_t)value * mask);
+        return previous;
+}
+
+#undef T
+#endif
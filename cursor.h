@@ -0,0 +1,414 @@
+/*
+ * cursor.h
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/17/2026
+ *
+ * Purpose: Defines cursors for walking a UArray2 or a Bit2 in a
+ *          plain loop instead of through a map callback. A cursor
+ *          is a small struct on the caller's stack:
+ *
+ *              UArray2_cursor c;
+ *              for (UArray2_cursor_begin(&c, a, CURSOR_ROW_MAJOR);
+ *                   UArray2_cursor_valid(&c);
+ *                   UArray2_cursor_next(&c)) {
+ *                      use(c.col, c.row, UArray2_cursor_elem(&c));
+ *              }
+ *
+ *          The loop can stop early with break, two cursors can be
+ *          advanced side by side, and since every function here is
+ *          static inline the whole loop can be inlined.
+ *
+ * Key Insight: A cursor keeps a pointer to its current element
+ *          (or, for Bit2, its current word and a one-bit mask) and
+ *          advances it by one element, one row pitch or one mask
+ *          shift. Positions are only recomputed from (col, row)
+ *          when the walk moves to a new row, column or tile.
+ */
+
+#ifndef CURSOR_INCLUDED
+#define CURSOR_INCLUDED
+
+#include <stdint.h>
+#include "uarray2rep.h"
+#include "bit2rep.h"
+
+/*
+ * Cursor_order
+ *
+ * The order a cursor visits elements in. CURSOR_TILED visits
+ * square tiles in row-major order, and the elements of each tile
+ * in row-major order; tiles at the right and bottom edges may be
+ * smaller.
+ */
+typedef enum {
+        CURSOR_ROW_MAJOR,
+        CURSOR_COL_MAJOR,
+        CURSOR_TILED
+} Cursor_order;
+
+/*
+ * Position state shared by both cursor types. col and row are the
+ * current position and may be read directly; the rest is private.
+ */
+typedef struct Cursor_pos {
+        int col;
+        int row;
+        int width;
+        int height;
+        Cursor_order order;
+        int tile;                     /* tiled: side of a tile */
+        int tile_col0, tile_row0;     /* tiled: current tile */
+        int tile_col1, tile_row1;     /*   and its far edges */
+} Cursor_pos;
+
+/*
+ * name: cursor_pos_begin
+ *
+ * description: Starts pos at the first position of a
+ * width-by-height walk in the given order.
+ */
+static inline void cursor_pos_begin(Cursor_pos *pos, int width,
+                                    int height, Cursor_order order,
+                                    int tile)
+{
+        REP_CHECK(order == CURSOR_ROW_MAJOR ||
+                  order == CURSOR_COL_MAJOR || order == CURSOR_TILED);
+        REP_CHECK(order != CURSOR_TILED || tile > 0);
+
+        pos->col       = 0;
+        pos->row       = 0;
+        pos->width     = width;
+        pos->height    = height;
+        pos->order     = order;
+        pos->tile      = tile;
+        pos->tile_col0 = 0;
+        pos->tile_row0 = 0;
+        pos->tile_col1 = tile < width ? tile : width;
+        pos->tile_row1 = tile < height ? tile : height;
+}
+
+/*
+ * name: cursor_pos_next
+ *
+ * description: Moves pos to the next position of its walk.
+ *
+ * Returns:
+ *   0 if the move stayed within the current row (row-major or
+ *   tiled) or column (column-major), so an element pointer can
+ *   simply be stepped; 1 if it jumped, so the caller must
+ *   recompute its pointer from (col, row)
+ */
+static inline int cursor_pos_next(Cursor_pos *pos)
+{
+        switch (pos->order) {
+        case CURSOR_ROW_MAJOR:
+                if (++pos->col < pos->width) {
+                        return 0;
+                }
+                pos->col = 0;
+                pos->row++;
+                return 1;
+        case CURSOR_COL_MAJOR:
+                if (++pos->row < pos->height) {
+                        return 0;
+                }
+                pos->row = 0;
+                pos->col++;
+                return 1;
+        default:
+                if (++pos->col < pos->tile_col1) {
+                        return 0;
+                }
+                pos->col = pos->tile_col0;
+                if (++pos->row < pos->tile_row1) {
+                        return 1;
+                }
+                /* Move on to the next tile */
+                pos->tile_col0 += pos->tile;
+                if (pos->tile_col0 >= pos->width) {
+                        pos->tile_col0 = 0;
+                        pos->tile_row0 += pos->tile;
+                }
+                pos->tile_col1 = pos->tile_col0 + pos->tile;
+                pos->tile_row1 = pos->tile_row0 + pos->tile;
+                if (pos->tile_col1 > pos->width) {
+                        pos->tile_col1 = pos->width;
+                }
+                if (pos->tile_row1 > pos->height) {
+                        pos->tile_row1 = pos->height;
+                }
+                pos->col = pos->tile_col0;
+                pos->row = pos->tile_row0;
+                return 1;
+        }
+}
+
+/*
+ * UArray2_cursor
+ *
+ * Cursor over a UArray2. Read the position from c.col and c.row
+ * and the element with UArray2_cursor_elem.
+ */
+typedef struct UArray2_cursor {
+        Cursor_pos pos;
+        int col;              /* copies of pos.col and pos.row */
+        int row;
+        UArray2_T array;
+        char *elem;           /* flat arrays: current element */
+        long step;            /* bytes to the next element */
+} UArray2_cursor;
+
+/*
+ * name: uarray2_cursor_seek
+ *
+ * description: Recomputes the element pointer from the position.
+ */
+static inline void uarray2_cursor_seek(UArray2_cursor *c)
+{
+        c->col = c->pos.col;
+        c->row = c->pos.row;
+        if (c->array->layout == UARRAY2_FLAT &&
+            c->row < c->pos.height && c->col < c->pos.width) {
+                c->elem = c->array->elems + c->row * c->array->stride +
+                          (long)c->col * c->array->size;
+        }
+}
+
+/*
+ * UArray2_cursor_begin
+ *
+ * Starts c at the first element of array in the given order.
+ * For CURSOR_TILED use UArray2_cursor_begin_tiled instead.
+ *
+ * CRE: c or array is NULL.
+ */
+static inline void UArray2_cursor_begin(UArray2_cursor *c,
+                                        UArray2_T array,
+                                        Cursor_order order)
+{
+        assert(c != NULL && array != NULL);
+        assert(order == CURSOR_ROW_MAJOR || order == CURSOR_COL_MAJOR);
+
+        cursor_pos_begin(&c->pos, array->width, array->height, order,
+                         1);
+        c->array = array;
+        c->elem  = NULL;
+        c->step  = order == CURSOR_COL_MAJOR ? array->stride
+                                             : array->size;
+        uarray2_cursor_seek(c);
+}
+
+/*
+ * UArray2_cursor_begin_tiled
+ *
+ * Starts c at the first element of array, visiting it tile by
+ * tile with tiles tile elements on a side.
+ *
+ * CRE: c or array is NULL, or tile <= 0.
+ */
+static inline void UArray2_cursor_begin_tiled(UArray2_cursor *c,
+                                              UArray2_T array,
+                                              int tile)
+{
+        assert(c != NULL && array != NULL);
+        assert(tile > 0);
+
+        cursor_pos_begin(&c->pos, array->width, array->height,
+                         CURSOR_TILED, tile);
+        c->array = array;
+        c->elem  = NULL;
+        c->step  = array->size;
+        uarray2_cursor_seek(c);
+}
+
+/*
+ * UArray2_cursor_valid
+ *
+ * Returns 1 while c is on an element, 0 once the walk is over.
+ */
+static inline int UArray2_cursor_valid(const UArray2_cursor *c)
+{
+        return c->row < c->pos.height && c->col < c->pos.width;
+}
+
+/*
+ * UArray2_cursor_next
+ *
+ * Advances c to the next element.
+ *
+ * CRE (under REP_DEBUG): c is not valid.
+ */
+static inline void UArray2_cursor_next(UArray2_cursor *c)
+{
+        REP_CHECK(UArray2_cursor_valid(c));
+
+        if (cursor_pos_next(&c->pos)) {
+                uarray2_cursor_seek(c);
+        } else {
+                c->col = c->pos.col;
+                c->row = c->pos.row;
+                if (c->elem != NULL) {
+                        c->elem += c->step;
+                }
+        }
+}
+
+/*
+ * UArray2_cursor_elem
+ *
+ * Returns a pointer to the element c is on, as UArray2_at would.
+ *
+ * CRE (under REP_DEBUG): c is not valid.
+ */
+static inline void *UArray2_cursor_elem(const UArray2_cursor *c)
+{
+        REP_CHECK(UArray2_cursor_valid(c));
+
+        if (c->array->layout != UARRAY2_FLAT) {
+                return UArray2_at(c->array, c->col, c->row);
+        }
+        return c->elem;
+}
+
+/*
+ * Bit2_cursor
+ *
+ * Cursor over a Bit2. Read the position from c.col and c.row,
+ * the bit with Bit2_cursor_get, and change it with
+ * Bit2_cursor_put.
+ */
+typedef struct Bit2_cursor {
+        Cursor_pos pos;
+        int col;              /* copies of pos.col and pos.row */
+        int row;
+        Bit2_T bit2;
+        uint64_t *word;       /* word holding the current bit */
+        uint64_t mask;        /* the current bit within *word */
+} Bit2_cursor;
+
+/*
+ * name: bit2_cursor_seek
+ *
+ * description: Recomputes the word and mask from the position.
+ */
+static inline void bit2_cursor_seek(Bit2_cursor *c)
+{
+        c->col = c->pos.col;
+        c->row = c->pos.row;
+        if (c->row < c->pos.height && c->col < c->pos.width) {
+                c->word = c->bit2->words +
+                          (long)c->row * c->bit2->words_per_row +
+                          c->col / BIT2_WORD_BITS;
+                c->mask = (uint64_t)1 << (c->col % BIT2_WORD_BITS);
+        }
+}
+
+/*
+ * Bit2_cursor_begin
+ *
+ * Starts c at the first bit of bit2 in the given order. For
+ * CURSOR_TILED use Bit2_cursor_begin_tiled instead.
+ *
+ * CRE: c or bit2 is NULL.
+ */
+static inline void Bit2_cursor_begin(Bit2_cursor *c, Bit2_T bit2,
+                                     Cursor_order order)
+{
+        assert(c != NULL && bit2 != NULL);
+        assert(order == CURSOR_ROW_MAJOR || order == CURSOR_COL_MAJOR);
+
+        cursor_pos_begin(&c->pos, bit2->width, bit2->height, order,
+                         1);
+        c->bit2 = bit2;
+        bit2_cursor_seek(c);
+}
+
+/*
+ * Bit2_cursor_begin_tiled
+ *
+ * Starts c at the first bit of bit2, visiting it tile by tile
+ * with tiles tile bits on a side.
+ *
+ * CRE: c or bit2 is NULL, or tile <= 0.
+ */
+static inline void Bit2_cursor_begin_tiled(Bit2_cursor *c,
+                                           Bit2_T bit2, int tile)
+{
+        assert(c != NULL && bit2 != NULL);
+        assert(tile > 0);
+
+        cursor_pos_begin(&c->pos, bit2->width, bit2->height,
+                         CURSOR_TILED, tile);
+        c->bit2 = bit2;
+        bit2_cursor_seek(c);
+}
+
+/*
+ * Bit2_cursor_valid
+ *
+ * Returns 1 while c is on a bit, 0 once the walk is over.
+ */
+static inline int Bit2_cursor_valid(const Bit2_cursor *c)
+{
+        return c->row < c->pos.height && c->col < c->pos.width;
+}
+
+/*
+ * Bit2_cursor_next
+ *
+ * Advances c to the next bit. Along a row this shifts the mask,
+ * moving to the next word only when the mask runs out; down a
+ * column it steps the word pointer by one row.
+ *
+ * CRE (under REP_DEBUG): c is not valid.
+ */
+static inline void Bit2_cursor_next(Bit2_cursor *c)
+{
+        REP_CHECK(Bit2_cursor_valid(c));
+
+        if (cursor_pos_next(&c->pos)) {
+                bit2_cursor_seek(c);
+                return;
+        }
+        c->col = c->pos.col;
+        c->row = c->pos.row;
+        if (c->pos.order == CURSOR_COL_MAJOR) {
+                c->word += c->bit2->words_per_row;
+        } else if ((c->mask <<= 1) == 0) {
+                c->word++;
+                c->mask = 1;
+        }
+}
+
+/*
+ * Bit2_cursor_get
+ *
+ * Returns the bit c is on.
+ *
+ * CRE (under REP_DEBUG): c is not valid.
+ */
+static inline int Bit2_cursor_get(const Bit2_cursor *c)
+{
+        REP_CHECK(Bit2_cursor_valid(c));
+        return (*c->word & c->mask) != 0;
+}
+
+/*
+ * Bit2_cursor_put
+ *
+ * Sets the bit c is on to value and returns its previous value.
+ *
+ * CRE (under REP_DEBUG): c is not valid, or value is not 0 or 1.
+ */
+static inline int Bit2_cursor_put(Bit2_cursor *c, int value)
+{
+        REP_CHECK(Bit2_cursor_valid(c));
+        REP_CHECK(value == 0 || value == 1);
+
+        int previous = (*c->word & c->mask) != 0;
+        *c->word = (*c->word & ~c->mask) | ((uint64_t)value * c->mask);
+        return previous;
+}
+
+#endif
@@ -0,0 +1,89 @@
+/*
+ * pages.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/17/2026
+ *
+ * Purpose: Implements Pages_map with anonymous mmap.
+ *
+ * Key Insight: mmap only promises page alignment, so for huge
+ *          pages Pages_map over-allocates by one huge page and
+ *          unmaps the unaligned head and tail, leaving a region
+ *          that starts on a 2 MB boundary.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <stdint.h>
+#include <sys/mman.h>
+#include "pages.h"
+#include "assert.h"
+
+#define HUGE_PAGE  ((size_t)2 << 20)  /* x86-64 and arm64 default */
+#define SMALL_PAGE ((size_t)4096)     /* smallest page size touched */
+
+/*
+ * Pages_map - see pages.h for contract
+ */
+void *Pages_map(size_t bytes, int flags, size_t *length)
+{
+        assert(bytes > 0);
+        assert(length != NULL);
+
+        int map_flags = MAP_PRIVATE | MAP_ANONYMOUS;
+        if (!(flags & PAGES_HUGE)) {
+#ifdef MAP_POPULATE
+                if (flags & PAGES_POPULATE) {
+                        map_flags |= MAP_POPULATE;
+                }
+#endif
+                void *pages = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                                   map_flags, -1, 0);
+                assert(pages != MAP_FAILED);
+                *length = bytes;
+                return pages;
+        }
+
+        size_t rounded = (bytes + HUGE_PAGE - 1) / HUGE_PAGE *
+                         HUGE_PAGE;
+        size_t padded  = rounded + HUGE_PAGE;
+        char *raw = mmap(NULL, padded, PROT_READ | PROT_WRITE,
+                         map_flags, -1, 0);
+        assert(raw != MAP_FAILED);
+
+        uintptr_t start = ((uintptr_t)raw + HUGE_PAGE - 1) /
+                          HUGE_PAGE * HUGE_PAGE;
+        char *pages = (char *)start;
+        size_t head = pages - raw;
+        size_t tail = padded - head - rounded;
+        if (head > 0) {
+                munmap(raw, head);
+        }
+        if (tail > 0) {
+                munmap(pages + rounded, tail);
+        }
+
+#ifdef MADV_HUGEPAGE
+        madvise(pages, rounded, MADV_HUGEPAGE);
+#endif
+        /*
+         * Populate only now, after the advice, so the faults get huge
+         * pages; MAP_POPULATE would have faulted small ones in mmap.
+         */
+        if (flags & PAGES_POPULATE) {
+                for (size_t i = 0; i < rounded; i += SMALL_PAGE) {
+                        pages[i] = 0;
+                }
+        }
+        *length = rounded;
+        return pages;
+}
+
+/*
+ * Pages_unmap - see pages.h for contract
+ */
+void Pages_unmap(void *pages, size_t length)
+{
+        assert(pages != NULL);
+        munmap(pages, length);
+}
@@ -0,0 +1,64 @@
+/*
+ * pages.h
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/17/2026
+ *
+ * Purpose: Defines page-level allocation for large grids: zeroed
+ *          anonymous memory mapped directly from the kernel,
+ *          optionally backed by transparent huge pages or faulted
+ *          in up front. UArray2 and Bit2 use it for their
+ *          allocation-flag constructors.
+ *
+ * Key Insight: A 2 MB huge page covers 512 ordinary pages with one
+ *          TLB entry, so a scan over a grid of hundreds of
+ *          megabytes misses the TLB far less often. The kernel
+ *          only backs a region with huge pages if it is aligned to
+ *          the huge page size, so Pages_map aligns the mapping
+ *          itself.
+ */
+
+#ifndef PAGES_INCLUDED
+#define PAGES_INCLUDED
+
+#include <stddef.h>
+
+/*
+ * Flags for Pages_map; 0 or more may be given.
+ *
+ *   PAGES_HUGE     - align to 2 MB and ask for transparent huge
+ *                    pages (madvise MADV_HUGEPAGE)
+ *   PAGES_POPULATE - fault every page in now (MAP_POPULATE), on
+ *                    the calling thread
+ */
+#define PAGES_HUGE     0x1
+#define PAGES_POPULATE 0x2
+
+/*
+ * Pages_map
+ *
+ * Returns the address of bytes bytes of zeroed memory, mapped
+ * straight from the kernel rather than from malloc. Pages that
+ * are not populated are faulted in by whichever thread first
+ * touches them. Flags the system does not support are ignored.
+ *
+ * Parameters:
+ *   bytes  - number of bytes needed; must be > 0
+ *   flags  - PAGES_* flags as described above
+ *   length - set to the length to pass to Pages_unmap
+ *
+ * CRE: bytes is 0, length is NULL, or the memory cannot be
+ *      mapped.
+ */
+extern void *Pages_map(size_t bytes, int flags, size_t *length);
+
+/*
+ * Pages_unmap
+ *
+ * Returns memory from Pages_map to the kernel.
+ *
+ * CRE: pages is NULL.
+ */
+extern void Pages_unmap(void *pages, size_t length);
+
+#endif
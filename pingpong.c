@@ -0,0 +1,175 @@
+/*
+ * pingpong.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/17/2026
+ *
+ * Purpose: Implements Pingpong_T as two padded UArray2s and an
+ *          index saying which one is in front.
+ *
+ * Key Insight: Pingpong_iterate splits the rows into a few bands
+ *          per pool thread. Pool_run returns only when every band
+ *          of a step is done, which is the barrier that makes the
+ *          swap after it safe.
+ */
+
+#include <stdlib.h>
+#include "pingpong.h"
+#include "assert.h"
+#include "mem.h"
+
+#define BANDS_PER_THREAD 4    /* lets faster threads take extra bands */
+
+#define T Pingpong_T
+struct T {
+        UArray2_T arrays[2];
+        int front;            /* index of the front array */
+};
+
+/*
+ * One step of Pingpong_iterate: the arrays and how its rows are
+ * split into bands.
+ */
+typedef struct Step {
+        UArray2_T front;
+        UArray2_T back;
+        int height;
+        int nbands;
+        Pingpong_bandfun *band;
+        void *cl;
+} Step;
+
+/*
+ * Pingpong_new - see pingpong.h for contract
+ */
+T Pingpong_new(int width, int height, int size, int ghost)
+{
+        T pair;
+        NEW(pair);
+        for (int i = 0; i < 2; i++) {
+                pair->arrays[i] = UArray2_new_padded(width, height,
+                                                     size, ghost);
+        }
+        pair->front = 0;
+        return pair;
+}
+
+/*
+ * Pingpong_free - see pingpong.h for contract
+ */
+void Pingpong_free(T *pair)
+{
+        assert(pair != NULL && *pair != NULL);
+        UArray2_free(&(*pair)->arrays[0]);
+        UArray2_free(&(*pair)->arrays[1]);
+        FREE(*pair);
+}
+
+/*
+ * Pingpong_front - see pingpong.h for contract
+ */
+UArray2_T Pingpong_front(T pair)
+{
+        assert(pair != NULL);
+        return pair->arrays[pair->front];
+}
+
+/*
+ * Pingpong_back - see pingpong.h for contract
+ */
+UArray2_T Pingpong_back(T pair)
+{
+        assert(pair != NULL);
+        return pair->arrays[1 - pair->front];
+}
+
+/*
+ * Pingpong_swap - see pingpong.h for contract
+ */
+void Pingpong_swap(T pair)
+{
+        assert(pair != NULL);
+        pair->front = 1 - pair->front;
+}
+
+/*
+ * Pingpong_map - see pingpong.h for contract
+ */
+void Pingpong_map(T pair, Pingpong_stepfun *step, void *cl)
+{
+        assert(pair != NULL);
+        assert(step != NULL);
+
+        UArray2_T front = Pingpong_front(pair);
+        UArray2_T back  = Pingpong_back(pair);
+        char *src  = UArray2_base(front);
+        char *dst  = UArray2_base(back);
+        long pitch = UArray2_pitch(front);
+        int width  = UArray2_width(front);
+        int height = UArray2_height(front);
+        int size   = UArray2_size(front);
+
+        for (int row = 0; row < height; row++) {
+                long offset = row * pitch;
+                for (int col = 0; col < width; col++) {
+                        step(col, row, front, src + offset,
+                             dst + offset, cl);
+                        offset += size;
+                }
+        }
+}
+
+/*
+ * name: run_band
+ *
+ * description: Pool task computing band number index of a step.
+ */
+static void run_band(int index, int thread, void *cl)
+{
+        Step *step = cl;
+        int row0 = (int)((long)step->height * index / step->nbands);
+        int row1 = (int)((long)step->height * (index + 1) /
+                         step->nbands);
+        (void)thread;
+
+        if (row0 < row1) {
+                step->band(step->front, step->back, row0, row1,
+                           step->cl);
+        }
+}
+
+/*
+ * Pingpong_iterate - see pingpong.h for contract
+ */
+void Pingpong_iterate(T pair, int iterations, UArray2_border mode,
+                      Pingpong_bandfun *band, void *cl, Pool_T pool)
+{
+        assert(pair != NULL);
+        assert(band != NULL);
+        assert(iterations >= 0);
+
+        Step step;
+        step.height = UArray2_height(pair->arrays[0]);
+        step.band   = band;
+        step.cl     = cl;
+        step.nbands = 1;
+        if (pool != NULL) {
+                step.nbands = Pool_size(pool) * BANDS_PER_THREAD;
+                if (step.nbands > step.height) {
+                        step.nbands = step.height;
+                }
+        }
+
+        for (int i = 0; i < iterations; i++) {
+                step.front = Pingpong_front(pair);
+                step.back  = Pingpong_back(pair);
+                UArray2_fill_ghosts(step.front, mode);
+                if (pool == NULL) {
+                        band(step.front, step.back, 0, step.height,
+                             cl);
+                } else {
+                        Pool_run(pool, step.nbands, run_band, &step);
+                }
+                Pingpong_swap(pair);
+        }
+}
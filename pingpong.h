@@ -0,0 +1,136 @@
+/*
+ * pingpong.h
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/17/2026
+ *
+ * Purpose: Defines Pingpong_T, a pair of equally shaped UArray2s
+ *          for iterative computations such as relaxation, cellular
+ *          automata and repeated morphology. Each step reads the
+ *          front array and writes the back array, then the two
+ *          are swapped, so no array is allocated or copied between
+ *          iterations.
+ *
+ * Key Insight: Swapping only exchanges two pointers. Within a
+ *          step every row of the back array depends only on the
+ *          front array, so bands of rows can be computed in
+ *          parallel, with one barrier before each swap.
+ */
+
+#ifndef PINGPONG_INCLUDED
+#define PINGPONG_INCLUDED
+
+#include "uarray2.h"
+#include "pool.h"
+
+#define T Pingpong_T
+typedef struct T *T;
+
+/*
+ * Pingpong_stepfun
+ *
+ * Computes element (col, row) of the back array. src points to
+ * element (col, row) of front and dst to the same element of the
+ * back array; neighbours are read through front.
+ */
+typedef void Pingpong_stepfun(int col, int row, UArray2_T front,
+                              const void *src, void *dst, void *cl);
+
+/*
+ * Pingpong_bandfun
+ *
+ * Computes rows row0 .. row1 - 1 of back from front. Bands of one
+ * step may run at the same time on different threads, so a band
+ * function must only write its own rows of back.
+ */
+typedef void Pingpong_bandfun(UArray2_T front, UArray2_T back,
+                              int row0, int row1, void *cl);
+
+/*
+ * Pingpong_new
+ *
+ * Allocates two zero-filled width-by-height arrays of size-byte
+ * elements, each made with UArray2_new_padded so that kernels can
+ * read ghost elements beyond each edge.
+ *
+ * Parameters:
+ *   width  - number of columns; must be > 0
+ *   height - number of rows; must be > 0
+ *   size   - size (in bytes) of each element; must be > 0
+ *   ghost  - depth of each array's ghost border; must be >= 0
+ *
+ * Returns: A new Pingpong_T.
+ *
+ * CRE: width <= 0, height <= 0, size <= 0, or ghost < 0.
+ * CRE: memory allocation failure.
+ */
+extern T Pingpong_new(int width, int height, int size, int ghost);
+
+/*
+ * Pingpong_free
+ *
+ * Deallocates both arrays and the pair, setting *pair to NULL.
+ *
+ * CRE: pair or *pair is NULL.
+ */
+extern void Pingpong_free(T *pair);
+
+/*
+ * Pingpong_front / Pingpong_back
+ *
+ * Return the array the next step reads and the one it writes.
+ * Either may be used as an ordinary UArray2, for example to set
+ * the initial state or read the result, but neither may be freed
+ * by the caller. Which array is which changes on every swap.
+ *
+ * CRE: pair is NULL.
+ */
+extern UArray2_T Pingpong_front(T pair);
+extern UArray2_T Pingpong_back(T pair);
+
+/*
+ * Pingpong_swap
+ *
+ * Exchanges the front and back arrays, so the array just written
+ * becomes the one the next step reads.
+ *
+ * CRE: pair is NULL.
+ */
+extern void Pingpong_swap(T pair);
+
+/*
+ * Pingpong_map
+ *
+ * Calls step for every element in row-major order, reading the
+ * front array and writing the back array. Does not swap.
+ *
+ * CRE: pair is NULL or step is NULL.
+ */
+extern void Pingpong_map(T pair, Pingpong_stepfun *step, void *cl);
+
+/*
+ * Pingpong_iterate
+ *
+ * Runs iterations steps. Each step fills the front array's ghost
+ * cells by mode, computes every row of the back array with band,
+ * waits for all bands to finish, and swaps. The bands are run on
+ * pool, or one after another on the calling thread if pool is
+ * NULL. Afterwards the result of the last step is in front.
+ *
+ * Parameters:
+ *   pair       - the arrays to iterate on
+ *   iterations - number of steps; may be 0
+ *   mode       - how the ghost cells are filled before each step
+ *   band       - function computing a band of rows
+ *   cl         - closure passed to each band call
+ *   pool       - threads to run bands on, or NULL
+ *
+ * CRE: pair is NULL, band is NULL, or iterations < 0.
+ */
+extern void Pingpong_iterate(T pair, int iterations,
+                             UArray2_border mode,
+                             Pingpong_bandfun *band, void *cl,
+                             Pool_T pool);
+
+#undef T
+#endif
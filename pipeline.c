@@ -0,0 +1,307 @@
+/*
+ * pipeline.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/17/2026
+ *
+ * Purpose: Implements the read / work / write pipeline with POSIX
+ *          threads. Readers claim indices from a shared counter,
+ *          and two bounded channels carry items from readers to
+ *          workers and from workers to writers.
+ *
+ * Key Insight: A channel counts the producers still feeding it.
+ *          When the last one finishes, the channel is closed and
+ *          its consumers drain what is left and exit, so shutdown
+ *          needs no sentinel items.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+#include "pipeline.h"
+#include "assert.h"
+#include "mem.h"
+
+/*
+ * Bounded FIFO of items between two stages.
+ */
+typedef struct Channel {
+        void **items;          /* ring buffer of capacity slots */
+        int capacity;
+        int head;              /* index of oldest item */
+        int count;             /* items currently queued */
+        int producers;         /* producers not yet finished */
+        pthread_mutex_t lock;
+        pthread_cond_t not_empty;
+        pthread_cond_t not_full;
+} Channel;
+
+/*
+ * State shared by every thread of one Pipeline_run.
+ */
+typedef struct Run {
+        int nitems;
+        int next_index;        /* next index a reader will claim */
+        Pipeline_readfun *read;
+        Pipeline_workfun *work;
+        Pipeline_writefun *write;
+        void *cl;
+        Channel channel[2];    /* read -> work, work -> write */
+        double busy[PIPELINE_STAGES];
+        pthread_mutex_t lock;  /* guards next_index and busy */
+} Run;
+
+/*
+ * name: now
+ *
+ * description: Returns a monotonic timestamp in seconds.
+ */
+static double now(void)
+{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*
+ * name: Channel_init
+ *
+ * description: Prepares an empty channel with room for capacity
+ * items and the given number of producers.
+ */
+static void Channel_init(Channel *ch, int capacity, int producers)
+{
+        ch->items     = ALLOC(capacity * (long)sizeof(void *));
+        ch->capacity  = capacity;
+        ch->head      = 0;
+        ch->count     = 0;
+        ch->producers = producers;
+        pthread_mutex_init(&ch->lock, NULL);
+        pthread_cond_init(&ch->not_empty, NULL);
+        pthread_cond_init(&ch->not_full, NULL);
+}
+
+/*
+ * name: Channel_destroy
+ *
+ * description: Releases a drained channel's storage.
+ */
+static void Channel_destroy(Channel *ch)
+{
+        pthread_cond_destroy(&ch->not_full);
+        pthread_cond_destroy(&ch->not_empty);
+        pthread_mutex_destroy(&ch->lock);
+        FREE(ch->items);
+}
+
+/*
+ * name: Channel_put
+ *
+ * description: Appends item, blocking while the channel is full.
+ */
+static void Channel_put(Channel *ch, void *item)
+{
+        pthread_mutex_lock(&ch->lock);
+        while (ch->count == ch->capacity) {
+                pthread_cond_wait(&ch->not_full, &ch->lock);
+        }
+        ch->items[(ch->head + ch->count) % ch->capacity] = item;
+        ch->count++;
+        pthread_cond_signal(&ch->not_empty);
+        pthread_mutex_unlock(&ch->lock);
+}
+
+/*
+ * name: Channel_get
+ *
+ * description: Removes and returns the oldest item, blocking
+ * while the channel is empty but still has producers. Returns
+ * NULL once the channel is empty and every producer is done.
+ */
+static void *Channel_get(Channel *ch)
+{
+        void *item = NULL;
+
+        pthread_mutex_lock(&ch->lock);
+        while (ch->count == 0 && ch->producers > 0) {
+                pthread_cond_wait(&ch->not_empty, &ch->lock);
+        }
+        if (ch->count > 0) {
+                item = ch->items[ch->head];
+                ch->head = (ch->head + 1) % ch->capacity;
+                ch->count--;
+                pthread_cond_signal(&ch->not_full);
+        }
+        pthread_mutex_unlock(&ch->lock);
+        return item;
+}
+
+/*
+ * name: Channel_done
+ *
+ * description: Records that one producer has finished. The last
+ * one wakes every waiting consumer so they can see the close.
+ */
+static void Channel_done(Channel *ch)
+{
+        pthread_mutex_lock(&ch->lock);
+        if (--ch->producers == 0) {
+                pthread_cond_broadcast(&ch->not_empty);
+        }
+        pthread_mutex_unlock(&ch->lock);
+}
+
+/*
+ * name: add_busy
+ *
+ * description: Adds one thread's callback time to its stage.
+ */
+static void add_busy(Run *run, int stage, double seconds)
+{
+        pthread_mutex_lock(&run->lock);
+        run->busy[stage] += seconds;
+        pthread_mutex_unlock(&run->lock);
+}
+
+/*
+ * name: read_main
+ *
+ * description: Reader thread: claims indices until none are
+ * left, reads each item, and passes it to the workers.
+ */
+static void *read_main(void *arg)
+{
+        Run *run = arg;
+        double busy = 0;
+
+        for (;;) {
+                pthread_mutex_lock(&run->lock);
+                int index = run->next_index < run->nitems
+                            ? run->next_index++ : -1;
+                pthread_mutex_unlock(&run->lock);
+                if (index < 0) {
+                        break;
+                }
+
+                double start = now();
+                void *item = run->read(index, run->cl);
+                busy += now() - start;
+
+                assert(item != NULL);
+                Channel_put(&run->channel[0], item);
+        }
+
+        add_busy(run, PIPELINE_READ, busy);
+        Channel_done(&run->channel[0]);
+        return NULL;
+}
+
+/*
+ * name: work_main
+ *
+ * description: Worker thread: processes items from the readers
+ * and passes them to the writers.
+ */
+static void *work_main(void *arg)
+{
+        Run *run = arg;
+        double busy = 0;
+        void *item;
+
+        while ((item = Channel_get(&run->channel[0])) != NULL) {
+                double start = now();
+                run->work(item, run->cl);
+                busy += now() - start;
+                Channel_put(&run->channel[1], item);
+        }
+
+        add_busy(run, PIPELINE_WORK, busy);
+        Channel_done(&run->channel[1]);
+        return NULL;
+}
+
+/*
+ * name: write_main
+ *
+ * description: Writer thread: writes out processed items.
+ */
+static void *write_main(void *arg)
+{
+        Run *run = arg;
+        double busy = 0;
+        void *item;
+
+        while ((item = Channel_get(&run->channel[1])) != NULL) {
+                double start = now();
+                run->write(item, run->cl);
+                busy += now() - start;
+        }
+
+        add_busy(run, PIPELINE_WRITE, busy);
+        return NULL;
+}
+
+/*
+ * Pipeline_run - see pipeline.h for contract
+ */
+void Pipeline_run(int nitems, Pipeline_readfun *read,
+                  Pipeline_workfun *work, Pipeline_writefun *write,
+                  void *cl, const int threads[PIPELINE_STAGES],
+                  int depth, Pipeline_stats *stats)
+{
+        static void *(*const mains[PIPELINE_STAGES])(void *) = {
+                read_main, work_main, write_main
+        };
+
+        assert(nitems >= 0);
+        assert(read != NULL && work != NULL && write != NULL);
+        assert(depth >= 1);
+
+        Run run;
+        int total = 0;
+        for (int s = 0; s < PIPELINE_STAGES; s++) {
+                assert(threads[s] >= 1);
+                total += threads[s];
+                run.busy[s] = 0;
+        }
+        run.nitems     = nitems;
+        run.next_index = 0;
+        run.read       = read;
+        run.work       = work;
+        run.write      = write;
+        run.cl         = cl;
+        pthread_mutex_init(&run.lock, NULL);
+        Channel_init(&run.channel[0], depth, threads[PIPELINE_READ]);
+        Channel_init(&run.channel[1], depth, threads[PIPELINE_WORK]);
+
+        pthread_t *tids = ALLOC(total * (long)sizeof(pthread_t));
+        double start    = now();
+
+        int t = 0;
+        for (int s = 0; s < PIPELINE_STAGES; s++) {
+                for (int i = 0; i < threads[s]; i++, t++) {
+                        int rc = pthread_create(&tids[t], NULL,
+                                                mains[s], &run);
+                        assert(rc == 0);
+                }
+        }
+        for (t = 0; t < total; t++) {
+                pthread_join(tids[t], NULL);
+        }
+
+        if (stats != NULL) {
+                stats->items = nitems;
+                stats->wall  = now() - start;
+                for (int s = 0; s < PIPELINE_STAGES; s++) {
+                        stats->busy[s]    = run.busy[s];
+                        stats->threads[s] = threads[s];
+                }
+        }
+
+        FREE(tids);
+        Channel_destroy(&run.channel[1]);
+        Channel_destroy(&run.channel[0]);
+        pthread_mutex_destroy(&run.lock);
+}
@@ -0,0 +1,94 @@
+/*
+ * pipeline.h
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/17/2026
+ *
+ * Purpose: Defines a three-stage read / work / write pipeline for
+ *          batch runs. Each stage runs on its own pool of threads
+ *          and hands items to the next stage through a bounded
+ *          queue, so reading the next page, processing the current
+ *          one, and writing the previous one all overlap.
+ *
+ * Key Insight: With the stages overlapped, batch throughput is
+ *          set by the slowest stage instead of the sum of all
+ *          three. The per-stage busy times reported in
+ *          Pipeline_stats show which stage that is.
+ */
+
+#ifndef PIPELINE_INCLUDED
+#define PIPELINE_INCLUDED
+
+/* Stage indices into Pipeline_stats */
+enum { PIPELINE_READ = 0, PIPELINE_WORK = 1, PIPELINE_WRITE = 2,
+       PIPELINE_STAGES = 3 };
+
+/*
+ * Pipeline_readfun
+ *
+ * Produces item number index (0 <= index < nitems). Called once
+ * per index, from some reader thread. Returns the item, which is
+ * passed on to the work stage.
+ */
+typedef void *Pipeline_readfun(int index, void *cl);
+
+/*
+ * Pipeline_workfun
+ *
+ * Processes one item in place. Called from some worker thread.
+ */
+typedef void Pipeline_workfun(void *item, void *cl);
+
+/*
+ * Pipeline_writefun
+ *
+ * Consumes one processed item and releases it. Called from some
+ * writer thread.
+ */
+typedef void Pipeline_writefun(void *item, void *cl);
+
+/*
+ * Pipeline_stats
+ *
+ * Timing for one Pipeline_run. busy[s] is the total time threads
+ * of stage s spent inside its callback, summed over threads, so
+ * busy[s] / (wall * threads[s]) is the stage's utilization.
+ */
+typedef struct Pipeline_stats {
+        int items;                         /* items processed */
+        double wall;                       /* elapsed seconds */
+        double busy[PIPELINE_STAGES];      /* callback seconds */
+        int threads[PIPELINE_STAGES];      /* threads per stage */
+} Pipeline_stats;
+
+/*
+ * Pipeline_run
+ *
+ * Runs every index 0 .. nitems - 1 through read, work and write,
+ * with the given number of threads per stage and at most depth
+ * items waiting between any two stages. Items may finish in any
+ * order. Returns once every item has been written. The callbacks
+ * must be safe to call concurrently with each other and with
+ * themselves.
+ *
+ * Parameters:
+ *   nitems  - number of items to process; may be 0
+ *   read    - reader stage callback
+ *   work    - worker stage callback
+ *   write   - writer stage callback
+ *   cl      - closure passed to every callback
+ *   threads - threads for the read, work and write stages
+ *   depth   - capacity of each queue between stages
+ *   stats   - filled in with timings if not NULL
+ *
+ * CRE: nitems < 0, or read, work or write is NULL.
+ * CRE: any entry of threads < 1, or depth < 1.
+ * CRE: a thread cannot be created.
+ */
+extern void Pipeline_run(int nitems, Pipeline_readfun *read,
+                         Pipeline_workfun *work,
+                         Pipeline_writefun *write, void *cl,
+                         const int threads[PIPELINE_STAGES],
+                         int depth, Pipeline_stats *stats);
+
+#endif
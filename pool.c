@@ -0,0 +1,290 @@
+/*
+ * pool.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/17/2026
+ *
+ * Purpose: Implements the thread pool with POSIX threads. Each
+ *          Pool_run publishes one job, wakes the workers by
+ *          bumping a generation counter, and takes part in the
+ *          job itself until every task index has been claimed (or,
+ *          for Pool_run_static, until its own share is done).
+ *
+ * Key Insight: Workers remember the last generation they worked
+ *          on, so a single broadcast starts every one of them and
+ *          none can run the same job twice. The caller waits for
+ *          the count of active workers to reach zero before it
+ *          returns, which is what makes Pool_run a barrier.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "pool.h"
+#include "assert.h"
+#include "mem.h"
+
+#define MAX_SHARED_THREADS 64
+
+#define T Pool_T
+struct T {
+        int nthreads;
+        pthread_t *tids;          /* the nthreads - 1 workers */
+        pthread_mutex_t run_lock; /* one Pool_run at a time */
+        pthread_mutex_t lock;     /* guards everything below */
+        pthread_cond_t start;
+        pthread_cond_t done;
+        unsigned long generation; /* bumped once per job */
+        int stop;
+        Pool_taskfun *task;
+        void *cl;
+        int ntasks;
+        int fixed;                /* 1: Pool_run_static's split */
+        int next;                 /* next task index to claim */
+        int active;               /* workers still in this job */
+};
+
+/*
+ * Start-up argument for one worker thread.
+ */
+typedef struct Worker {
+        T pool;
+        int thread;
+} Worker;
+
+static T shared;
+static pthread_once_t shared_once = PTHREAD_ONCE_INIT;
+
+/*
+ * name: run_tasks
+ *
+ * description: Runs this thread's part of the current job: its
+ * own share of the indices for Pool_run_static, and otherwise
+ * indices claimed one at a time until none are left.
+ */
+static void run_tasks(T pool, int thread)
+{
+        if (pool->fixed) {
+                int first = (int)((long)pool->ntasks * thread /
+                                  pool->nthreads);
+                int last  = (int)((long)pool->ntasks * (thread + 1) /
+                                  pool->nthreads);
+                for (int index = first; index < last; index++) {
+                        pool->task(index, thread, pool->cl);
+                }
+                return;
+        }
+        for (;;) {
+                pthread_mutex_lock(&pool->lock);
+                int index = pool->next < pool->ntasks
+                            ? pool->next++ : -1;
+                pthread_mutex_unlock(&pool->lock);
+                if (index < 0) {
+                        return;
+                }
+                pool->task(index, thread, pool->cl);
+        }
+}
+
+/*
+ * name: worker_main
+ *
+ * description: Worker thread: sleeps until a new job is
+ * published, helps run it, and reports back, until stopped.
+ */
+static void *worker_main(void *arg)
+{
+        Worker *worker = arg;
+        T pool = worker->pool;
+        int thread = worker->thread;
+        unsigned long seen = 0;
+
+        FREE(worker);
+        for (;;) {
+                pthread_mutex_lock(&pool->lock);
+                while (pool->generation == seen && !pool->stop) {
+                        pthread_cond_wait(&pool->start, &pool->lock);
+                }
+                if (pool->stop) {
+                        pthread_mutex_unlock(&pool->lock);
+                        return NULL;
+                }
+                seen = pool->generation;
+                pthread_mutex_unlock(&pool->lock);
+
+                run_tasks(pool, thread);
+
+                pthread_mutex_lock(&pool->lock);
+                if (--pool->active == 0) {
+                        pthread_cond_signal(&pool->done);
+                }
+                pthread_mutex_unlock(&pool->lock);
+        }
+}
+
+/*
+ * Pool_new - see pool.h for contract
+ */
+T Pool_new(int nthreads)
+{
+        assert(nthreads >= 1);
+
+        T pool;
+        NEW(pool);
+        pool->nthreads   = nthreads;
+        pool->tids       = ALLOC(nthreads * (long)sizeof(pthread_t));
+        pool->generation = 0;
+        pool->stop       = 0;
+        pool->task       = NULL;
+        pool->cl         = NULL;
+        pool->ntasks     = 0;
+        pool->fixed      = 0;
+        pool->next       = 0;
+        pool->active     = 0;
+        pthread_mutex_init(&pool->run_lock, NULL);
+        pthread_mutex_init(&pool->lock, NULL);
+        pthread_cond_init(&pool->start, NULL);
+        pthread_cond_init(&pool->done, NULL);
+
+        for (int t = 1; t < nthreads; t++) {
+                Worker *worker;
+                NEW(worker);
+                worker->pool   = pool;
+                worker->thread = t;
+                int rc = pthread_create(&pool->tids[t], NULL,
+                                        worker_main, worker);
+                assert(rc == 0);
+        }
+        return pool;
+}
+
+/*
+ * name: make_shared
+ *
+ * description: Creates the shared pool; run once by pthread_once.
+ */
+static void make_shared(void)
+{
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+
+        if (online < 1) {
+                online = 1;
+        } else if (online > MAX_SHARED_THREADS) {
+                online = MAX_SHARED_THREADS;
+        }
+        shared = Pool_new((int)online);
+}
+
+/*
+ * Pool_shared - see pool.h for contract
+ */
+T Pool_shared(void)
+{
+        pthread_once(&shared_once, make_shared);
+        return shared;
+}
+
+/*
+ * Pool_free - see pool.h for contract
+ */
+void Pool_free(T *pool)
+{
+        assert(pool != NULL && *pool != NULL);
+        assert(*pool != shared);
+
+        T p = *pool;
+        pthread_mutex_lock(&p->lock);
+        p->stop = 1;
+        pthread_cond_broadcast(&p->start);
+        pthread_mutex_unlock(&p->lock);
+        for (int t = 1; t < p->nthreads; t++) {
+                pthread_join(p->tids[t], NULL);
+        }
+
+        pthread_cond_destroy(&p->done);
+        pthread_cond_destroy(&p->start);
+        pthread_mutex_destroy(&p->lock);
+        pthread_mutex_destroy(&p->run_lock);
+        FREE(p->tids);
+        FREE(*pool);
+}
+
+/*
+ * Pool_size - see pool.h for contract
+ */
+int Pool_size(T pool)
+{
+        assert(pool != NULL);
+        return pool->nthreads;
+}
+
+/*
+ * name: run_job
+ *
+ * description: Publishes one job, takes part in it as thread 0,
+ * and waits for every worker to finish it.
+ *
+ * Parameters:
+ *   pool   - the pool to run on
+ *   ntasks - number of tasks; must be > 0
+ *   task   - function to call for each task
+ *   cl     - closure passed to each task call
+ *   fixed  - 1 to split the indices as Pool_run_static does, 0
+ *            to let threads claim them
+ */
+static void run_job(T pool, int ntasks, Pool_taskfun *task, void *cl,
+                    int fixed)
+{
+        pthread_mutex_lock(&pool->run_lock);
+
+        pthread_mutex_lock(&pool->lock);
+        pool->task   = task;
+        pool->cl     = cl;
+        pool->ntasks = ntasks;
+        pool->fixed  = fixed;
+        pool->next   = 0;
+        pool->active = pool->nthreads - 1;
+        pool->generation++;
+        pthread_cond_broadcast(&pool->start);
+        pthread_mutex_unlock(&pool->lock);
+
+        run_tasks(pool, 0);
+
+        pthread_mutex_lock(&pool->lock);
+        while (pool->active > 0) {
+                pthread_cond_wait(&pool->done, &pool->lock);
+        }
+        pthread_mutex_unlock(&pool->lock);
+
+        pthread_mutex_unlock(&pool->run_lock);
+}
+
+/*
+ * Pool_run - see pool.h for contract
+ */
+void Pool_run(T pool, int ntasks, Pool_taskfun *task, void *cl)
+{
+        assert(pool != NULL);
+        assert(task != NULL);
+        assert(ntasks >= 0);
+
+        if (ntasks > 0) {
+                run_job(pool, ntasks, task, cl, 0);
+        }
+}
+
+/*
+ * Pool_run_static - see pool.h for contract
+ */
+void Pool_run_static(T pool, int ntasks, Pool_taskfun *task, void *cl)
+{
+        assert(pool != NULL);
+        assert(task != NULL);
+        assert(ntasks >= 0);
+
+        if (ntasks > 0) {
+                run_job(pool, ntasks, task, cl, 1);
+        }
+}
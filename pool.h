@@ -0,0 +1,117 @@
+/*
+ * pool.h
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/17/2026
+ *
+ * Purpose: Defines a fixed pool of worker threads for fork-join
+ *          parallel loops over arrays. Pool_run hands out task
+ *          indices to every thread of the pool (Pool_run_static
+ *          in a fixed split) and returns once all of them are
+ *          done, so each call acts as a barrier.
+ *
+ * Key Insight: The threads are created once and sleep between
+ *          runs, so a loop that calls Pool_run thousands of times
+ *          pays for thread creation only once.
+ */
+
+#ifndef POOL_INCLUDED
+#define POOL_INCLUDED
+
+#define T Pool_T
+typedef struct T *T;
+
+/*
+ * Pool_taskfun
+ *
+ * Runs task number index (0 <= index < ntasks). thread is the
+ * index (0 <= thread < Pool_size) of the pool thread running it,
+ * so tasks can keep per-thread state in an array without locks.
+ */
+typedef void Pool_taskfun(int index, int thread, void *cl);
+
+/*
+ * Pool_new
+ *
+ * Creates a pool of nthreads threads. The thread that calls
+ * Pool_run counts as one of them, so nthreads - 1 new threads are
+ * started.
+ *
+ * Parameters:
+ *   nthreads - number of threads; must be >= 1
+ *
+ * Returns: A new Pool_T.
+ *
+ * CRE: nthreads < 1, or a thread cannot be created.
+ * CRE: memory allocation failure.
+ */
+extern T Pool_new(int nthreads);
+
+/*
+ * Pool_shared
+ *
+ * Returns a pool with one thread per online processor, created on
+ * first use and shared by every caller in the program. It must
+ * not be freed.
+ */
+extern T Pool_shared(void);
+
+/*
+ * Pool_free
+ *
+ * Stops the pool's threads and deallocates it, setting *pool to
+ * NULL.
+ *
+ * CRE: pool or *pool is NULL, or *pool is Pool_shared().
+ */
+extern void Pool_free(T *pool);
+
+/*
+ * Pool_size
+ *
+ * Returns the number of threads in the pool.
+ *
+ * CRE: pool is NULL.
+ */
+extern int Pool_size(T pool);
+
+/*
+ * Pool_run
+ *
+ * Calls task once for every index 0 .. ntasks - 1, spread over
+ * the pool's threads, and returns when every call has returned.
+ * Indices are handed out in increasing order but may finish in
+ * any order. Calls from different threads are run one at a time.
+ * A task must not call Pool_run on the same pool.
+ *
+ * Parameters:
+ *   pool   - the pool to run on
+ *   ntasks - number of tasks; may be 0
+ *   task   - function to call for each task
+ *   cl     - closure passed to each task call
+ *
+ * CRE: pool is NULL, task is NULL, or ntasks < 0.
+ */
+extern void Pool_run(T pool, int ntasks, Pool_taskfun *task, void *cl);
+
+/*
+ * Pool_run_static
+ *
+ * Like Pool_run, but the indices are split ahead of time instead
+ * of claimed: thread t runs indices ntasks * t / Pool_size up to
+ * ntasks * (t + 1) / Pool_size, in increasing order. Splitting
+ * the rows of an array into bands this way gives every thread the
+ * same contiguous rows on every call, whatever the number of
+ * bands, so a thread keeps working on the pages it first touched
+ * (on a NUMA machine, pages on its own node, as long as the
+ * scheduler keeps it there) and in its own cache. Threads that
+ * finish early do not help the others, so the tasks should cost
+ * about the same.
+ *
+ * CRE: pool is NULL, task is NULL, or ntasks < 0.
+ */
+extern void Pool_run_static(T pool, int ntasks, Pool_taskfun *task,
+                            void *cl);
+
+#undef T
+#endif
@@ -11,8 +11,9 @@
  *
  * Key Insight: A solved Sudoku has digits 1-9 appearing exactly
  *          once in every row, every column, and every 3x3 box.
- *          We validate each constraint with a boolean seen-array
- *          to detect duplicates.
+ *          One early-stopping pass over the board checks all
+ *          three constraints with boolean seen-tables, stopping
+ *          at the first duplicate or out-of-range digit.
  */
 
 #include <stdlib.h>
@@ -20,7 +21,7 @@
 #include <stdbool.h>
 #include "pnmrdr.h"
 #include "assert.h"
-#include "uarray2.h"
+#include "uarray2typed.h"
 
 #define DIM 9
 #define BOX 3
@@ -54,108 +55,53 @@ static void clean_close(UArray2_T board, Pnmrdr_T reader,
 }
 
 /*
- * name: validate_col
- *
- * description: Checks if a column in the sudoku board is valid.
- * A valid column must have all digits 1-9 appearing exactly once
- * with no repeats and no values outside the 1-9 range.
- *
- * Parameters:
- *   board - UArray2 containing the sudoku puzzle
- *   col   - column number to check (0-8)
- *
- * Returns:
- *   true if the column is valid, false if any digit repeats,
- *   is out of range, or missing from the column
- *
- * CRE: col < 0 or col >= DIM.
- * CRE: board is NULL or not fully initialized.
+ * Digits already seen in each row, column and 3x3 box, indexed
+ * by digit (1-9). Filled in as check_cell visits the board.
  */
-static bool validate_col(UArray2_T board, int col)
-{
-        bool seen[DIM + 1] = {false};
-        for (int row = 0; row < DIM; row++) {
-                int val = *(int *)UArray2_at(board, col, row);
-                if (val < 1 || val > DIM || seen[val]) {
-                        return false;
-                }
-                seen[val] = true;
-        }
-        return true;
-}
+typedef struct Seen {
+        bool row[DIM][DIM + 1];
+        bool col[DIM][DIM + 1];
+        bool box[DIM][DIM + 1];
+} Seen;
 
 /*
- * name: validate_row
+ * name: check_cell
  *
- * description: Checks if a row in the sudoku board is valid.
- * A valid row must have all digits 1-9 appearing exactly once
- * with no repeats and no values outside the 1-9 range.
+ * description: Stopping apply function that checks one cell of
+ * the sudoku board. The cell is bad if its digit is outside 1-9
+ * or has already appeared in the same row, column or 3x3 box.
+ * Since each row, column and box has exactly nine cells, a board
+ * with no bad cell has every digit 1-9 exactly once in each.
  *
  * Parameters:
+ *   col   - column of the cell (0-8)
+ *   row   - row of the cell (0-8)
  *   board - UArray2 containing the sudoku puzzle
- *   row   - row number to check (0-8)
+ *   elem  - pointer to the cell's digit
+ *   cl    - the Seen tables
  *
  * Returns:
- *   true if the row is valid, false if any digit repeats,
- *   is out of range, or missing from the row
+ *   UARRAY2_STOP at the first bad cell, UARRAY2_CONTINUE
+ *   otherwise
  *
- * CRE: row < 0 or row >= DIM.
- * CRE: board is NULL or not fully initialized.
+ * CRE: elem or cl is NULL.
  */
-static bool validate_row(UArray2_T board, int row)
+static int check_cell(int col, int row, UArray2_T board, void *elem,
+                      void *cl)
 {
-        bool seen[DIM + 1] = {false};
-        for (int col = 0; col < DIM; col++) {
-                int val = *(int *)UArray2_at(board, col, row);
-                if (val < 1 || val > DIM || seen[val]) {
-                        return false;
-                }
-                seen[val] = true;
+        Seen *seen = cl;
+        int val = *(int *)elem;
+        int box = (row / BOX) * BOX + col / BOX;
+        (void)board;
+
+        if (val < 1 || val > DIM || seen->row[row][val] ||
+            seen->col[col][val] || seen->box[box][val]) {
+                return UARRAY2_STOP;
         }
-        return true;
-}
-
-/*
- * name: validate_box
- *
- * description: Checks if a 3x3 box in the sudoku board is valid.
- * A valid box must have all digits 1-9 appearing exactly once with
- * no repeats and no values outside the 1-9 range. The box to check
- * is identified by its position in the 3x3 grid of boxes.
- *
- * Parameters:
- *   board    - UArray2 containing the sudoku puzzle
- *   box_row  - row position of the box (0-2)
- *   box_col  - column position of the box (0-2)
- *
- * Returns:
- *   true if the box is valid, false if any digit repeats,
- *   is out of range, or missing from the box
- *
- * CRE: box_row < 0 or box_row >= BOX (3).
- * CRE: box_col < 0 or box_col >= BOX (3).
- * CRE: board is NULL or not fully initialized.
- */
-static bool validate_box(UArray2_T board, int box_row,
-                          int box_col)
-{
-        bool seen[DIM + 1] = {false};
-        int start_row = box_row * BOX;
-        int start_col = box_col * BOX;
-
-        for (int r = 0; r < BOX; r++) {
-                for (int c = 0; c < BOX; c++) {
-                        int row = start_row + r;
-                        int col = start_col + c;
-                        int val = *(int *)UArray2_at(board,
-                                                     col, row);
-                        if (val < 1 || val > DIM || seen[val]) {
-                                return false;
-                        }
-                        seen[val] = true;
-                }
-        }
-        return true;
+        seen->row[row][val] = true;
+        seen->col[col][val] = true;
+        seen->box[box][val] = true;
+        return UARRAY2_CONTINUE;
 }
 
 /*
@@ -200,34 +146,23 @@ int main(int argc, char *argv[])
         assert(data.height == (unsigned)DIM);
         assert(data.denominator == (unsigned)DIM);
 
-        UArray2_T board = UArray2_new(DIM, DIM, sizeof(int));
+        UArray2_T board = UArray2_int_new(DIM, DIM);
 
         /* Read all pixels into the board */
         for (int row = 0; row < DIM; row++) {
                 for (int col = 0; col < DIM; col++) {
                         int pixel = Pnmrdr_get(reader);
-                        *(int *)UArray2_at(board, col, row) =
-                                pixel;
+                        UArray2_int_set(board, col, row, pixel);
                 }
         }
 
-        /* Validate all rows and columns */
-        for (int i = 0; i < DIM; i++) {
-                if (!validate_row(board, i) ||
-                    !validate_col(board, i)) {
-                        clean_close(board, reader, fp);
-                        return EXIT_FAILURE;
-                }
-        }
-
-        /* Validate all 3x3 boxes */
-        for (int br = 0; br < BOX; br++) {
-                for (int bc = 0; bc < BOX; bc++) {
-                        if (!validate_box(board, br, bc)) {
-                                clean_close(board, reader, fp);
-                                return EXIT_FAILURE;
-                        }
-                }
+        /* Check rows, columns and boxes; stop at the first bad cell */
+        Seen seen = {{{false}}, {{false}}, {{false}}};
+        UArray2_pos bad = UArray2_map_row_major_until(board, check_cell,
+                                                      &seen);
+        if (bad.row >= 0) {
+                clean_close(board, reader, fp);
+                return EXIT_FAILURE;
         }
         clean_close(board, reader, fp);
         return EXIT_SUCCESS;
@@ -0,0 +1,120 @@
+#!/bin/sh
+#
+# unblackedges.sh
+#
+# Authors: Toye Adebayo & Teny Makuach
+# Date: 10/18/2026
+#
+# Purpose: Runs unblackedges on the images in tests/ and compares
+#          each output with its answer file; "make check" runs it
+#          from the top directory. Each run is limited to TIMEOUT
+#          seconds, so a hang fails the test instead of stalling
+#          the build.
+#
+# Key Insight: answer_NAME.pbm is the output for NAME.pbm with no
+#          options, so every such pair is found by name; the
+#          answers for runs with options, and the --mask answers
+#          (answer_NAME_..._mask.pbm or .rle), are listed below,
+#          one expect line each.
+
+TIMEOUT=10
+status=0
+out=$(mktemp) || exit 1
+mask=$(mktemp) || exit 1
+
+# expect ANSWER ARGS...: runs unblackedges with ARGS and compares
+# its standard output with tests/ANSWER
+expect() {
+        answer=$1
+        shift
+        if ! timeout $TIMEOUT ./unblackedges "$@" > "$out" ||
+           ! cmp -s "$out" "tests/$answer"; then
+                echo "FAIL unblackedges $* (tests/$answer)"
+                status=1
+        fi
+}
+
+# expect_mask ANSWER ARGS...: runs unblackedges with ARGS and a
+# --mask option, and compares the mask it writes with tests/ANSWER
+expect_mask() {
+        answer=$1
+        shift
+        if ! timeout $TIMEOUT ./unblackedges --mask="$mask" "$@" \
+                > /dev/null || ! cmp -s "$mask" "tests/$answer"; then
+                echo "FAIL unblackedges --mask $* (tests/$answer)"
+                status=1
+        fi
+}
+
+# expect_batch SUFFIX OPTIONS NAME...: runs one --batch over every
+# tests/NAME.pbm with OPTIONS and compares each output written to
+# the batch directory with tests/answer_NAME$SUFFIX.pbm
+expect_batch() {
+        suffix=$1
+        options=$2
+        shift 2
+        dir=$(mktemp -d) || exit 1
+        inputs=""
+        for name in "$@"; do
+                inputs="$inputs tests/$name.pbm"
+        done
+        if ! timeout $TIMEOUT ./unblackedges --batch="$dir" $options \
+                $inputs; then
+                echo "FAIL unblackedges --batch $options"
+                status=1
+        fi
+        for name in "$@"; do
+                if ! cmp -s "$dir/$name.pbm" \
+                        "tests/answer_$name$suffix.pbm"; then
+                        echo "FAIL unblackedges --batch $options" \
+                             "(tests/answer_$name$suffix.pbm)"
+                        status=1
+                fi
+        done
+        rm -rf "$dir"
+}
+
+for i in 1 2 3; do
+        expect answer$i.pbm tests/test$i.pbm
+done
+for answer in tests/answer_*.pbm; do
+        name=${answer#tests/answer_}
+        if [ -f "tests/$name" ]; then
+                expect "answer_$name" "tests/$name"
+        fi
+done
+
+# --despeckle=K
+expect answer_specks_despeckle3.pbm --despeckle=3 tests/specks.pbm
+expect answer_interior_blob_despeckle5.pbm --despeckle=5 \
+       tests/interior_blob.pbm
+
+# --mask=PATH, both formats
+expect_mask answer_specks_mask.pbm tests/specks.pbm
+expect_mask answer_specks_mask.rle --mask-format=rle tests/specks.pbm
+expect_mask answer_specks_despeckle3_mask.rle --despeckle=3 \
+            --mask-format=rle tests/specks.pbm
+
+# --tile-budget=BYTES: the smallest (16-pixel) tiles, and tiles
+# of a few thousand pixels, must match the in-memory answers
+for name in tiles specks interior_blob; do
+        expect answer_$name.pbm --tile-budget=1 tests/$name.pbm
+        expect answer_$name.pbm --tile-budget=64k tests/$name.pbm
+done
+
+# --batch=OUTDIR: several pages in flight on more than one thread
+# per stage, with and without despeckling
+expect_batch "" --threads=2,3,2 all_black all_white island_center \
+             l_shape_edge single_pixel testinput1 specks tiles \
+             interior_blob
+expect_batch _despeckle3 "--despeckle=3 --threads=1,4,1" specks
+expect_batch _despeckle5 "--despeckle=5 --threads=3,2,2" \
+             interior_blob
+
+rm -f "$out" "$mask"
+if [ $status -eq 0 ]; then
+        echo "The images are OK!"
+else
+        echo "The images are NOT OK!"
+fi
+exit $status
@@ -0,0 +1,567 @@
+/*
+ * tiledges.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/17/2026
+ *
+ * Purpose: Implements the out-of-core unblackedges engine. The
+ *          image is streamed from the reader into a temporary
+ *          tile file, connectivity is settled tile by tile with a
+ *          union-find, affected tiles are rewritten, and the file
+ *          is streamed back out as a P1 image.
+ *
+ * Key Insight: The tile file is stored image-row by image-row,
+ *          with each row split into one fixed-width slice per tile
+ *          column. Splitting and printing are then sequential, and
+ *          a tile is just the same slice of th consecutive rows.
+ *          Labelling a tile in raster order is deterministic, so
+ *          the second pass can relabel a tile and recover exactly
+ *          the global ids handed out in the first pass.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "tiledges.h"
+#include "assert.h"
+#include "mem.h"
+
+#define MIN_SIDE 16       /* smallest tile side we will use */
+#define MAX_SIDE 16384    /* keeps side * side within an int */
+
+/*
+ * Union-find over the components that touch a tile edge. border[]
+ * is only meaningful at a root and says whether any member of the
+ * set touches the image border.
+ */
+typedef struct Forest {
+        int *parent;
+        unsigned char *border;
+        int length;
+        int capacity;
+} Forest;
+
+/*
+ * Working state for one run: the image geometry, the tile file,
+ * the one resident tile, and the bookkeeping that crosses tiles.
+ */
+typedef struct Tiler {
+        int width, height;     /* image dimensions in pixels */
+        int side;              /* tile side in pixels */
+        int rowbytes;          /* bytes in one row of one tile */
+        int ntx, nty;          /* tiles across and down */
+        FILE *fp;              /* the temporary tile file */
+
+        int tx, ty;            /* resident tile position */
+        int tw, th;            /* resident tile dimensions */
+        unsigned char *bits;   /* resident tile pixels, packed */
+        int *label;            /* component label per pixel, 0=none */
+        int *queue;            /* BFS queue of pixel indices */
+        int *kind;             /* per label: see label_tile */
+        int ncomponents;       /* labels in use are 1..ncomponents */
+
+        Forest forest;         /* edge components of all tiles */
+        int *first;            /* first global id of each tile */
+        int *bottom;           /* global id along last tile row */
+        int *right;            /* global id along last tile column */
+} Tiler;
+
+/*
+ * name: Forest_add
+ *
+ * description: Adds a new singleton set and returns its id.
+ *
+ * Parameters:
+ *   f      - the forest
+ *   border - 1 if the new component touches the image border
+ *
+ * Returns:
+ *   the id of the new set
+ *
+ * CRE: f is NULL.
+ */
+static int Forest_add(Forest *f, int border)
+{
+        if (f->length == f->capacity) {
+                f->capacity *= 2;
+                RESIZE(f->parent, f->capacity * (long)sizeof(int));
+                RESIZE(f->border, f->capacity);
+        }
+        f->parent[f->length] = f->length;
+        f->border[f->length] = (unsigned char)border;
+        return f->length++;
+}
+
+/*
+ * name: Forest_find
+ *
+ * description: Returns the root of the set holding id, halving
+ * the path on the way up.
+ *
+ * Parameters:
+ *   f  - the forest
+ *   id - a set member
+ *
+ * Returns:
+ *   the root id of the set
+ *
+ * CRE: f is NULL or id is not in the forest.
+ */
+static int Forest_find(Forest *f, int id)
+{
+        while (f->parent[id] != id) {
+                f->parent[id] = f->parent[f->parent[id]];
+                id = f->parent[id];
+        }
+        return id;
+}
+
+/*
+ * name: Forest_union
+ *
+ * description: Merges the sets holding a and b. The merged set
+ * touches the border if either one did.
+ *
+ * Parameters:
+ *   f - the forest
+ *   a - a member of the first set
+ *   b - a member of the second set
+ *
+ * Returns:
+ *   void
+ *
+ * CRE: f is NULL, or a or b is not in the forest.
+ */
+static void Forest_union(Forest *f, int a, int b)
+{
+        a = Forest_find(f, a);
+        b = Forest_find(f, b);
+        if (a != b) {
+                f->parent[b] = a;
+                f->border[a] |= f->border[b];
+        }
+}
+
+/*
+ * name: choose_side
+ *
+ * description: Picks the largest tile side whose working memory
+ * fits in budget. Per tile pixel we keep a label, a queue slot
+ * and (worst case) a label kind, plus one packed bit; per image
+ * column we keep a global id and a packed bit of the row buffer.
+ *
+ * Parameters:
+ *   width  - image width in pixels
+ *   height - image height in pixels
+ *   budget - working-memory budget in bytes
+ *
+ * Returns:
+ *   tile side in pixels
+ */
+static int choose_side(int width, int height, long budget)
+{
+        double per_pixel = 3 * sizeof(int) + 1.0 / 8;
+        double fixed     = width * (sizeof(int) + 1.0 / 8);
+        double room      = budget - fixed;
+        int side = room > 0 ? (int)sqrt(room / per_pixel) : 0;
+        int most = width > height ? width : height;
+
+        if (side > most) {
+                side = most;
+        }
+        if (side > MAX_SIDE) {
+                side = MAX_SIDE;
+        }
+        if (side < MIN_SIDE) {
+                side = MIN_SIDE;
+        }
+        return side;
+}
+
+/*
+ * name: row_offset
+ *
+ * description: Returns the file offset of tile row r of tile
+ * column tx, where r counts from the top of the image.
+ */
+static long row_offset(Tiler *t, int tx, int r)
+{
+        return ((long)r * t->ntx + tx) * t->rowbytes;
+}
+
+/*
+ * name: split_image
+ *
+ * description: Streams every pixel from reader into the tile
+ * file, one image row (all its tile slices) per write.
+ *
+ * Parameters:
+ *   t      - the tiler
+ *   reader - reader positioned at the first pixel
+ *
+ * Returns:
+ *   void
+ *
+ * CRE: the tile file cannot be written.
+ */
+static void split_image(Tiler *t, Pnmrdr_T reader)
+{
+        int bytes = t->ntx * t->rowbytes;
+        unsigned char *row_buf = ALLOC(bytes);
+
+        for (int row = 0; row < t->height; row++) {
+                memset(row_buf, 0, bytes);
+                for (int col = 0; col < t->width; col++) {
+                        if (Pnmrdr_get(reader) == 1) {
+                                int tx = col / t->side;
+                                int c  = col % t->side;
+                                row_buf[tx * t->rowbytes + c / 8] |=
+                                        0x80 >> (c % 8);
+                        }
+                }
+                size_t n = fwrite(row_buf, 1, bytes, t->fp);
+                assert(n == (size_t)bytes);
+        }
+
+        FREE(row_buf);
+}
+
+/*
+ * name: load_tile
+ *
+ * description: Reads tile (tx, ty) from the tile file and makes
+ * it the resident tile.
+ */
+static void load_tile(Tiler *t, int tx, int ty)
+{
+        t->tx = tx;
+        t->ty = ty;
+        t->tw = t->width - tx * t->side;
+        t->th = t->height - ty * t->side;
+        if (t->tw > t->side) {
+                t->tw = t->side;
+        }
+        if (t->th > t->side) {
+                t->th = t->side;
+        }
+
+        for (int r = 0; r < t->th; r++) {
+                fseek(t->fp, row_offset(t, tx, ty * t->side + r),
+                      SEEK_SET);
+                size_t n = fread(t->bits + r * t->rowbytes, 1,
+                                 t->rowbytes, t->fp);
+                assert(n == (size_t)t->rowbytes);
+        }
+}
+
+/*
+ * name: store_tile
+ *
+ * description: Writes the resident tile back to its place in the
+ * tile file.
+ */
+static void store_tile(Tiler *t)
+{
+        for (int r = 0; r < t->th; r++) {
+                fseek(t->fp, row_offset(t, t->tx, t->ty * t->side + r),
+                      SEEK_SET);
+                size_t n = fwrite(t->bits + r * t->rowbytes, 1,
+                                  t->rowbytes, t->fp);
+                assert(n == (size_t)t->rowbytes);
+        }
+}
+
+/*
+ * name: tile_bit
+ *
+ * description: Returns the pixel at (c, r) of the resident tile.
+ */
+static int tile_bit(Tiler *t, int c, int r)
+{
+        return (t->bits[r * t->rowbytes + c / 8] >> (7 - c % 8)) & 1;
+}
+
+/*
+ * name: label_tile
+ *
+ * description: Labels the 4-connected black components of the
+ * resident tile 1, 2, ... in raster order of their first pixel,
+ * and sets kind[label] to -1 if the component stays inside the
+ * tile, 0 if it touches a tile edge, or 1 if it also touches the
+ * image border.
+ *
+ * Parameters:
+ *   t - the tiler, with a tile resident
+ *
+ * Returns:
+ *   void
+ */
+static void label_tile(Tiler *t)
+{
+        int tw = t->tw;
+        int th = t->th;
+        int col0 = t->tx * t->side;
+        int row0 = t->ty * t->side;
+
+        memset(t->label, 0, tw * th * sizeof(int));
+        t->ncomponents = 0;
+
+        for (int start = 0; start < tw * th; start++) {
+                if (t->label[start] != 0 ||
+                    tile_bit(t, start % tw, start / tw) == 0) {
+                        continue;
+                }
+
+                int id = ++t->ncomponents;
+                int kind = -1;
+                int head = 0;
+                int tail = 0;
+
+                t->label[start] = id;
+                t->queue[tail++] = start;
+                while (head < tail) {
+                        int p = t->queue[head++];
+                        int c = p % tw;
+                        int r = p / tw;
+
+                        if (c == 0 || c == tw - 1 ||
+                            r == 0 || r == th - 1) {
+                                if (kind < 0) {
+                                        kind = 0;
+                                }
+                                if (col0 + c == 0 ||
+                                    col0 + c == t->width - 1 ||
+                                    row0 + r == 0 ||
+                                    row0 + r == t->height - 1) {
+                                        kind = 1;
+                                }
+                        }
+
+                        /* Left, right, up, down */
+                        int next[4] = { p - 1, p + 1, p - tw, p + tw };
+                        int ok[4]   = { c > 0, c < tw - 1,
+                                        r > 0, r < th - 1 };
+                        for (int i = 0; i < 4; i++) {
+                                int q = next[i];
+                                if (ok[i] && t->label[q] == 0 &&
+                                    tile_bit(t, q % tw, q / tw)) {
+                                        t->label[q] = id;
+                                        t->queue[tail++] = q;
+                                }
+                        }
+                }
+                t->kind[id] = kind;
+        }
+}
+
+/*
+ * name: settle_tile
+ *
+ * description: First pass over one tile. Gives each edge
+ * component of the resident tile a global id, joins those ids
+ * with the neighbouring tiles to the left and above, and records
+ * this tile's own right and bottom edges for the tiles after it.
+ *
+ * Parameters:
+ *   t - the tiler, with a freshly labelled tile resident
+ *
+ * Returns:
+ *   void
+ */
+static void settle_tile(Tiler *t)
+{
+        int tw = t->tw;
+        int th = t->th;
+        int *gid = t->kind;   /* kind[] is rewritten as global ids */
+        int *bottom = t->bottom + t->tx * t->side;
+
+        t->first[t->ty * t->ntx + t->tx] = t->forest.length;
+        for (int id = 1; id <= t->ncomponents; id++) {
+                gid[id] = gid[id] < 0 ? -1
+                                      : Forest_add(&t->forest, gid[id]);
+        }
+
+        /* Join with the tile to the left and the tile above */
+        for (int r = 0; t->tx > 0 && r < th; r++) {
+                int id = t->label[r * tw];
+                if (id != 0 && t->right[r] >= 0) {
+                        Forest_union(&t->forest, gid[id], t->right[r]);
+                }
+        }
+        for (int c = 0; t->ty > 0 && c < tw; c++) {
+                int id = t->label[c];
+                if (id != 0 && bottom[c] >= 0) {
+                        Forest_union(&t->forest, gid[id], bottom[c]);
+                }
+        }
+
+        /* Remember the far edges for the next tiles */
+        for (int r = 0; r < th; r++) {
+                int id = t->label[r * tw + tw - 1];
+                t->right[r] = id != 0 ? gid[id] : -1;
+        }
+        for (int c = 0; c < tw; c++) {
+                int id = t->label[(th - 1) * tw + c];
+                bottom[c] = id != 0 ? gid[id] : -1;
+        }
+}
+
+/*
+ * name: tile_affected
+ *
+ * description: Returns 1 if any edge component of tile index i
+ * was found to reach the image border, so the tile must be
+ * rewritten; 0 otherwise.
+ */
+static int tile_affected(Tiler *t, int i)
+{
+        for (int g = t->first[i]; g < t->first[i + 1]; g++) {
+                if (t->forest.border[Forest_find(&t->forest, g)]) {
+                        return 1;
+                }
+        }
+        return 0;
+}
+
+/*
+ * name: clear_tile
+ *
+ * description: Second pass over one affected tile. Relabels it,
+ * which reproduces the first pass's order of edge components,
+ * and turns white every pixel whose component reaches the image
+ * border.
+ *
+ * Parameters:
+ *   t - the tiler, with the affected tile resident
+ *
+ * Returns:
+ *   void
+ */
+static void clear_tile(Tiler *t)
+{
+        int tw = t->tw;
+        int g = t->first[t->ty * t->ntx + t->tx];
+
+        label_tile(t);
+        for (int id = 1; id <= t->ncomponents; id++) {
+                if (t->kind[id] >= 0) {
+                        int root = Forest_find(&t->forest, g++);
+                        t->kind[id] = t->forest.border[root];
+                } else {
+                        t->kind[id] = 0;
+                }
+        }
+
+        for (int p = 0; p < tw * t->th; p++) {
+                if (t->label[p] != 0 && t->kind[t->label[p]]) {
+                        int c = p % tw;
+                        t->bits[(p / tw) * t->rowbytes + c / 8] &=
+                                ~(0x80 >> (c % 8));
+                }
+        }
+}
+
+/*
+ * name: print_tiles
+ *
+ * description: Streams the tile file out as a plain PBM image in
+ * the same layout print_pbm in unblackedges.c uses.
+ */
+static void print_tiles(Tiler *t, FILE *out)
+{
+        int bytes = t->ntx * t->rowbytes;
+        unsigned char *row_buf = ALLOC(bytes);
+
+        fprintf(out, "P1\n%d %d\n", t->width, t->height);
+        fseek(t->fp, 0, SEEK_SET);
+        for (int row = 0; row < t->height; row++) {
+                size_t n = fread(row_buf, 1, bytes, t->fp);
+                assert(n == (size_t)bytes);
+                for (int col = 0; col < t->width; col++) {
+                        int tx = col / t->side;
+                        int c  = col % t->side;
+                        int bit = (row_buf[tx * t->rowbytes + c / 8] >>
+                                   (7 - c % 8)) & 1;
+                        if (col > 0) {
+                                putc(' ', out);
+                        }
+                        putc('0' + bit, out);
+                }
+                putc('\n', out);
+        }
+
+        FREE(row_buf);
+}
+
+/*
+ * Tiledges_remove - see tiledges.h for contract
+ */
+void Tiledges_remove(Pnmrdr_T reader, FILE *out, long budget)
+{
+        assert(reader != NULL && out != NULL);
+
+        Pnmrdr_mapdata data = Pnmrdr_data(reader);
+        assert(data.type == Pnmrdr_bit);
+        assert(data.width > 0 && data.height > 0);
+
+        Tiler t;
+        t.width    = (int)data.width;
+        t.height   = (int)data.height;
+        t.side     = choose_side(t.width, t.height, budget);
+        t.rowbytes = (t.side + 7) / 8;
+        t.ntx      = (t.width + t.side - 1) / t.side;
+        t.nty      = (t.height + t.side - 1) / t.side;
+        t.fp       = tmpfile();
+        assert(t.fp != NULL);
+
+        long area  = (long)t.side * t.side;
+        int ntiles = t.ntx * t.nty;
+        t.bits   = ALLOC(area / 8 + t.side);
+        t.label  = ALLOC(area * (long)sizeof(int));
+        t.queue  = ALLOC(area * (long)sizeof(int));
+        t.kind   = ALLOC((area + 1) * (long)sizeof(int));
+        t.first  = ALLOC((ntiles + 1) * (long)sizeof(int));
+        t.bottom = ALLOC(t.width * (long)sizeof(int));
+        t.right  = ALLOC(t.side * (long)sizeof(int));
+        t.forest.capacity = 1024;
+        t.forest.length   = 0;
+        t.forest.parent   = ALLOC(t.forest.capacity *
+                                  (long)sizeof(int));
+        t.forest.border   = ALLOC(t.forest.capacity);
+
+        split_image(&t, reader);
+
+        /* First pass: settle connectivity across tiles */
+        for (int ty = 0; ty < t.nty; ty++) {
+                for (int tx = 0; tx < t.ntx; tx++) {
+                        load_tile(&t, tx, ty);
+                        label_tile(&t);
+                        settle_tile(&t);
+                }
+        }
+        t.first[ntiles] = t.forest.length;
+
+        /* Second pass: rewrite only tiles that lose pixels */
+        for (int ty = 0; ty < t.nty; ty++) {
+                for (int tx = 0; tx < t.ntx; tx++) {
+                        if (tile_affected(&t, ty * t.ntx + tx)) {
+                                load_tile(&t, tx, ty);
+                                clear_tile(&t);
+                                store_tile(&t);
+                        }
+                }
+        }
+
+        print_tiles(&t, out);
+
+        fclose(t.fp);
+        FREE(t.bits);
+        FREE(t.label);
+        FREE(t.queue);
+        FREE(t.kind);
+        FREE(t.first);
+        FREE(t.bottom);
+        FREE(t.right);
+        FREE(t.forest.parent);
+        FREE(t.forest.border);
+}
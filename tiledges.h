@@ -0,0 +1,47 @@
+/*
+ * tiledges.h
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/17/2026
+ *
+ * Purpose: Defines an out-of-core version of the unblackedges
+ *          engine for bitmaps too large to hold in one Bit2. The
+ *          image is split into square tiles stored in a temporary
+ *          file, and only one tile is resident at a time.
+ *
+ * Key Insight: Each tile is flood-filled locally. Only components
+ *          that touch a tile edge can reach the image border, so
+ *          only those get a global id in a small union-find that
+ *          joins them across tile boundaries. Once connectivity is
+ *          settled, only the tiles holding a border-connected
+ *          component are loaded again and rewritten.
+ */
+
+#ifndef TILEDGES_INCLUDED
+#define TILEDGES_INCLUDED
+
+#include <stdio.h>
+#include "pnmrdr.h"
+
+/*
+ * Tiledges_remove
+ *
+ * Reads a bitmap from reader, removes every black pixel that is
+ * 4-connected to the image border, and writes the result to out
+ * as a plain PBM (P1) image, exactly as unblackedges does. Tiles
+ * are sized so that the per-tile working memory stays within
+ * budget bytes. The union-find grows with the number of
+ * components that cross tile edges and is not counted in budget.
+ *
+ * Parameters:
+ *   reader - reader positioned at the first pixel of a PBM image
+ *   out    - stream the cleaned P1 image is written to
+ *   budget - working-memory budget in bytes
+ *
+ * CRE: reader or out is NULL.
+ * CRE: the image is not a bitmap or has a zero dimension.
+ * CRE: the temporary tile file cannot be created or written.
+ */
+extern void Tiledges_remove(Pnmrdr_T reader, FILE *out, long budget);
+
+#endif
@@ -10,30 +10,112 @@
  *          size, access an element by (col, row), and traverse
  *          all elements in row-major or column-major order.
  *
- * Key Insight: The 2D array is stored as one flat 1D UArray.
- *          Each (col, row) maps to index = row * width + col.
- *          The map functions change only traversal order, not
- *          how elements are stored.
+ * Key Insight: The 2D array is stored as one flat block of
+ *          rows. Each (col, row) lives at elems + row * stride +
+ *          col * size. The block is either a Hanson UArray owned
+ *          by the array, a memory-mapped file (UArray2_map_file,
+ *          UArray2_load), or pages mapped from the kernel
+ *          (UArray2_new_flags). A view is just another header
+ *          whose elems and stride point into its parent's block,
+ *          and a padded array points elems inside a larger block
+ *          whose margin holds its ghost cells. A sparse array
+ *          instead splits its elements, in row-major order, into
+ *          fixed-size chunks that are only allocated when first
+ *          written, and a Morton array stores its elements in
+ *          Z-order so that neighbours in both axes sit close in
+ *          memory. The map functions change only traversal order,
+ *          not how elements are stored.
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdlib.h>
-#include "uarray2.h"
-#include "uarray.h"
+#include <stdint.h>
+#include <limits.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if defined(__GNUC__) && defined(__x86_64__)
+#define GATHER_AVX2 1             /* built with target("avx2") */
+#endif
+#if defined(__BMI2__) || defined(GATHER_AVX2)
+#include <immintrin.h>
+#endif
+#include "uarray2rep.h"
+#include "pool.h"
+#include "pages.h"
 #include "assert.h"
 #include "mem.h"
 
+#define MAP_MAGIC   0x4d324155u   /* "UA2M" read little-endian */
+#define MAP_VERSION 1u
+#define MAP_HEADER  64            /* header bytes before elements */
+#define SNAP_MAGIC  0x53324155u   /* "UA2S" read little-endian */
+#define SNAP_VERSION 1u
+#define SNAP_HEADER 4096          /* one page; the payload follows */
+#define SNAP_ROWS   0             /* payload layout: packed rows */
+#define CHUNK_BYTES 4096          /* target size of a sparse chunk */
+#define TRANSPOSE_BASE 4096       /* bytes in a leaf transpose block */
+#define TRANSPOSE_SWAP 64         /* bytes swapped per step in place */
+#define PARALLEL_CELLS 65536      /* fewer cells: no thread pool */
+#define STRIP_COLS  512           /* columns per column-pass task */
+#define BANDS_PER_THREAD 4        /* row bands per pool thread */
+#define CACHE_LINE  64            /* bytes; keeps accumulators apart */
+#define SORT_COORDS 4096          /* fewer coordinates: no row sort */
+#define SORT_BYTES  (1L << 20)    /* smaller arrays: no row sort */
+#define PREFETCH_AHEAD 16         /* coordinates prefetched ahead */
+#define PREFETCH_ROWS_SMALL 8     /* column walks, 1-2 byte elements */
+#define PREFETCH_ROWS 16          /* column walks, larger elements */
+
+#if defined(__GNUC__)
+#define PREFETCH(addr, write) __builtin_prefetch((addr), (write))
+#else
+#define PREFETCH(addr, write) ((void)0)
+#endif
+
 #define T UArray2_T
-struct T {
-        int width;
-        int height;
-        int size;
-        UArray_T data;
-};
 
 /*
- * UArray2_new - see uarray2.h for contract
+ * On-disk header of a file used by UArray2_map_file. The elements
+ * follow at offset MAP_HEADER, row-major with no padding.
  */
-T UArray2_new(int width, int height, int size)
+typedef struct Map_header {
+        uint32_t magic;
+        uint32_t version;
+        int32_t width;
+        int32_t height;
+        int32_t size;
+} Map_header;
+
+/*
+ * Header of a file written by UArray2_save. The payload follows at
+ * offset SNAP_HEADER, so it starts on a page boundary of the
+ * mapping, as packed rows of width * size bytes.
+ */
+typedef struct Snap_header {
+        uint32_t magic;
+        uint32_t version;
+        int32_t width;
+        int32_t height;
+        int32_t size;
+        int32_t layout;       /* SNAP_ROWS */
+        uint64_t payload;     /* bytes after the header */
+        uint64_t checksum;    /* checksum of the payload */
+        uint64_t header_sum;  /* checksum of the fields above */
+} Snap_header;
+
+/*
+ * name: new_header
+ *
+ * description: Allocates a UArray2 header for a flat
+ * width-by-height array of size-byte elements, with no storage
+ * attached yet. Each constructor fills in the storage.
+ *
+ * CRE: width <= 0, height <= 0, or size <= 0.
+ */
+static T new_header(int width, int height, int size)
 {
         assert(width > 0);
         assert(height > 0);
@@ -41,14 +123,553 @@ T UArray2_new(int width, int height, int size)
 
         T uarray2;
         NEW(uarray2);
-        uarray2->width  = width;
-        uarray2->height = height;
-        uarray2->size   = size;
-        uarray2->data   = UArray_new(width * height, size);
+        uarray2->width       = width;
+        uarray2->height      = height;
+        uarray2->size        = size;
+        uarray2->stride      = (long)width * size;
+        uarray2->elems       = NULL;
+        uarray2->data        = NULL;
+        uarray2->map         = NULL;
+        uarray2->map_length  = 0;
+        uarray2->map_flags   = 0;
+        uarray2->layout      = UARRAY2_FLAT;
+        uarray2->chunks      = NULL;
+        uarray2->nchunks     = 0;
+        uarray2->chunk_elems = 0;
+        uarray2->zero        = NULL;
+        uarray2->parent      = NULL;
+        uarray2->morton_bits = 0;
+        uarray2->morton_length = 0;
+        uarray2->ghost       = 0;
+        return uarray2;
+}
+
+/*
+ * UArray2_new - see uarray2.h for contract
+ */
+T UArray2_new(int width, int height, int size)
+{
+        T uarray2 = new_header(width, height, size);
+        uarray2->data  = UArray_new(width * height, size);
+        uarray2->elems = UArray_at(uarray2->data, 0);
+
+        return uarray2;
+}
+
+/*
+ * UArray2_new_sparse - see uarray2.h for contract
+ */
+T UArray2_new_sparse(int width, int height, int size)
+{
+        T uarray2 = new_header(width, height, size);
+        long length = (long)width * height;
+        int per_chunk = size < CHUNK_BYTES ? CHUNK_BYTES / size : 1;
+
+        uarray2->layout      = UARRAY2_SPARSE;
+        uarray2->chunk_elems = per_chunk;
+        uarray2->nchunks     = (int)((length + per_chunk - 1) /
+                                     per_chunk);
+        uarray2->chunks      = CALLOC(uarray2->nchunks,
+                                      (long)sizeof(char *));
+        uarray2->zero        = CALLOC(1, size);
+
+        return uarray2;
+}
+
+#if !defined(__BMI2__)
+/*
+ * Spreads the 8 bits of a byte to the even bit positions of a
+ * 16-bit word: bit i moves to bit 2i. Used to interleave Morton
+ * coordinates where the pdep instruction is not available.
+ */
+static const uint16_t spread_byte[256] = {
+        0x0000, 0x0001, 0x0004, 0x0005, 0x0010, 0x0011, 0x0014, 0x0015,
+        0x0040, 0x0041, 0x0044, 0x0045, 0x0050, 0x0051, 0x0054, 0x0055,
+        0x0100, 0x0101, 0x0104, 0x0105, 0x0110, 0x0111, 0x0114, 0x0115,
+        0x0140, 0x0141, 0x0144, 0x0145, 0x0150, 0x0151, 0x0154, 0x0155,
+        0x0400, 0x0401, 0x0404, 0x0405, 0x0410, 0x0411, 0x0414, 0x0415,
+        0x0440, 0x0441, 0x0444, 0x0445, 0x0450, 0x0451, 0x0454, 0x0455,
+        0x0500, 0x0501, 0x0504, 0x0505, 0x0510, 0x0511, 0x0514, 0x0515,
+        0x0540, 0x0541, 0x0544, 0x0545, 0x0550, 0x0551, 0x0554, 0x0555,
+        0x1000, 0x1001, 0x1004, 0x1005, 0x1010, 0x1011, 0x1014, 0x1015,
+        0x1040, 0x1041, 0x1044, 0x1045, 0x1050, 0x1051, 0x1054, 0x1055,
+        0x1100, 0x1101, 0x1104, 0x1105, 0x1110, 0x1111, 0x1114, 0x1115,
+        0x1140, 0x1141, 0x1144, 0x1145, 0x1150, 0x1151, 0x1154, 0x1155,
+        0x1400, 0x1401, 0x1404, 0x1405, 0x1410, 0x1411, 0x1414, 0x1415,
+        0x1440, 0x1441, 0x1444, 0x1445, 0x1450, 0x1451, 0x1454, 0x1455,
+        0x1500, 0x1501, 0x1504, 0x1505, 0x1510, 0x1511, 0x1514, 0x1515,
+        0x1540, 0x1541, 0x1544, 0x1545, 0x1550, 0x1551, 0x1554, 0x1555,
+        0x4000, 0x4001, 0x4004, 0x4005, 0x4010, 0x4011, 0x4014, 0x4015,
+        0x4040, 0x4041, 0x4044, 0x4045, 0x4050, 0x4051, 0x4054, 0x4055,
+        0x4100, 0x4101, 0x4104, 0x4105, 0x4110, 0x4111, 0x4114, 0x4115,
+        0x4140, 0x4141, 0x4144, 0x4145, 0x4150, 0x4151, 0x4154, 0x4155,
+        0x4400, 0x4401, 0x4404, 0x4405, 0x4410, 0x4411, 0x4414, 0x4415,
+        0x4440, 0x4441, 0x4444, 0x4445, 0x4450, 0x4451, 0x4454, 0x4455,
+        0x4500, 0x4501, 0x4504, 0x4505, 0x4510, 0x4511, 0x4514, 0x4515,
+        0x4540, 0x4541, 0x4544, 0x4545, 0x4550, 0x4551, 0x4554, 0x4555,
+        0x5000, 0x5001, 0x5004, 0x5005, 0x5010, 0x5011, 0x5014, 0x5015,
+        0x5040, 0x5041, 0x5044, 0x5045, 0x5050, 0x5051, 0x5054, 0x5055,
+        0x5100, 0x5101, 0x5104, 0x5105, 0x5110, 0x5111, 0x5114, 0x5115,
+        0x5140, 0x5141, 0x5144, 0x5145, 0x5150, 0x5151, 0x5154, 0x5155,
+        0x5400, 0x5401, 0x5404, 0x5405, 0x5410, 0x5411, 0x5414, 0x5415,
+        0x5440, 0x5441, 0x5444, 0x5445, 0x5450, 0x5451, 0x5454, 0x5455,
+        0x5500, 0x5501, 0x5504, 0x5505, 0x5510, 0x5511, 0x5514, 0x5515,
+        0x5540, 0x5541, 0x5544, 0x5545, 0x5550, 0x5551, 0x5554, 0x5555
+};
+#endif
+
+/*
+ * name: spread_bits
+ *
+ * description: Moves bit i of x to bit 2i of the result, leaving
+ * the odd bits clear.
+ */
+static inline uint64_t spread_bits(uint32_t x)
+{
+#if defined(__BMI2__)
+        return _pdep_u64(x, 0x5555555555555555ull);
+#else
+        return (uint64_t)spread_byte[x & 0xff] |
+               (uint64_t)spread_byte[(x >> 8) & 0xff] << 16 |
+               (uint64_t)spread_byte[(x >> 16) & 0xff] << 32 |
+               (uint64_t)spread_byte[x >> 24] << 48;
+#endif
+}
+
+/*
+ * name: morton_index
+ *
+ * description: Returns the storage index of (col, row) in a
+ * Morton array. The low morton_bits bits of col and row are
+ * interleaved, col in the even bits; the remaining high bits of
+ * the longer side (the shorter side has none) sit above them,
+ * so a non-square array is a row of square Z-order blocks.
+ */
+static inline long morton_index(T uarray2, int col, int row)
+{
+        int bits = uarray2->morton_bits;
+        uint32_t low = ((uint32_t)1 << bits) - 1;
+        uint64_t z = spread_bits((uint32_t)col & low) |
+                     spread_bits((uint32_t)row & low) << 1;
+
+        z |= (uint64_t)((col >> bits) | (row >> bits)) << (2 * bits);
+        return (long)z;
+}
+
+/*
+ * name: ceil_log2
+ *
+ * description: Returns the smallest b with 2^b >= n, for n > 0.
+ */
+static int ceil_log2(int n)
+{
+        int b = 0;
+        while (((long)1 << b) < n) {
+                b++;
+        }
+        return b;
+}
+
+/*
+ * UArray2_new_morton - see uarray2.h for contract
+ */
+T UArray2_new_morton(int width, int height, int size)
+{
+        T uarray2 = new_header(width, height, size);
+        int col_bits = ceil_log2(width);
+        int row_bits = ceil_log2(height);
+        long length  = (long)1 << (col_bits + row_bits);
+
+        assert(length <= INT_MAX);
+        uarray2->layout        = UARRAY2_MORTON;
+        uarray2->morton_bits   = col_bits < row_bits ? col_bits
+                                                     : row_bits;
+        uarray2->morton_length = length;
+        uarray2->data          = UArray_new((int)length, size);
+        uarray2->elems         = UArray_at(uarray2->data, 0);
+
+        return uarray2;
+}
+
+/*
+ * UArray2_new_padded - see uarray2.h for contract
+ */
+T UArray2_new_padded(int width, int height, int size, int ghost)
+{
+        assert(ghost >= 0);
+
+        T uarray2 = new_header(width, height, size);
+        int outer_width  = width + 2 * ghost;
+        int outer_height = height + 2 * ghost;
+
+        uarray2->ghost  = ghost;
+        uarray2->stride = (long)outer_width * size;
+        uarray2->data   = UArray_new(outer_width * outer_height, size);
+        uarray2->elems  = (char *)UArray_at(uarray2->data, 0) +
+                          ghost * uarray2->stride +
+                          (long)ghost * size;
+
+        return uarray2;
+}
+
+/*
+ * UArray2_view - see uarray2.h for contract
+ */
+T UArray2_view(T parent, int col0, int row0, int width, int height)
+{
+        assert(parent != NULL);
+        assert(parent->layout == UARRAY2_FLAT);
+        assert(width > 0 && height > 0);
+        assert(col0 >= 0 && col0 + width <= parent->width);
+        assert(row0 >= 0 && row0 + height <= parent->height);
+
+        T view = new_header(width, height, parent->size);
+        view->stride = parent->stride;
+        view->elems  = parent->elems + row0 * parent->stride +
+                       (long)col0 * parent->size;
+        view->parent = parent;
+
+        return view;
+}
+
+/*
+ * name: sparse_at
+ *
+ * description: Returns the address of element (col, row) of a
+ * sparse array. If its chunk has never been written, a read
+ * returns the shared zero element, while a write first allocates
+ * the chunk, zero-filled.
+ *
+ * Parameters:
+ *   uarray2 - a sparse array
+ *   col     - column index, in bounds
+ *   row     - row index, in bounds
+ *   write   - 1 if the caller may store through the pointer
+ *
+ * Returns:
+ *   address of the element, or of the zero element
+ */
+static char *sparse_at(T uarray2, int col, int row, int write)
+{
+        long index = (long)row * uarray2->width + col;
+        int chunk  = (int)(index / uarray2->chunk_elems);
+        long start = (long)chunk * uarray2->chunk_elems;
+
+        if (uarray2->chunks[chunk] == NULL) {
+                if (!write) {
+                        return uarray2->zero;
+                }
+                uarray2->chunks[chunk] = CALLOC(uarray2->chunk_elems,
+                                                uarray2->size);
+        }
+        return uarray2->chunks[chunk] + (index - start) * uarray2->size;
+}
+
+/*
+ * UArray2_map_file - see uarray2.h for contract
+ */
+T UArray2_map_file(const char *path, int width, int height, int size,
+                   int flags)
+{
+        assert(path != NULL);
+        assert(width >= 0 && height >= 0 && size >= 0);
+        int mode = flags & (UARRAY2_MAP_RDONLY | UARRAY2_MAP_RDWR |
+                            UARRAY2_MAP_PRIVATE);
+        assert(mode == UARRAY2_MAP_RDONLY || mode == UARRAY2_MAP_RDWR ||
+               mode == UARRAY2_MAP_PRIVATE);
+        assert((flags & ~(mode | UARRAY2_MAP_CREATE)) == 0);
+        assert(!((flags & UARRAY2_MAP_CREATE) &&
+                 mode == UARRAY2_MAP_RDONLY));
+
+        int open_flags = mode == UARRAY2_MAP_RDWR ? O_RDWR : O_RDONLY;
+        if (flags & UARRAY2_MAP_CREATE) {
+                open_flags = O_RDWR | O_CREAT;
+        }
+        int fd = open(path, open_flags, 0666);
+        assert(fd >= 0);
+
+        struct stat st;
+        int rc = fstat(fd, &st);
+        assert(rc == 0);
+
+        Map_header header;
+        if (st.st_size == 0 && (flags & UARRAY2_MAP_CREATE)) {
+                /* New file: write the header, zero-fill the rest */
+                assert(width > 0 && height > 0 && size > 0);
+                memset(&header, 0, sizeof(header));
+                header.magic   = MAP_MAGIC;
+                header.version = MAP_VERSION;
+                header.width   = width;
+                header.height  = height;
+                header.size    = size;
+                off_t length = MAP_HEADER +
+                               (off_t)width * height * size;
+                rc = ftruncate(fd, length);
+                assert(rc == 0);
+                ssize_t n = pwrite(fd, &header, sizeof(header), 0);
+                assert(n == (ssize_t)sizeof(header));
+                st.st_size = length;
+        } else {
+                ssize_t n = pread(fd, &header, sizeof(header), 0);
+                assert(n == (ssize_t)sizeof(header));
+                assert(header.magic == MAP_MAGIC);
+                assert(header.version == MAP_VERSION);
+                assert(width == 0 || width == header.width);
+                assert(height == 0 || height == header.height);
+                assert(size == 0 || size == header.size);
+                assert(st.st_size == MAP_HEADER + (off_t)header.width *
+                                     header.height * header.size);
+        }
+
+        int prot  = mode == UARRAY2_MAP_RDONLY ? PROT_READ
+                                               : PROT_READ | PROT_WRITE;
+        int share = mode == UARRAY2_MAP_PRIVATE ? MAP_PRIVATE
+                                                : MAP_SHARED;
+        void *map = mmap(NULL, st.st_size, prot, share, fd, 0);
+        assert(map != MAP_FAILED);
+        close(fd);            /* the mapping keeps the file open */
+
+        T uarray2 = new_header(header.width, header.height,
+                               header.size);
+        uarray2->elems      = (char *)map + MAP_HEADER;
+        uarray2->map        = map;
+        uarray2->map_length = st.st_size;
+        uarray2->map_flags  = flags;
+
+        return uarray2;
+}
+
+/*
+ * name: checksum
+ *
+ * description: Folds n bytes into a running 64-bit checksum, a
+ * word at a time (an FNV-1a variant over 8-byte words), so that
+ * checking a large payload runs at memory speed.
+ *
+ * Parameters:
+ *   sum - checksum so far; SNAP_MAGIC to start
+ *   buf - bytes to fold in
+ *   n   - number of bytes
+ *
+ * Returns:
+ *   the updated checksum
+ */
+static uint64_t checksum(uint64_t sum, const void *buf, size_t n)
+{
+        const unsigned char *bytes = buf;
+        size_t i = 0;
+
+        for (; i + 8 <= n; i += 8) {
+                uint64_t word;
+                memcpy(&word, bytes + i, 8);
+                sum = (sum ^ word) * 0x100000001b3ull;
+                sum ^= sum >> 29;
+        }
+        for (; i < n; i++) {
+                sum = (sum ^ bytes[i]) * 0x100000001b3ull;
+        }
+        return sum;
+}
+
+/*
+ * name: checksum_rows
+ *
+ * description: Folds height packed rows of row_bytes bytes each
+ * into a running checksum, one row per call to checksum. Saving
+ * and loading both fold the payload this way, so the sum does not
+ * depend on whether the rows were contiguous in memory.
+ *
+ * Parameters:
+ *   sum       - checksum so far
+ *   rows      - first byte of the packed rows
+ *   row_bytes - bytes in each row
+ *   height    - number of rows
+ *
+ * Returns:
+ *   the updated checksum
+ */
+static uint64_t checksum_rows(uint64_t sum, const char *rows,
+                              long row_bytes, int height)
+{
+        for (int row = 0; row < height; row++) {
+                sum = checksum(sum, rows + row * row_bytes, row_bytes);
+        }
+        return sum;
+}
+
+/*
+ * name: write_all
+ *
+ * description: Writes n bytes at offset in fd, retrying short
+ * writes.
+ *
+ * CRE: a write fails.
+ */
+static void write_all(int fd, const void *buf, size_t n, off_t offset)
+{
+        const char *bytes = buf;
+        while (n > 0) {
+                ssize_t done = pwrite(fd, bytes, n, offset);
+                assert(done > 0);
+                bytes  += done;
+                n      -= done;
+                offset += done;
+        }
+}
+
+/*
+ * UArray2_save - see uarray2.h for contract
+ */
+void UArray2_save(T uarray2, const char *path)
+{
+        assert(uarray2 != NULL);
+        assert(path != NULL);
+
+        int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        assert(fd >= 0);
+
+        long row_bytes = (long)uarray2->width * uarray2->size;
+        uint64_t sum   = SNAP_MAGIC;
+        off_t offset   = SNAP_HEADER;
+
+        if (uarray2->layout == UARRAY2_FLAT &&
+            uarray2->stride == row_bytes) {
+                /* Packed rows: one write for the whole payload */
+                size_t n = (size_t)row_bytes * uarray2->height;
+                sum = checksum_rows(sum, uarray2->elems, row_bytes,
+                                    uarray2->height);
+                write_all(fd, uarray2->elems, n, offset);
+        } else {
+                char *line = ALLOC(row_bytes);
+                for (int row = 0; row < uarray2->height; row++) {
+                        for (int col = 0; col < uarray2->width; col++) {
+                                memcpy(line + (long)col * uarray2->size,
+                                       UArray2_get(uarray2, col, row),
+                                       uarray2->size);
+                        }
+                        sum = checksum(sum, line, row_bytes);
+                        write_all(fd, line, row_bytes, offset);
+                        offset += row_bytes;
+                }
+                FREE(line);
+        }
+
+        /* The header goes last, once the checksum is known */
+        Snap_header header;
+        memset(&header, 0, sizeof(header));
+        header.magic      = SNAP_MAGIC;
+        header.version    = SNAP_VERSION;
+        header.width      = uarray2->width;
+        header.height     = uarray2->height;
+        header.size       = uarray2->size;
+        header.layout     = SNAP_ROWS;
+        header.payload    = (uint64_t)row_bytes * uarray2->height;
+        header.checksum   = sum;
+        header.header_sum = checksum(SNAP_MAGIC, &header,
+                                     offsetof(Snap_header,
+                                              header_sum));
+        write_all(fd, &header, sizeof(header), 0);
+        /* Pad the header page so the file holds the whole layout */
+        int rc = ftruncate(fd, SNAP_HEADER + (off_t)header.payload);
+        assert(rc == 0);
+        rc = close(fd);
+        assert(rc == 0);
+}
+
+/*
+ * UArray2_load - see uarray2.h for contract
+ */
+T UArray2_load(const char *path, int flags)
+{
+        assert(path != NULL);
+        int mode = flags & (UARRAY2_MAP_RDONLY | UARRAY2_MAP_PRIVATE);
+        assert(mode == UARRAY2_MAP_RDONLY ||
+               mode == UARRAY2_MAP_PRIVATE);
+        assert((flags & ~(mode | UARRAY2_LOAD_VERIFY)) == 0);
+
+        int fd = open(path, O_RDONLY);
+        assert(fd >= 0);
 
+        struct stat st;
+        int rc = fstat(fd, &st);
+        assert(rc == 0);
+
+        Snap_header header;
+        ssize_t n = pread(fd, &header, sizeof(header), 0);
+        assert(n == (ssize_t)sizeof(header));
+        assert(header.magic == SNAP_MAGIC);
+        assert(header.version == SNAP_VERSION);
+        assert(header.header_sum ==
+               checksum(SNAP_MAGIC, &header,
+                        offsetof(Snap_header, header_sum)));
+        assert(header.layout == SNAP_ROWS);
+        assert(header.width > 0 && header.height > 0 &&
+               header.size > 0);
+        assert(header.payload == (uint64_t)header.width *
+                                 header.height * header.size);
+        assert(st.st_size == SNAP_HEADER + (off_t)header.payload);
+
+        int prot = mode == UARRAY2_MAP_RDONLY ? PROT_READ
+                                              : PROT_READ | PROT_WRITE;
+        void *map = mmap(NULL, st.st_size, prot, MAP_PRIVATE, fd, 0);
+        assert(map != MAP_FAILED);
+        close(fd);            /* the mapping keeps the file open */
+
+        T uarray2 = new_header(header.width, header.height,
+                               header.size);
+        uarray2->elems      = (char *)map + SNAP_HEADER;
+        uarray2->map        = map;
+        uarray2->map_length = st.st_size;
+        uarray2->map_flags  = mode;
+
+        if (flags & UARRAY2_LOAD_VERIFY) {
+                assert(checksum_rows(SNAP_MAGIC, uarray2->elems,
+                                     (long)header.width * header.size,
+                                     header.height) ==
+                       header.checksum);
+        }
         return uarray2;
 }
 
+/*
+ * name: advise
+ *
+ * description: Passes an access-pattern hint for a mapped array's
+ * pages to the kernel. A view of a mapped array (at any depth)
+ * hints just the pages its rows span, from the page holding its
+ * first element. Arrays backed by a UArray ignore it.
+ *
+ * Parameters:
+ *   uarray2 - the array about to be traversed
+ *   advice  - a POSIX_MADV_* constant
+ *
+ * Returns:
+ *   void
+ */
+static void advise(T uarray2, int advice)
+{
+        T root = uarray2;
+        while (root->parent != NULL) {
+                root = root->parent;
+        }
+        if (root->map == NULL) {
+                return;
+        }
+        if (root == uarray2) {
+                posix_madvise(uarray2->map, uarray2->map_length,
+                              advice);
+                return;
+        }
+
+        uintptr_t page  = (uintptr_t)sysconf(_SC_PAGESIZE);
+        uintptr_t first = (uintptr_t)uarray2->elems;
+        uintptr_t end   = first + (uarray2->height - 1) *
+                                  uarray2->stride +
+                          (uintptr_t)uarray2->width * uarray2->size;
+        uintptr_t start = first & ~(page - 1);
+        posix_madvise((void *)start, end - start, advice);
+}
+
 /*
  * UArray2_at - see uarray2.h for contract
  */
@@ -58,8 +679,30 @@ void *UArray2_at(T uarray2, int col, int row)
         assert(col >= 0 && col < uarray2->width);
         assert(row >= 0 && row < uarray2->height);
 
-        int index = row * uarray2->width + col;
-        return UArray_at(uarray2->data, index);
+        if (uarray2->layout == UARRAY2_SPARSE) {
+                return sparse_at(uarray2, col, row, 1);
+        }
+        if (uarray2->layout == UARRAY2_MORTON) {
+                return uarray2->elems +
+                       morton_index(uarray2, col, row) * uarray2->size;
+        }
+        return uarray2->elems + row * uarray2->stride +
+               (long)col * uarray2->size;
+}
+
+/*
+ * UArray2_get - see uarray2.h for contract
+ */
+const void *UArray2_get(T uarray2, int col, int row)
+{
+        assert(uarray2 != NULL);
+        assert(col >= 0 && col < uarray2->width);
+        assert(row >= 0 && row < uarray2->height);
+
+        if (uarray2->layout == UARRAY2_SPARSE) {
+                return sparse_at(uarray2, col, row, 0);
+        }
+        return UArray2_at(uarray2, col, row);
 }
 
 /*
@@ -97,7 +740,27 @@ void UArray2_free(T *uarray2)
         assert(uarray2 != NULL);
         assert(*uarray2 != NULL);
 
-        UArray_free(&(*uarray2)->data);
+        T a = *uarray2;
+        if (a->parent != NULL) {
+                /* A view owns no storage */
+        } else if (a->map != NULL && a->map_flags == 0) {
+                Pages_unmap(a->map, a->map_length);
+        } else if (a->map != NULL) {
+                if (a->map_flags & UARRAY2_MAP_RDWR) {
+                        msync(a->map, a->map_length, MS_SYNC);
+                }
+                munmap(a->map, a->map_length);
+        } else if (a->layout == UARRAY2_SPARSE) {
+                for (int i = 0; i < a->nchunks; i++) {
+                        if (a->chunks[i] != NULL) {
+                                FREE(a->chunks[i]);
+                        }
+                }
+                FREE(a->chunks);
+                FREE(a->zero);
+        } else {
+                UArray_free(&a->data);
+        }
         FREE(*uarray2);
 }
 
@@ -110,12 +773,71 @@ void UArray2_map_col_major(T uarray2, UArray2_applyfun *apply,
         assert(uarray2 != NULL);
         assert(apply != NULL);
 
+        /* Every page is revisited once per column: fetch them all */
+        advise(uarray2, POSIX_MADV_WILLNEED);
         for (int col = 0; col < uarray2->width; col++) {
                 for (int row = 0; row < uarray2->height; row++) {
                         void *elem = UArray2_at(uarray2, col, row);
                         apply(col, row, uarray2, elem, cl);
                 }
         }
+        advise(uarray2, POSIX_MADV_NORMAL);
+}
+
+/*
+ * name: prefetch_rows
+ *
+ * description: Returns the default prefetch distance, in rows,
+ * for a column-major walk over elements of the given size. Tiny
+ * elements share each cache line with many later columns, so more
+ * of their loads hit already and a short lead does as well as a
+ * long one. Leads past 16 rows lost ground at every size in
+ * benchuarray2 on 16384-wide arrays, by evicting lines before use.
+ */
+static int prefetch_rows(int size)
+{
+        return size <= 2 ? PREFETCH_ROWS_SMALL : PREFETCH_ROWS;
+}
+
+/*
+ * UArray2_map_col_major_prefetch - see uarray2.h for contract
+ */
+void UArray2_map_col_major_prefetch(T uarray2, UArray2_applyfun *apply,
+                                    void *cl, int distance)
+{
+        assert(uarray2 != NULL);
+        assert(apply != NULL);
+        assert(distance >= 0);
+
+        if (uarray2->layout != UARRAY2_FLAT) {
+                UArray2_map_col_major(uarray2, apply, cl);
+                return;
+        }
+        if (distance == UARRAY2_PREFETCH_DEFAULT) {
+                distance = prefetch_rows(uarray2->size);
+        }
+
+        int height  = uarray2->height;
+        int lead    = distance < height ? distance : height;
+        int size    = uarray2->size;
+        long stride = uarray2->stride;
+        advise(uarray2, POSIX_MADV_WILLNEED);
+        for (int col = 0; col < uarray2->width; col++) {
+                char *elem  = uarray2->elems + (long)col * size;
+                char *ahead = elem + lead * stride;
+                int row = 0;
+                for (; row < height - lead; row++) {
+                        PREFETCH(ahead, 0);
+                        apply(col, row, uarray2, elem, cl);
+                        elem  += stride;
+                        ahead += stride;
+                }
+                for (; row < height; row++) {
+                        apply(col, row, uarray2, elem, cl);
+                        elem += stride;
+                }
+        }
+        advise(uarray2, POSIX_MADV_NORMAL);
 }
 
 /*
@@ -127,10 +849,1639 @@ void UArray2_map_row_major(T uarray2, UArray2_applyfun *apply,
         assert(uarray2 != NULL);
         assert(apply != NULL);
 
+        advise(uarray2, POSIX_MADV_SEQUENTIAL);
         for (int row = 0; row < uarray2->height; row++) {
                 for (int col = 0; col < uarray2->width; col++) {
                         void *elem = UArray2_at(uarray2, col, row);
                         apply(col, row, uarray2, elem, cl);
                 }
         }
+        advise(uarray2, POSIX_MADV_NORMAL);
+}
+
+/*
+ * name: scan_until
+ *
+ * description: Calls apply for each element, in column-major
+ * order if col_major is set and row-major order otherwise, until
+ * it returns UARRAY2_STOP.
+ *
+ * Returns:
+ *   the position apply stopped at, or {-1, -1}
+ */
+static UArray2_pos scan_until(T uarray2, UArray2_stopfun *apply,
+                              void *cl, int col_major)
+{
+        int outer = col_major ? uarray2->width : uarray2->height;
+        int inner = col_major ? uarray2->height : uarray2->width;
+
+        for (int i = 0; i < outer; i++) {
+                for (int j = 0; j < inner; j++) {
+                        UArray2_pos pos = { col_major ? i : j,
+                                            col_major ? j : i };
+                        void *elem = UArray2_at(uarray2, pos.col,
+                                                pos.row);
+                        if (apply(pos.col, pos.row, uarray2, elem, cl)
+                            == UARRAY2_STOP) {
+                                return pos;
+                        }
+                }
+        }
+
+        UArray2_pos nowhere = { -1, -1 };
+        return nowhere;
+}
+
+/*
+ * UArray2_map_row_major_until - see uarray2.h for contract
+ */
+UArray2_pos UArray2_map_row_major_until(T uarray2,
+                                        UArray2_stopfun *apply,
+                                        void *cl)
+{
+        assert(uarray2 != NULL);
+        assert(apply != NULL);
+
+        advise(uarray2, POSIX_MADV_SEQUENTIAL);
+        UArray2_pos stop = scan_until(uarray2, apply, cl, 0);
+        advise(uarray2, POSIX_MADV_NORMAL);
+        return stop;
+}
+
+/*
+ * UArray2_map_col_major_until - see uarray2.h for contract
+ */
+UArray2_pos UArray2_map_col_major_until(T uarray2,
+                                        UArray2_stopfun *apply,
+                                        void *cl)
+{
+        assert(uarray2 != NULL);
+        assert(apply != NULL);
+
+        advise(uarray2, POSIX_MADV_WILLNEED);
+        UArray2_pos stop = scan_until(uarray2, apply, cl, 1);
+        advise(uarray2, POSIX_MADV_NORMAL);
+        return stop;
+}
+
+/*
+ * UArray2_map_materialized - see uarray2.h for contract
+ */
+void UArray2_map_materialized(T uarray2, UArray2_applyfun *apply,
+                              void *cl)
+{
+        assert(uarray2 != NULL);
+        assert(apply != NULL);
+
+        if (uarray2->layout != UARRAY2_SPARSE) {
+                UArray2_map_row_major(uarray2, apply, cl);
+                return;
+        }
+
+        long length = (long)uarray2->width * uarray2->height;
+        for (int chunk = 0; chunk < uarray2->nchunks; chunk++) {
+                char *elem = uarray2->chunks[chunk];
+                if (elem == NULL) {
+                        continue;
+                }
+                long index = (long)chunk * uarray2->chunk_elems;
+                long end   = index + uarray2->chunk_elems;
+                if (end > length) {
+                        end = length;   /* last chunk may be short */
+                }
+                for (; index < end; index++, elem += uarray2->size) {
+                        int col = (int)(index % uarray2->width);
+                        int row = (int)(index / uarray2->width);
+                        apply(col, row, uarray2, elem, cl);
+                }
+        }
+}
+
+/*
+ * name: row_at
+ *
+ * description: Returns the address of element (col, row) of a
+ * flat array without bounds checks; callers check the whole
+ * range they touch up front.
+ */
+static char *row_at(T uarray2, int col, int row)
+{
+        return uarray2->elems + row * uarray2->stride +
+               (long)col * uarray2->size;
+}
+
+/*
+ * UArray2_fill - see uarray2.h for contract
+ */
+void UArray2_fill(T uarray2, const void *value)
+{
+        assert(uarray2 != NULL);
+        assert(value != NULL);
+
+        int size = uarray2->size;
+        int zero = 1;
+        for (int i = 0; i < size && zero; i++) {
+                zero = ((const char *)value)[i] == 0;
+        }
+
+        if (uarray2->layout == UARRAY2_SPARSE) {
+                if (zero) {
+                        /* All-zero is the unallocated state */
+                        for (int i = 0; i < uarray2->nchunks; i++) {
+                                if (uarray2->chunks[i] != NULL) {
+                                        FREE(uarray2->chunks[i]);
+                                }
+                        }
+                        return;
+                }
+                for (int row = 0; row < uarray2->height; row++) {
+                        for (int col = 0; col < uarray2->width; col++) {
+                                memcpy(sparse_at(uarray2, col, row, 1),
+                                       value, size);
+                        }
+                }
+                return;
+        }
+
+        long row_bytes = (long)uarray2->width * size;
+        int rows = uarray2->height;
+        if (uarray2->layout == UARRAY2_MORTON) {
+                /* One block; filling the padding too is harmless */
+                row_bytes = uarray2->morton_length * size;
+                rows = 1;
+        } else if (uarray2->stride == row_bytes) {
+                row_bytes *= rows;      /* no gaps: one long row */
+                rows = 1;
+        }
+
+        /* Build the first row by doubling, then copy it down */
+        char *first = uarray2->elems;
+        if (zero) {
+                memset(first, 0, row_bytes);
+        } else {
+                memcpy(first, value, size);
+                for (long done = size; done < row_bytes; done *= 2) {
+                        long left = row_bytes - done;
+                        memcpy(first + done, first,
+                               done < left ? done : left);
+                }
+        }
+        for (int row = 1; row < rows; row++) {
+                memcpy(first + row * uarray2->stride, first, row_bytes);
+        }
+}
+
+/*
+ * UArray2_blit - see uarray2.h for contract
+ */
+void UArray2_blit(T dst, int dx, int dy, T src, UArray2_rect rect)
+{
+        assert(dst != NULL && src != NULL);
+        assert(dst->size == src->size);
+        assert(rect.width >= 0 && rect.height >= 0);
+        assert(rect.col >= 0 && rect.col + rect.width <= src->width);
+        assert(rect.row >= 0 && rect.row + rect.height <= src->height);
+        assert(dx >= 0 && dx + rect.width <= dst->width);
+        assert(dy >= 0 && dy + rect.height <= dst->height);
+
+        if (rect.width == 0 || rect.height == 0) {
+                return;
+        }
+
+        int size = src->size;
+        if (dst->layout != UARRAY2_FLAT ||
+            src->layout != UARRAY2_FLAT) {
+                /*
+                 * Rows are not contiguous: copy one element at a
+                 * time, backwards if copying within one array to a
+                 * later position, so overlap is handled.
+                 */
+                int back = dst == src &&
+                           (dy > rect.row ||
+                            (dy == rect.row && dx > rect.col));
+                long n = (long)rect.width * rect.height;
+                for (long i = 0; i < n; i++) {
+                        long k = back ? n - 1 - i : i;
+                        int c = (int)(k % rect.width);
+                        int r = (int)(k / rect.width);
+                        const void *from = UArray2_get(src,
+                                rect.col + c, rect.row + r);
+                        memmove(UArray2_at(dst, dx + c, dy + r),
+                                from, size);
+                }
+                return;
+        }
+
+        /*
+         * Views may share storage, so rows are moved with memmove,
+         * walking upward when the destination lies after the source
+         * so no row is overwritten before it has been copied.
+         */
+        long row_bytes = (long)rect.width * size;
+        char *to   = row_at(dst, dx, dy);
+        char *from = row_at(src, rect.col, rect.row);
+        if (to > from) {
+                for (int r = rect.height - 1; r >= 0; r--) {
+                        memmove(to + r * dst->stride,
+                                from + r * src->stride, row_bytes);
+                }
+        } else {
+                for (int r = 0; r < rect.height; r++) {
+                        memmove(to + r * dst->stride,
+                                from + r * src->stride, row_bytes);
+                }
+        }
+}
+
+/*
+ * UArray2_copy - see uarray2.h for contract
+ */
+void UArray2_copy(T dst, T src)
+{
+        assert(dst != NULL && src != NULL);
+        assert(dst->width == src->width);
+        assert(dst->height == src->height);
+        assert(dst->size == src->size);
+
+        UArray2_rect all = { 0, 0, src->width, src->height };
+        long bytes = (long)src->width * src->height * src->size;
+
+        if (dst->layout == UARRAY2_FLAT &&
+            src->layout == UARRAY2_FLAT &&
+            dst->stride == src->stride &&
+            src->stride == (long)src->width * src->size) {
+                memmove(dst->elems, src->elems, bytes);
+        } else {
+                UArray2_blit(dst, 0, 0, src, all);
+        }
+}
+
+/*
+ * UArray2_swap_rows - see uarray2.h for contract
+ */
+void UArray2_swap_rows(T uarray2, int row1, int row2)
+{
+        assert(uarray2 != NULL);
+        assert(row1 >= 0 && row1 < uarray2->height);
+        assert(row2 >= 0 && row2 < uarray2->height);
+
+        if (row1 == row2) {
+                return;
+        }
+
+        /* Swap through a small stack buffer, one piece at a time */
+        char buf[512];
+        int size = uarray2->size;
+        if (uarray2->layout != UARRAY2_FLAT) {
+                for (int col = 0; col < uarray2->width; col++) {
+                        char *a = UArray2_at(uarray2, col, row1);
+                        char *b = UArray2_at(uarray2, col, row2);
+                        for (int i = 0; i < size; i++) {
+                                char t = a[i];
+                                a[i] = b[i];
+                                b[i] = t;
+                        }
+                }
+                return;
+        }
+
+        long row_bytes = (long)uarray2->width * size;
+        char *a = row_at(uarray2, 0, row1);
+        char *b = row_at(uarray2, 0, row2);
+        for (long done = 0; done < row_bytes; done += sizeof(buf)) {
+                long n = row_bytes - done < (long)sizeof(buf)
+                         ? row_bytes - done : (long)sizeof(buf);
+                memcpy(buf, a + done, n);
+                memcpy(a + done, b + done, n);
+                memcpy(b + done, buf, n);
+        }
+}
+
+/*
+ * name: transpose_tile
+ *
+ * description: Copies element (c, r) of the source block to
+ * (r, c) of the destination for every r in [r0, r1) and c in
+ * [c0, c1). Called with a constant size from transpose_base, so
+ * the compiler can turn each memcpy into a single move.
+ */
+static inline void transpose_tile(T dst, T src, int r0, int r1,
+                                  int c0, int c1, int size)
+{
+        for (int r = r0; r < r1; r++) {
+                const char *from = row_at(src, c0, r);
+                for (int c = c0; c < c1; c++, from += size) {
+                        memcpy(row_at(dst, r, c), from, size);
+                }
+        }
+}
+
+/*
+ * name: transpose_base
+ *
+ * description: Transposes one small block, picking a kernel
+ * specialised for the common element sizes.
+ */
+static void transpose_base(T dst, T src, int r0, int r1, int c0,
+                           int c1)
+{
+        switch (src->size) {
+        case 1:  transpose_tile(dst, src, r0, r1, c0, c1, 1); break;
+        case 2:  transpose_tile(dst, src, r0, r1, c0, c1, 2); break;
+        case 4:  transpose_tile(dst, src, r0, r1, c0, c1, 4); break;
+        case 8:  transpose_tile(dst, src, r0, r1, c0, c1, 8); break;
+        default: transpose_tile(dst, src, r0, r1, c0, c1, src->size);
+        }
+}
+
+/*
+ * name: transpose_block
+ *
+ * description: Cache-oblivious transpose of rows [r0, r1) and
+ * columns [c0, c1) of src into dst. The block is halved along its
+ * longer side until it fits TRANSPOSE_BASE bytes, so at some level
+ * of the recursion both the source rows and destination rows of a
+ * block fit in cache, whatever the cache size.
+ */
+static void transpose_block(T dst, T src, int r0, int r1, int c0,
+                            int c1)
+{
+        int rows = r1 - r0;
+        int cols = c1 - c0;
+
+        if ((long)rows * cols * src->size <= TRANSPOSE_BASE) {
+                transpose_base(dst, src, r0, r1, c0, c1);
+        } else if (rows >= cols) {
+                transpose_block(dst, src, r0, r0 + rows / 2, c0, c1);
+                transpose_block(dst, src, r0 + rows / 2, r1, c0, c1);
+        } else {
+                transpose_block(dst, src, r0, r1, c0, c0 + cols / 2);
+                transpose_block(dst, src, r0, r1, c0 + cols / 2, c1);
+        }
+}
+
+/*
+ * UArray2_transpose - see uarray2.h for contract
+ */
+T UArray2_transpose(T src)
+{
+        assert(src != NULL);
+
+        T dst = UArray2_new(src->height, src->width, src->size);
+
+        if (src->layout != UARRAY2_FLAT) {
+                for (int row = 0; row < src->height; row++) {
+                        for (int col = 0; col < src->width; col++) {
+                                memcpy(row_at(dst, row, col),
+                                       UArray2_get(src, col, row),
+                                       src->size);
+                        }
+                }
+        } else {
+                transpose_block(dst, src, 0, src->height, 0,
+                                src->width);
+        }
+        return dst;
+}
+
+/*
+ * name: swap_elems
+ *
+ * description: Exchanges the size bytes at a and b.
+ */
+static inline void swap_elems(char *a, char *b, int size)
+{
+        char tmp[TRANSPOSE_SWAP];
+
+        while (size > 0) {
+                int n = size < TRANSPOSE_SWAP ? size : TRANSPOSE_SWAP;
+                memcpy(tmp, a, n);
+                memcpy(a, b, n);
+                memcpy(b, tmp, n);
+                a += n;
+                b += n;
+                size -= n;
+        }
+}
+
+/*
+ * name: swap_block
+ *
+ * description: Cache-oblivious exchange of the block at rows
+ * [r0, r1), columns [c0, c1) with its mirror image across the
+ * main diagonal, element (c, r) for element (r, c). The two
+ * blocks must not overlap.
+ */
+static void swap_block(T a, int r0, int r1, int c0, int c1)
+{
+        int rows = r1 - r0;
+        int cols = c1 - c0;
+
+        if ((long)rows * cols * a->size <= TRANSPOSE_BASE) {
+                for (int r = r0; r < r1; r++) {
+                        for (int c = c0; c < c1; c++) {
+                                swap_elems(row_at(a, c, r),
+                                           row_at(a, r, c), a->size);
+                        }
+                }
+        } else if (rows >= cols) {
+                swap_block(a, r0, r0 + rows / 2, c0, c1);
+                swap_block(a, r0 + rows / 2, r1, c0, c1);
+        } else {
+                swap_block(a, r0, r1, c0, c0 + cols / 2);
+                swap_block(a, r0, r1, c0 + cols / 2, c1);
+        }
+}
+
+/*
+ * name: transpose_diagonal
+ *
+ * description: Transposes in place the square block of rows and
+ * columns [lo, hi): both diagonal quarters recursively, then the
+ * two off-diagonal quarters swapped with each other.
+ */
+static void transpose_diagonal(T a, int lo, int hi)
+{
+        int n = hi - lo;
+
+        if (n < 2) {
+                return;
+        }
+        if ((long)n * n * a->size <= TRANSPOSE_BASE) {
+                for (int r = lo + 1; r < hi; r++) {
+                        for (int c = lo; c < r; c++) {
+                                swap_elems(row_at(a, c, r),
+                                           row_at(a, r, c), a->size);
+                        }
+                }
+                return;
+        }
+        int mid = lo + n / 2;
+        transpose_diagonal(a, lo, mid);
+        transpose_diagonal(a, mid, hi);
+        swap_block(a, mid, hi, lo, mid);
+}
+
+/*
+ * UArray2_transpose_in_place - see uarray2.h for contract
+ */
+void UArray2_transpose_in_place(T uarray2)
+{
+        assert(uarray2 != NULL);
+        assert(uarray2->width == uarray2->height);
+        assert(uarray2->layout == UARRAY2_FLAT);
+
+        transpose_diagonal(uarray2, 0, uarray2->width);
+}
+
+/*
+ * name: visit_z
+ *
+ * description: Applies apply, in storage order, to the elements
+ * of the side-by-side Z-order square whose top-left corner is
+ * (col0, row0) and whose first element is at elem. Quarters that
+ * lie wholly in the padding are skipped.
+ */
+static void visit_z(T uarray2, int col0, int row0, int side, char *elem,
+                    UArray2_applyfun *apply, void *cl)
+{
+        if (col0 >= uarray2->width || row0 >= uarray2->height) {
+                return;
+        }
+        if (side == 1) {
+                apply(col0, row0, uarray2, elem, cl);
+                return;
+        }
+
+        int half = side / 2;
+        long quarter = (long)half * half * uarray2->size;
+        visit_z(uarray2, col0, row0, half, elem, apply, cl);
+        visit_z(uarray2, col0 + half, row0, half, elem + quarter,
+                apply, cl);
+        visit_z(uarray2, col0, row0 + half, half, elem + 2 * quarter,
+                apply, cl);
+        visit_z(uarray2, col0 + half, row0 + half, half,
+                elem + 3 * quarter, apply, cl);
+}
+
+/*
+ * UArray2_map_storage_order - see uarray2.h for contract
+ */
+void UArray2_map_storage_order(T uarray2, UArray2_applyfun *apply,
+                               void *cl)
+{
+        assert(uarray2 != NULL);
+        assert(apply != NULL);
+
+        if (uarray2->layout != UARRAY2_MORTON) {
+                UArray2_map_row_major(uarray2, apply, cl);
+                return;
+        }
+
+        /* A row (or column) of square Z-order blocks */
+        int side = 1 << uarray2->morton_bits;
+        long block = (long)side * side;
+        int wide = uarray2->width > side;
+        for (long k = 0; k * block < uarray2->morton_length; k++) {
+                int col0 = wide ? (int)(k * side) : 0;
+                int row0 = wide ? 0 : (int)(k * side);
+                visit_z(uarray2, col0, row0, side,
+                        uarray2->elems + k * block * uarray2->size,
+                        apply, cl);
+        }
+}
+
+/*
+ * name: border_index
+ *
+ * description: Maps a possibly out-of-range coordinate i onto
+ * [0, n) for a stencil border mode. Returns -1 if the neighbour
+ * lies outside the array under UARRAY2_BORDER_CONSTANT.
+ */
+static int border_index(int i, int n, UArray2_border mode)
+{
+        if (i >= 0 && i < n) {
+                return i;
+        }
+        switch (mode) {
+        case UARRAY2_BORDER_CLAMP:
+                return i < 0 ? 0 : n - 1;
+        case UARRAY2_BORDER_WRAP:
+                return ((i % n) + n) % n;
+        default:
+                return -1;
+        }
+}
+
+/*
+ * name: fill_window
+ *
+ * description: Copies the (2 * radius + 1)-square neighbourhood
+ * of (col, row) into window, resolving out-of-range neighbours
+ * by the border mode (constant neighbours are zero bytes).
+ */
+static void fill_window(T uarray2, int col, int row, int radius,
+                        UArray2_border mode, char *window)
+{
+        int size = uarray2->size;
+
+        for (int dr = -radius; dr <= radius; dr++) {
+                int r = border_index(row + dr, uarray2->height, mode);
+                for (int dc = -radius; dc <= radius; dc++) {
+                        int c = border_index(col + dc, uarray2->width,
+                                             mode);
+                        if (r < 0 || c < 0) {
+                                memset(window, 0, size);
+                        } else {
+                                memcpy(window,
+                                       UArray2_get(uarray2, c, r),
+                                       size);
+                        }
+                        window += size;
+                }
+        }
+}
+
+/*
+ * UArray2_map_stencil - see uarray2.h for contract
+ */
+void UArray2_map_stencil(T uarray2, int radius, UArray2_border mode,
+                         UArray2_stencilfun *apply, void *cl)
+{
+        assert(uarray2 != NULL);
+        assert(apply != NULL);
+        assert(radius >= 0);
+        assert(mode == UARRAY2_BORDER_CLAMP ||
+               mode == UARRAY2_BORDER_WRAP ||
+               mode == UARRAY2_BORDER_CONSTANT);
+
+        int width  = uarray2->width;
+        int height = uarray2->height;
+        int size   = uarray2->size;
+        int side   = 2 * radius + 1;
+        long window_pitch = (long)side * size;
+        char *window = ALLOC(side * window_pitch);
+        const char *window_center = window + radius * window_pitch +
+                                    (long)radius * size;
+
+        /* Only flat arrays have a row pitch for the fast path */
+        int fast = uarray2->layout == UARRAY2_FLAT;
+
+        for (int row = 0; row < height; row++) {
+                /* Too narrow an array has no interior columns */
+                int inner = fast && width > 2 * radius &&
+                            row >= radius && row < height - radius;
+                /* Columns [lo, hi) take the check-free path */
+                int lo = inner ? radius : width;
+                int hi = inner ? width - radius : width;
+
+                for (int col = 0; col < lo && col < width; col++) {
+                        fill_window(uarray2, col, row, radius, mode,
+                                    window);
+                        apply(col, row, uarray2, window_center,
+                              window_pitch, cl);
+                }
+                if (lo < hi) {
+                        /* Interior: every neighbour is in bounds */
+                        const char *center = row_at(uarray2, lo, row);
+                        for (int col = lo; col < hi; col++) {
+                                apply(col, row, uarray2, center,
+                                      uarray2->stride, cl);
+                                center += size;
+                        }
+                }
+                for (int col = hi; col < width; col++) {
+                        fill_window(uarray2, col, row, radius, mode,
+                                    window);
+                        apply(col, row, uarray2, window_center,
+                              window_pitch, cl);
+                }
+        }
+
+        FREE(window);
+}
+
+/*
+ * UArray2_fill_ghosts - see uarray2.h for contract
+ */
+void UArray2_fill_ghosts(T uarray2, UArray2_border mode)
+{
+        assert(uarray2 != NULL);
+        assert(mode == UARRAY2_BORDER_CLAMP ||
+               mode == UARRAY2_BORDER_WRAP ||
+               mode == UARRAY2_BORDER_CONSTANT);
+
+        int ghost  = uarray2->ghost;
+        int width  = uarray2->width;
+        int height = uarray2->height;
+        int size   = uarray2->size;
+        long row_bytes = (long)(width + 2 * ghost) * size;
+
+        if (ghost == 0) {
+                return;
+        }
+
+        /* Left and right ghosts of each logical row */
+        for (int row = 0; row < height; row++) {
+                char *line = row_at(uarray2, 0, row);
+                for (int g = 1; g <= ghost; g++) {
+                        int left  = border_index(-g, width, mode);
+                        int right = border_index(width - 1 + g, width,
+                                                 mode);
+                        char *lghost = line - (long)g * size;
+                        char *rghost = line + (long)(width - 1 + g) *
+                                       size;
+                        if (left < 0) {
+                                memset(lghost, 0, size);
+                                memset(rghost, 0, size);
+                        } else {
+                                memcpy(lghost, line + (long)left * size,
+                                       size);
+                                memcpy(rghost,
+                                       line + (long)right * size, size);
+                        }
+                }
+        }
+
+        /* Top and bottom ghost rows, now including their corners */
+        for (int g = 1; g <= ghost; g++) {
+                int rows[2] = { -g, height - 1 + g };
+                for (int i = 0; i < 2; i++) {
+                        char *dst = row_at(uarray2, -ghost, rows[i]);
+                        int from = border_index(rows[i], height, mode);
+                        if (from < 0) {
+                                memset(dst, 0, row_bytes);
+                        } else {
+                                memcpy(dst,
+                                       row_at(uarray2, -ghost, from),
+                                       row_bytes);
+                        }
+                }
+        }
+}
+
+/*
+ * UArray2_base - see uarray2.h for contract
+ */
+void *UArray2_base(T uarray2)
+{
+        assert(uarray2 != NULL);
+        assert(uarray2->layout == UARRAY2_FLAT);
+        return uarray2->elems;
+}
+
+/*
+ * UArray2_pitch - see uarray2.h for contract
+ */
+long UArray2_pitch(T uarray2)
+{
+        assert(uarray2 != NULL);
+        assert(uarray2->layout == UARRAY2_FLAT);
+        return uarray2->stride;
+}
+
+/*
+ * name: plan_bands
+ *
+ * description: Decides how a row-parallel operation over
+ * uarray2 is run. Small arrays run as one band on the calling
+ * thread; larger ones are split into a few bands per thread of
+ * Pool_shared().
+ *
+ * Parameters:
+ *   uarray2 - the array whose rows are split
+ *   nbands  - set to the number of bands
+ *
+ * Returns:
+ *   the pool to run on, or NULL to run on the calling thread
+ */
+static Pool_T plan_bands(T uarray2, int *nbands)
+{
+        if ((long)uarray2->width * uarray2->height < PARALLEL_CELLS) {
+                *nbands = 1;
+                return NULL;
+        }
+
+        Pool_T pool = Pool_shared();
+        int n = Pool_size(pool) * BANDS_PER_THREAD;
+        *nbands = n < uarray2->height ? n : uarray2->height;
+        return pool;
+}
+
+/*
+ * name: run_bands
+ *
+ * description: Runs task for every band, on pool if it is not
+ * NULL and on the calling thread otherwise. Bands are split over
+ * the pool by Pool_run_static, so each thread gets the same rows
+ * in every operation, including the first-touch zeroing of
+ * UArray2_new_flags.
+ */
+static void run_bands(Pool_T pool, int nbands, Pool_taskfun *task,
+                      void *job)
+{
+        if (pool == NULL) {
+                for (int i = 0; i < nbands; i++) {
+                        task(i, 0, job);
+                }
+        } else {
+                Pool_run_static(pool, nbands, task, job);
+        }
+}
+
+/*
+ * name: band_rows
+ *
+ * description: Sets [*row0, *row1) to the rows of band index
+ * when height rows are split into nbands nearly equal bands.
+ */
+static void band_rows(int height, int nbands, int index, int *row0,
+                      int *row1)
+{
+        *row0 = (int)((long)height * index / nbands);
+        *row1 = (int)((long)height * (index + 1) / nbands);
+}
+
+/*
+ * One first-touch zeroing by UArray2_new_flags.
+ */
+typedef struct Touch {
+        T uarray2;
+        int nbands;
+} Touch;
+
+/*
+ * name: touch_rows
+ *
+ * description: Pool task zeroing the rows of band index, so their
+ * pages are first touched by the thread that run_bands gives
+ * those rows to in later operations.
+ */
+static void touch_rows(int index, int thread, void *cl)
+{
+        Touch *job = cl;
+        T uarray2  = job->uarray2;
+        int row0, row1;
+        (void)thread;
+
+        band_rows(uarray2->height, job->nbands, index, &row0, &row1);
+        memset(uarray2->elems + row0 * uarray2->stride, 0,
+               (row1 - row0) * uarray2->stride);
+}
+
+/*
+ * UArray2_new_flags - see uarray2.h for contract
+ */
+T UArray2_new_flags(int width, int height, int size, int flags)
+{
+        assert((flags & ~(UARRAY2_ALLOC_HUGEPAGE |
+                          UARRAY2_ALLOC_POPULATE |
+                          UARRAY2_ALLOC_FIRST_TOUCH)) == 0);
+        assert(!((flags & UARRAY2_ALLOC_POPULATE) &&
+                 (flags & UARRAY2_ALLOC_FIRST_TOUCH)));
+
+        T uarray2 = new_header(width, height, size);
+        int page_flags = 0;
+        if (flags & UARRAY2_ALLOC_HUGEPAGE) {
+                page_flags |= PAGES_HUGE;
+        }
+        if (flags & UARRAY2_ALLOC_POPULATE) {
+                page_flags |= PAGES_POPULATE;
+        }
+        uarray2->map   = Pages_map(uarray2->stride * height, page_flags,
+                                   &uarray2->map_length);
+        uarray2->elems = uarray2->map;
+
+        if (flags & UARRAY2_ALLOC_FIRST_TOUCH) {
+                /* Fresh pages read as zero; writing zero faults them */
+                Touch job;
+                job.uarray2 = uarray2;
+                Pool_T pool = plan_bands(uarray2, &job.nbands);
+                run_bands(pool, job.nbands, touch_rows, &job);
+        }
+        return uarray2;
+}
+
+/*
+ * One UArray2_integral build, shared by its pool tasks.
+ */
+typedef struct Integral {
+        T src;
+        T sat;                /* the (width + 1) x (height + 1) table */
+        UArray2_elem type;
+        int nbands;           /* row bands in the first pass */
+        int nstrips;          /* column strips in the second pass */
+} Integral;
+
+/*
+ * name: read_elem
+ *
+ * description: Returns the element at p read as the given type.
+ */
+static inline int64_t read_elem(const void *p, UArray2_elem type)
+{
+        switch (type) {
+        case UARRAY2_ELEM_U8:  return *(const unsigned char *)p;
+        case UARRAY2_ELEM_U16: return *(const uint16_t *)p;
+        case UARRAY2_ELEM_I32: return *(const int32_t *)p;
+        default:               return *(const uint32_t *)p;
+        }
+}
+
+/*
+ * name: elem_size
+ *
+ * description: Returns the size in bytes of an element of type.
+ */
+static int elem_size(UArray2_elem type)
+{
+        switch (type) {
+        case UARRAY2_ELEM_U8:  return 1;
+        case UARRAY2_ELEM_U16: return 2;
+        default:               return 4;
+        }
+}
+
+/*
+ * name: prefix_row
+ *
+ * description: Writes the running sums of width contiguous
+ * elements at in to out. Called with a constant type, so each
+ * case compiles to its own loop with no switch inside.
+ */
+static inline void prefix_row(const char *in, int64_t *out,
+                              int width, UArray2_elem type)
+{
+        int size = elem_size(type);
+        int64_t sum = 0;
+
+        for (int col = 0; col < width; col++, in += size) {
+                sum += read_elem(in, type);
+                out[col] = sum;
+        }
+}
+
+/*
+ * name: integral_rows
+ *
+ * description: Pool task for the first pass of UArray2_integral:
+ * fills row r + 1 of the table with the prefix sums of src row r,
+ * for each row r in band index.
+ */
+static void integral_rows(int index, int thread, void *cl)
+{
+        Integral *job = cl;
+        T src     = job->src;
+        int width = src->width;
+        int row0, row1;
+        (void)thread;
+
+        band_rows(src->height, job->nbands, index, &row0, &row1);
+        for (int row = row0; row < row1; row++) {
+                int64_t *out = (int64_t *)row_at(job->sat, 1, row + 1);
+                if (src->layout != UARRAY2_FLAT) {
+                        int64_t sum = 0;
+                        for (int col = 0; col < width; col++) {
+                                sum += read_elem(UArray2_get(src, col,
+                                                             row),
+                                                 job->type);
+                                out[col] = sum;
+                        }
+                        continue;
+                }
+                const char *in = row_at(src, 0, row);
+                switch (job->type) {
+                case UARRAY2_ELEM_U8:
+                        prefix_row(in, out, width, UARRAY2_ELEM_U8);
+                        break;
+                case UARRAY2_ELEM_U16:
+                        prefix_row(in, out, width, UARRAY2_ELEM_U16);
+                        break;
+                case UARRAY2_ELEM_I32:
+                        prefix_row(in, out, width, UARRAY2_ELEM_I32);
+                        break;
+                case UARRAY2_ELEM_U32:
+                        prefix_row(in, out, width, UARRAY2_ELEM_U32);
+                        break;
+                }
+        }
+}
+
+/*
+ * name: integral_cols
+ *
+ * description: Pool task for the second pass of UArray2_integral:
+ * adds each row of the table into the next, for the columns of
+ * strip index. The inner loop runs along a row, so it is
+ * contiguous and the compiler can vectorize it.
+ */
+static void integral_cols(int index, int thread, void *cl)
+{
+        Integral *job = cl;
+        T sat    = job->sat;
+        int col0 = (int)((long)sat->width * index / job->nstrips);
+        int col1 = (int)((long)sat->width * (index + 1) /
+                         job->nstrips);
+        (void)thread;
+
+        for (int row = 1; row < sat->height; row++) {
+                const int64_t *above = (int64_t *)row_at(sat, 0,
+                                                         row - 1);
+                int64_t *here = (int64_t *)row_at(sat, 0, row);
+                for (int col = col0; col < col1; col++) {
+                        here[col] += above[col];
+                }
+        }
+}
+
+/*
+ * UArray2_integral - see uarray2.h for contract
+ */
+T UArray2_integral(T src, UArray2_elem type)
+{
+        assert(src != NULL);
+        assert(type == UARRAY2_ELEM_U8 || type == UARRAY2_ELEM_U16 ||
+               type == UARRAY2_ELEM_I32 || type == UARRAY2_ELEM_U32);
+        assert(src->size == elem_size(type));
+
+        Integral job;
+        T sat = UArray2_new(src->width + 1, src->height + 1,
+                            sizeof(int64_t));
+        Pool_T pool = plan_bands(src, &job.nbands);
+
+        job.src     = src;
+        job.sat     = sat;
+        job.type    = type;
+        job.nstrips = pool == NULL ? 1 : (sat->width + STRIP_COLS - 1) /
+                                         STRIP_COLS;
+
+        /* Row prefix sums, then add each row into the next */
+        run_bands(pool, job.nbands, integral_rows, &job);
+        run_bands(pool, job.nstrips, integral_cols, &job);
+        return sat;
+}
+
+/*
+ * UArray2_integral_sum - see uarray2.h for contract
+ */
+int64_t UArray2_integral_sum(T integral, UArray2_rect rect)
+{
+        assert(integral != NULL);
+        assert(integral->size == sizeof(int64_t));
+        assert(integral->layout == UARRAY2_FLAT);
+        assert(rect.width >= 0 && rect.height >= 0);
+        assert(rect.col >= 0 &&
+               rect.col + rect.width < integral->width);
+        assert(rect.row >= 0 &&
+               rect.row + rect.height < integral->height);
+
+        int right  = rect.col + rect.width;
+        int bottom = rect.row + rect.height;
+        const int64_t *top = (int64_t *)row_at(integral, 0, rect.row);
+        const int64_t *low = (int64_t *)row_at(integral, 0, bottom);
+
+        return low[right] - low[rect.col] - top[right] + top[rect.col];
+}
+
+/*
+ * Running sum, minimum and maximum kept by one thread, padded to
+ * a cache line so that threads never write to the same line.
+ */
+typedef struct Stats {
+        int64_t sum;
+        int64_t min;
+        int64_t max;
+        char pad[CACHE_LINE - 3 * sizeof(int64_t)];
+} Stats;
+
+/*
+ * One reduction over an array, shared by its pool tasks. Each
+ * thread t folds its rows into its own accumulator: accs +
+ * t * acc_stride for UArray2_reduce, stats[t] for the sum, min and
+ * max paths, and hist + t * hist_stride for UArray2_histogram.
+ */
+typedef struct Reduce {
+        T array;
+        int nbands;
+        UArray2_elem type;
+        char *accs;
+        long acc_stride;
+        UArray2_reducefun *per_elem;
+        void *cl;
+        Stats *stats;
+        int64_t *hist;
+        int nbins;
+        long hist_stride;
+} Reduce;
+
+/*
+ * name: round_to_line
+ *
+ * description: Rounds bytes up to a whole number of cache lines.
+ */
+static long round_to_line(long bytes)
+{
+        return (bytes + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+}
+
+/*
+ * name: reduce_rows
+ *
+ * description: Pool task for UArray2_reduce: folds every element
+ * of band index into the running thread's accumulator.
+ */
+static void reduce_rows(int index, int thread, void *cl)
+{
+        Reduce *job = cl;
+        T array = job->array;
+        void *acc = job->accs + thread * job->acc_stride;
+        int row0, row1;
+
+        band_rows(array->height, job->nbands, index, &row0, &row1);
+        for (int row = row0; row < row1; row++) {
+                if (array->layout != UARRAY2_FLAT) {
+                        for (int col = 0; col < array->width; col++) {
+                                job->per_elem(col, row,
+                                              UArray2_get(array, col,
+                                                          row),
+                                              acc, job->cl);
+                        }
+                        continue;
+                }
+                const char *elem = row_at(array, 0, row);
+                for (int col = 0; col < array->width; col++) {
+                        job->per_elem(col, row, elem, acc, job->cl);
+                        elem += array->size;
+                }
+        }
+}
+
+/*
+ * UArray2_reduce - see uarray2.h for contract
+ */
+void UArray2_reduce(T uarray2, void *acc, int acc_size,
+                    UArray2_combinefun *combine,
+                    UArray2_reducefun *per_elem, void *cl)
+{
+        assert(uarray2 != NULL);
+        assert(acc != NULL);
+        assert(acc_size > 0);
+        assert(combine != NULL && per_elem != NULL);
+
+        Reduce job;
+        Pool_T pool = plan_bands(uarray2, &job.nbands);
+        int nthreads = pool == NULL ? 1 : Pool_size(pool);
+
+        job.array      = uarray2;
+        job.acc_stride = round_to_line(acc_size);
+        job.accs       = ALLOC(nthreads * job.acc_stride);
+        job.per_elem   = per_elem;
+        job.cl         = cl;
+        for (int t = 0; t < nthreads; t++) {
+                memcpy(job.accs + t * job.acc_stride, acc, acc_size);
+        }
+
+        run_bands(pool, job.nbands, reduce_rows, &job);
+
+        for (int t = 0; t < nthreads; t++) {
+                combine(acc, job.accs + t * job.acc_stride, cl);
+        }
+        FREE(job.accs);
+}
+
+/*
+ * name: stats_row
+ *
+ * description: Folds width contiguous elements at in into st.
+ * Called with a constant type, like prefix_row.
+ */
+static inline void stats_row(const char *in, int width,
+                             UArray2_elem type, Stats *st)
+{
+        int size = elem_size(type);
+        int64_t sum = st->sum, min = st->min, max = st->max;
+
+        for (int col = 0; col < width; col++, in += size) {
+                int64_t v = read_elem(in, type);
+                sum += v;
+                min = v < min ? v : min;
+                max = v > max ? v : max;
+        }
+        st->sum = sum;
+        st->min = min;
+        st->max = max;
+}
+
+/*
+ * name: stats_rows
+ *
+ * description: Pool task for UArray2_sum, UArray2_min and
+ * UArray2_max: folds band index into the thread's Stats.
+ */
+static void stats_rows(int index, int thread, void *cl)
+{
+        Reduce *job = cl;
+        T array = job->array;
+        Stats *st = &job->stats[thread];
+        int row0, row1;
+
+        band_rows(array->height, job->nbands, index, &row0, &row1);
+        for (int row = row0; row < row1; row++) {
+                if (array->layout != UARRAY2_FLAT) {
+                        for (int col = 0; col < array->width; col++) {
+                                stats_row(UArray2_get(array, col, row),
+                                          1, job->type, st);
+                        }
+                        continue;
+                }
+                const char *in = row_at(array, 0, row);
+                switch (job->type) {
+                case UARRAY2_ELEM_U8:
+                        stats_row(in, array->width, UARRAY2_ELEM_U8,
+                                  st);
+                        break;
+                case UARRAY2_ELEM_U16:
+                        stats_row(in, array->width, UARRAY2_ELEM_U16,
+                                  st);
+                        break;
+                case UARRAY2_ELEM_I32:
+                        stats_row(in, array->width, UARRAY2_ELEM_I32,
+                                  st);
+                        break;
+                case UARRAY2_ELEM_U32:
+                        stats_row(in, array->width, UARRAY2_ELEM_U32,
+                                  st);
+                        break;
+                }
+        }
+}
+
+/*
+ * name: array_stats
+ *
+ * description: Returns the sum, minimum and maximum of every
+ * element of uarray2 read as type, with one Stats per thread.
+ *
+ * CRE: uarray2 is NULL, or its element size does not match type.
+ */
+static Stats array_stats(T uarray2, UArray2_elem type)
+{
+        assert(uarray2 != NULL);
+        assert(type == UARRAY2_ELEM_U8 || type == UARRAY2_ELEM_U16 ||
+               type == UARRAY2_ELEM_I32 || type == UARRAY2_ELEM_U32);
+        assert(uarray2->size == elem_size(type));
+
+        Reduce job;
+        Pool_T pool = plan_bands(uarray2, &job.nbands);
+        int nthreads = pool == NULL ? 1 : Pool_size(pool);
+        Stats total = { 0, INT64_MAX, INT64_MIN, { 0 } };
+
+        job.array = uarray2;
+        job.type  = type;
+        job.stats = ALLOC(nthreads * (long)sizeof(Stats));
+        for (int t = 0; t < nthreads; t++) {
+                job.stats[t] = total;
+        }
+
+        run_bands(pool, job.nbands, stats_rows, &job);
+
+        for (int t = 0; t < nthreads; t++) {
+                total.sum += job.stats[t].sum;
+                if (job.stats[t].min < total.min) {
+                        total.min = job.stats[t].min;
+                }
+                if (job.stats[t].max > total.max) {
+                        total.max = job.stats[t].max;
+                }
+        }
+        FREE(job.stats);
+        return total;
+}
+
+/*
+ * UArray2_sum - see uarray2.h for contract
+ */
+int64_t UArray2_sum(T uarray2, UArray2_elem type)
+{
+        return array_stats(uarray2, type).sum;
+}
+
+/*
+ * UArray2_min - see uarray2.h for contract
+ */
+int64_t UArray2_min(T uarray2, UArray2_elem type)
+{
+        return array_stats(uarray2, type).min;
+}
+
+/*
+ * UArray2_max - see uarray2.h for contract
+ */
+int64_t UArray2_max(T uarray2, UArray2_elem type)
+{
+        return array_stats(uarray2, type).max;
+}
+
+/*
+ * name: histogram_rows
+ *
+ * description: Pool task for UArray2_histogram: counts the
+ * elements of band index in the thread's own histogram.
+ */
+static void histogram_rows(int index, int thread, void *cl)
+{
+        Reduce *job = cl;
+        T array = job->array;
+        int64_t *counts = job->hist + thread * job->hist_stride;
+        int row0, row1;
+
+        band_rows(array->height, job->nbands, index, &row0, &row1);
+        for (int row = row0; row < row1; row++) {
+                for (int col = 0; col < array->width; col++) {
+                        const void *elem = array->layout == UARRAY2_FLAT
+                                ? row_at(array, col, row)
+                                : UArray2_get(array, col, row);
+                        int64_t v = read_elem(elem, job->type);
+                        if (v >= 0 && v < job->nbins) {
+                                counts[v]++;
+                        }
+                }
+        }
+}
+
+/*
+ * UArray2_histogram - see uarray2.h for contract
+ */
+void UArray2_histogram(T uarray2, UArray2_elem type, int64_t *counts,
+                       int nbins)
+{
+        assert(uarray2 != NULL);
+        assert(type == UARRAY2_ELEM_U8 || type == UARRAY2_ELEM_U16 ||
+               type == UARRAY2_ELEM_I32 || type == UARRAY2_ELEM_U32);
+        assert(uarray2->size == elem_size(type));
+        assert(counts != NULL);
+        assert(nbins > 0);
+
+        Reduce job;
+        Pool_T pool = plan_bands(uarray2, &job.nbands);
+        int nthreads = pool == NULL ? 1 : Pool_size(pool);
+
+        job.array       = uarray2;
+        job.type        = type;
+        job.nbins       = nbins;
+        job.hist_stride = round_to_line(nbins * (long)sizeof(int64_t)) /
+                          (long)sizeof(int64_t);
+        job.hist        = CALLOC(nthreads * job.hist_stride,
+                                 sizeof(int64_t));
+
+        run_bands(pool, job.nbands, histogram_rows, &job);
+
+        for (int bin = 0; bin < nbins; bin++) {
+                counts[bin] = 0;
+                for (int t = 0; t < nthreads; t++) {
+                        counts[bin] += job.hist[t * job.hist_stride +
+                                                bin];
+                }
+        }
+        FREE(job.hist);
+}
+
+/*
+ * name: check_coords
+ *
+ * description: Checks every coordinate of a gather or scatter
+ * batch up front, so the copy loops need no checks of their own.
+ *
+ * CRE: a coordinate lies outside uarray2.
+ */
+static void check_coords(T uarray2, const UArray2_pos *coords, int n)
+{
+        for (int i = 0; i < n; i++) {
+                assert(coords[i].col >= 0 &&
+                       coords[i].col < uarray2->width);
+                assert(coords[i].row >= 0 &&
+                       coords[i].row < uarray2->height);
+        }
+}
+
+/*
+ * name: row_order
+ *
+ * description: For a large batch on an array too big for the
+ * cache, returns the indices 0 .. n - 1 of coords stably sorted
+ * by row (a counting sort), so that the batch sweeps the array
+ * top to bottom. Stability keeps repeated coordinates in their
+ * original order, so the last of them still wins in a scatter.
+ *
+ * Returns:
+ *   a new array of n indices, or NULL if sorting does not pay
+ */
+static int *row_order(T uarray2, const UArray2_pos *coords, int n)
+{
+        if (n < SORT_COORDS ||
+            uarray2->height * uarray2->stride < SORT_BYTES) {
+                return NULL;
+        }
+
+        int *start = CALLOC(uarray2->height + 1, sizeof(int));
+        int *order = ALLOC(n * (long)sizeof(int));
+
+        for (int i = 0; i < n; i++) {
+                start[coords[i].row + 1]++;
+        }
+        for (int row = 0; row < uarray2->height; row++) {
+                start[row + 1] += start[row];
+        }
+        for (int i = 0; i < n; i++) {
+                order[start[coords[i].row]++] = i;
+        }
+
+        FREE(start);
+        return order;
+}
+
+/*
+ * name: move_batch
+ *
+ * description: Copies elements between a flat array and buf for
+ * coordinate k of the batch, taking coordinates in the given
+ * order (or as listed if order is NULL). buf holds element i of
+ * the batch at buf + i * size. Called with a constant size, like
+ * transpose_tile, so each copy is a single move.
+ *
+ * Parameters:
+ *   uarray2 - a flat array
+ *   coords  - checked coordinates
+ *   order   - visiting order from row_order, or NULL
+ *   n       - number of coordinates
+ *   buf     - the gather output or scatter input
+ *   size    - element size
+ *   gather  - 1 to copy array to buf, 0 to copy buf to array
+ */
+static inline void move_batch(T uarray2, const UArray2_pos *coords,
+                              const int *order, int n, char *buf,
+                              int size, int gather)
+{
+        for (int k = 0; k < n; k++) {
+                int i = order == NULL ? k : order[k];
+                if (k + PREFETCH_AHEAD < n) {
+                        int ahead = k + PREFETCH_AHEAD;
+                        if (order != NULL) {
+                                ahead = order[ahead];
+                        }
+                        char *next = row_at(uarray2, coords[ahead].col,
+                                            coords[ahead].row);
+                        if (gather) {
+                                PREFETCH(next, 0);
+                        } else {
+                                PREFETCH(next, 1);
+                        }
+                }
+                char *elem = row_at(uarray2, coords[i].col,
+                                    coords[i].row);
+                if (gather) {
+                        memcpy(buf + (long)i * size, elem, size);
+                } else {
+                        memcpy(elem, buf + (long)i * size, size);
+                }
+        }
+}
+
+/*
+ * name: move_flat
+ *
+ * description: Runs move_batch with the element size as a
+ * compile-time constant for the common sizes.
+ */
+static void move_flat(T uarray2, const UArray2_pos *coords,
+                      const int *order, int n, char *buf, int gather)
+{
+        switch (uarray2->size) {
+        case 1:
+                move_batch(uarray2, coords, order, n, buf, 1, gather);
+                break;
+        case 2:
+                move_batch(uarray2, coords, order, n, buf, 2, gather);
+                break;
+        case 4:
+                move_batch(uarray2, coords, order, n, buf, 4, gather);
+                break;
+        case 8:
+                move_batch(uarray2, coords, order, n, buf, 8, gather);
+                break;
+        default:
+                move_batch(uarray2, coords, order, n, buf,
+                           uarray2->size, gather);
+                break;
+        }
+}
+
+#if defined(GATHER_AVX2)
+#define EVEN_LANES  _MM_SHUFFLE(2, 0, 2, 0)
+#define ODD_LANES   _MM_SHUFFLE(3, 1, 3, 1)
+#define MIDDLE_SWAP _MM_SHUFFLE(3, 1, 2, 0)
+
+/*
+ * name: gather4_avx2
+ *
+ * description: Gathers 4-byte elements of a flat array eight at a
+ * time with the AVX2 gather instruction, splitting each group of
+ * eight (col, row) pairs into a column vector and a row vector.
+ * It is compiled for AVX2 whatever the -m flags, so it may only
+ * be called once __builtin_cpu_supports("avx2") has said yes.
+ *
+ * Returns:
+ *   the number of coordinates gathered (a multiple of 8); the
+ *   caller handles the rest
+ */
+__attribute__((target("avx2")))
+static int gather4_avx2(T uarray2, const UArray2_pos *coords, int n,
+                        char *out)
+{
+        const int *base = (const int *)uarray2->elems;
+        __m256i pitch = _mm256_set1_epi32((int)(uarray2->stride / 4));
+        int i = 0;
+
+        for (; i + 8 <= n; i += 8) {
+                __m256 lo = _mm256_loadu_ps((const float *)&coords[i]);
+                __m256 hi = _mm256_loadu_ps((const float *)
+                                            &coords[i + 4]);
+                /* lanes hold c0 c1 c4 c5 c2 c3 c6 c7; reorder them */
+                __m256i cols = _mm256_castps_si256(
+                        _mm256_shuffle_ps(lo, hi, EVEN_LANES));
+                __m256i rows = _mm256_castps_si256(
+                        _mm256_shuffle_ps(lo, hi, ODD_LANES));
+                cols = _mm256_permute4x64_epi64(cols, MIDDLE_SWAP);
+                rows = _mm256_permute4x64_epi64(rows, MIDDLE_SWAP);
+                __m256i index = _mm256_add_epi32(
+                        _mm256_mullo_epi32(rows, pitch), cols);
+                _mm256_storeu_si256((__m256i *)(out + (long)i * 4),
+                                    _mm256_i32gather_epi32(base, index,
+                                                           4));
+        }
+        return i;
+}
+
+/*
+ * name: gather4_sorted_avx2
+ *
+ * description: Like gather4_avx2, but takes the coordinates in
+ * the row-sorted order from row_order: each group of eight order
+ * indices gathers its (col, row) pairs from coords, then the
+ * elements, and each element is stored at its batch index in out.
+ * Under the same run-time AVX2 check as gather4_avx2, and only
+ * for n <= INT_MAX / 2, so every 2 * index fits the gather's
+ * 32-bit offsets.
+ *
+ * Returns:
+ *   the number of coordinates gathered (a multiple of 8); the
+ *   caller handles the rest, from order + that many
+ */
+__attribute__((target("avx2")))
+static int gather4_sorted_avx2(T uarray2, const UArray2_pos *coords,
+                               const int *order, int n, char *out)
+{
+        const int *base = (const int *)uarray2->elems;
+        const int *pairs = (const int *)coords;
+        __m256i pitch = _mm256_set1_epi32((int)(uarray2->stride / 4));
+        int i = 0;
+
+        for (; i + 8 <= n; i += 8) {
+                __m256i which = _mm256_loadu_si256((const __m256i *)
+                                                   &order[i]);
+                __m256i twice = _mm256_add_epi32(which, which);
+                __m256i cols = _mm256_i32gather_epi32(pairs, twice, 4);
+                __m256i rows = _mm256_i32gather_epi32(pairs + 1, twice,
+                                                      4);
+                __m256i index = _mm256_add_epi32(
+                        _mm256_mullo_epi32(rows, pitch), cols);
+                int lanes[8];
+                _mm256_storeu_si256((__m256i *)lanes,
+                                    _mm256_i32gather_epi32(base, index,
+                                                           4));
+                for (int j = 0; j < 8; j++) {
+                        memcpy(out + (long)order[i + j] * 4, &lanes[j],
+                               4);
+                }
+        }
+        return i;
+}
+#endif
+
+/*
+ * UArray2_gather - see uarray2.h for contract
+ */
+void UArray2_gather(T uarray2, const UArray2_pos *coords, int n,
+                    void *out)
+{
+        assert(uarray2 != NULL);
+        assert(n >= 0);
+        assert(n == 0 || (coords != NULL && out != NULL));
+        check_coords(uarray2, coords, n);
+
+        char *buf = out;
+        if (uarray2->layout != UARRAY2_FLAT) {
+                for (int i = 0; i < n; i++) {
+                        memcpy(buf + (long)i * uarray2->size,
+                               UArray2_get(uarray2, coords[i].col,
+                                           coords[i].row),
+                               uarray2->size);
+                }
+                return;
+        }
+
+        int *order = row_order(uarray2, coords, n);
+        int *rest  = order;
+#if defined(GATHER_AVX2)
+        /* Element indices must fit the gather's 32-bit offsets */
+        if (uarray2->size == 4 && __builtin_cpu_supports("avx2") &&
+            uarray2->stride % 4 == 0 &&
+            uarray2->height * (uarray2->stride / 4) <= INT_MAX) {
+                if (order == NULL) {
+                        int done = gather4_avx2(uarray2, coords, n,
+                                                buf);
+                        coords += done;
+                        buf    += (long)done * 4;
+                        n      -= done;
+                } else if (n <= INT_MAX / 2) {
+                        int done = gather4_sorted_avx2(uarray2, coords,
+                                                       order, n, buf);
+                        rest += done;
+                        n    -= done;
+                }
+        }
+#endif
+        move_flat(uarray2, coords, rest, n, buf, 1);
+        if (order != NULL) {
+                FREE(order);
+        }
+}
+
+/*
+ * UArray2_scatter - see uarray2.h for contract
+ */
+void UArray2_scatter(T uarray2, const UArray2_pos *coords, int n,
+                     const void *in)
+{
+        assert(uarray2 != NULL);
+        assert(n >= 0);
+        assert(n == 0 || (coords != NULL && in != NULL));
+        check_coords(uarray2, coords, n);
+
+        char *buf = (char *)in;
+        if (uarray2->layout != UARRAY2_FLAT) {
+                for (int i = 0; i < n; i++) {
+                        memcpy(UArray2_at(uarray2, coords[i].col,
+                                          coords[i].row),
+                               buf + (long)i * uarray2->size,
+                               uarray2->size);
+                }
+                return;
+        }
+
+        int *order = row_order(uarray2, coords, n);
+        move_flat(uarray2, coords, order, n, buf, 0);
+        if (order != NULL) {
+                FREE(order);
+        }
 }
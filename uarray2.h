@@ -22,6 +22,8 @@
 #ifndef UARRAY2_INCLUDED
 #define UARRAY2_INCLUDED
 
+#include <stdint.h>
+
 #define T UArray2_T
 typedef struct T *T;
 
@@ -45,12 +47,269 @@ typedef struct T *T;
  */
 extern T UArray2_new(int width, int height, int size);
 
+/*
+ * Flags for UArray2_new_flags and Bit2_new_flags; 0 or more may
+ * be given, except that POPULATE and FIRST_TOUCH exclude each
+ * other.
+ *
+ *   UARRAY2_ALLOC_HUGEPAGE    - back the elements with transparent
+ *                               huge pages where the system allows,
+ *                               cutting TLB misses on large scans
+ *   UARRAY2_ALLOC_POPULATE    - fault every page in during the
+ *                               call, on the calling thread
+ *   UARRAY2_ALLOC_FIRST_TOUCH - zero the elements in parallel by
+ *                               bands of rows on Pool_shared(), so
+ *                               page faults are spread over the
+ *                               pool and each page is first touched
+ *                               by the thread that the parallel
+ *                               operations of this interface give
+ *                               its rows to (see Pool_run_static)
+ */
+#define UARRAY2_ALLOC_HUGEPAGE    0x1
+#define UARRAY2_ALLOC_POPULATE    0x2
+#define UARRAY2_ALLOC_FIRST_TOUCH 0x4
+
+/*
+ * UArray2_new_flags
+ *
+ * Like UArray2_new, but the elements are mapped directly from the
+ * kernel instead of allocated through UArray_new, as the flags
+ * ask. Meant for grids of many megabytes; for small arrays it
+ * only wastes memory. All elements are zero.
+ *
+ * Parameters:
+ *   width  - number of columns in the array; must be > 0
+ *   height - number of rows in the array; must be > 0
+ *   size   - size (in bytes) of each element; must be > 0
+ *   flags  - UARRAY2_ALLOC_* flags as described above
+ *
+ * Returns: A new flat UArray2_T, freed with UArray2_free.
+ *
+ * CRE: width <= 0, height <= 0, or size <= 0.
+ * CRE: flags has unknown bits, or both POPULATE and FIRST_TOUCH.
+ * CRE: memory cannot be mapped.
+ */
+extern T UArray2_new_flags(int width, int height, int size,
+                           int flags);
+
+/*
+ * UArray2_new_sparse
+ *
+ * Allocates a width-by-height array like UArray2_new, but memory
+ * is only spent on the parts that are written. Elements are
+ * grouped, in row-major order, into chunks of about 4 KB that are
+ * allocated (zero-filled) on first write; until then, reads see
+ * zero bytes. Use UArray2_get to read without allocating, and
+ * UArray2_map_materialized to visit only allocated chunks; the
+ * row- and column-major maps hand out writable pointers and so
+ * allocate every chunk.
+ *
+ * Parameters:
+ *   width  - number of columns in the array; must be > 0
+ *   height - number of rows in the array; must be > 0
+ *   size   - size (in bytes) of each element; must be > 0
+ *
+ * Returns: A new, fully zero, sparse UArray2_T.
+ *
+ * CRE: width <= 0, height <= 0, or size <= 0.
+ * CRE: memory allocation failure.
+ */
+extern T UArray2_new_sparse(int width, int height, int size);
+
+/*
+ * UArray2_new_morton
+ *
+ * Allocates a width-by-height array like UArray2_new, but stores
+ * its elements in Morton (Z-order): the bits of col and row are
+ * interleaved to form the storage index, so elements that are
+ * close in either axis are close in memory. This suits 3x3 and
+ * other neighbourhood access patterns. Storage is padded to a
+ * power of two in each dimension, up to 4x width * height
+ * elements. UArray2_at and both maps work as usual;
+ * UArray2_map_storage_order visits elements in memory order.
+ *
+ * Parameters:
+ *   width  - number of columns in the array; must be > 0
+ *   height - number of rows in the array; must be > 0
+ *   size   - size (in bytes) of each element; must be > 0
+ *
+ * Returns: A new, zero-filled, Z-ordered UArray2_T.
+ *
+ * CRE: width <= 0, height <= 0, or size <= 0.
+ * CRE: the padded element count exceeds INT_MAX.
+ * CRE: memory allocation failure.
+ */
+extern T UArray2_new_morton(int width, int height, int size);
+
+/*
+ * UArray2_new_padded
+ *
+ * Allocates a width-by-height array like UArray2_new, surrounded
+ * by a border of ghost cells, ghost elements deep on every side.
+ * UArray2_at, the maps and the bulk operations see only the
+ * logical width x height elements. Kernels that use UArray2_base
+ * and UArray2_pitch may also read up to ghost elements beyond any
+ * edge without bounds checks; UArray2_fill_ghosts sets what they
+ * find there. The ghost cells start out zero.
+ *
+ * Parameters:
+ *   width  - number of logical columns; must be > 0
+ *   height - number of logical rows; must be > 0
+ *   size   - size (in bytes) of each element; must be > 0
+ *   ghost  - depth of the ghost border; must be >= 0
+ *
+ * Returns: A new, zero-filled, padded UArray2_T.
+ *
+ * CRE: width <= 0, height <= 0, size <= 0, or ghost < 0.
+ * CRE: memory allocation failure.
+ */
+extern T UArray2_new_padded(int width, int height, int size,
+                            int ghost);
+
+/*
+ * UArray2_view
+ *
+ * Returns a width-by-height array whose element (col, row) is
+ * element (col0 + col, row0 + row) of parent. No elements are
+ * copied: the view shares parent's storage, so writes through
+ * either are seen by both. UArray2_at, the size queries and both
+ * map functions work on a view exactly as on any array, and a
+ * view may itself be the parent of another view. Free a view
+ * with UArray2_free before freeing its parent.
+ *
+ * Parameters:
+ *   parent - the array to view; must not be sparse
+ *   col0   - parent column of the view's column 0
+ *   row0   - parent row of the view's row 0
+ *   width  - number of columns in the view; must be > 0
+ *   height - number of rows in the view; must be > 0
+ *
+ * Returns: A new UArray2_T sharing parent's storage.
+ *
+ * CRE: parent is NULL or was created by UArray2_new_sparse or
+ *      UArray2_new_morton.
+ * CRE: width <= 0 or height <= 0.
+ * CRE: the rectangle does not lie entirely within parent.
+ */
+extern T UArray2_view(T parent, int col0, int row0, int width,
+                      int height);
+
+/*
+ * Flags for UArray2_map_file. Exactly one of RDONLY, RDWR and
+ * PRIVATE must be given; CREATE may be added to RDWR or PRIVATE.
+ *
+ *   UARRAY2_MAP_RDONLY  - elements may only be read
+ *   UARRAY2_MAP_RDWR    - writes go to the file and are seen by
+ *                         every process mapping it
+ *   UARRAY2_MAP_PRIVATE - writes stay private to this array and
+ *                         never reach the file
+ *   UARRAY2_MAP_CREATE  - create the file, zero-filled, if it is
+ *                         missing or empty
+ */
+#define UARRAY2_MAP_RDONLY  0x1
+#define UARRAY2_MAP_RDWR    0x2
+#define UARRAY2_MAP_PRIVATE 0x4
+#define UARRAY2_MAP_CREATE  0x8
+
+/*
+ * UArray2_map_file
+ *
+ * Returns a 2D array whose elements live in the file at path,
+ * mapped into memory rather than copied. The file holds a small
+ * header recording width, height and size, followed by the
+ * elements in row-major order. Other processes may map the same
+ * file to share the grid, and a later run can reopen it without
+ * reloading anything. Behaves like an array from UArray2_new in
+ * every other respect; the map functions additionally hint the
+ * kernel to read pages ahead in their traversal order, and do so
+ * for a view of the array over just the pages the view spans.
+ *
+ * Parameters:
+ *   path   - file to open, or to create with UARRAY2_MAP_CREATE
+ *   width  - number of columns; 0 accepts the file's width
+ *   height - number of rows; 0 accepts the file's height
+ *   size   - element size in bytes; 0 accepts the file's size
+ *   flags  - UARRAY2_MAP_* flags as described above
+ *
+ * Returns: A new UArray2_T over the mapped file. UArray2_free
+ *          flushes RDWR changes to the file with msync and unmaps
+ *          it.
+ *
+ * CRE: path is NULL, or flags is not a valid combination or has
+ *      bits other than the UARRAY2_MAP_* flags.
+ * CRE: width, height or size is negative, or is 0 when a new
+ *      file must be created.
+ * CRE: the file cannot be opened, created or mapped.
+ * CRE: an existing file has a bad header or its width, height or
+ *      size differs from a nonzero argument.
+ * CRE: writing through UArray2_at on a RDONLY array (the process
+ *      is killed by the operating system).
+ */
+extern T UArray2_map_file(const char *path, int width, int height,
+                          int size, int flags);
+
+/*
+ * Flag for UArray2_load and Bit2_load: check the payload checksum.
+ */
+#define UARRAY2_LOAD_VERIFY 0x10
+
+/*
+ * UArray2_save
+ *
+ * Writes a snapshot of uarray2 to the file at path, replacing any
+ * file there, for a later UArray2_load. The file is a versioned
+ * binary format: a one-page header recording width, height,
+ * element size, payload layout and checksums, then the elements
+ * as packed rows starting on a page boundary. Elements are
+ * written as raw bytes in this machine's byte order. Any layout
+ * (views, padded, sparse and Morton arrays included) may be
+ * saved; the payload is always row-major.
+ *
+ * Parameters:
+ *   uarray2 - the array to save
+ *   path    - file to write
+ *
+ * CRE: uarray2 or path is NULL.
+ * CRE: the file cannot be created or written.
+ */
+extern void UArray2_save(T uarray2, const char *path);
+
+/*
+ * UArray2_load
+ *
+ * Returns the array saved in the file at path by UArray2_save.
+ * The file is mapped, not read: the elements are used where they
+ * lie in the page cache, so loading costs the same for any size
+ * of array, and pages are read from disk only when first touched.
+ * The header is always checked; the payload checksum is checked
+ * only with UARRAY2_LOAD_VERIFY, since that reads every page.
+ *
+ * Parameters:
+ *   path  - file written by UArray2_save
+ *   flags - UARRAY2_MAP_RDONLY (elements may only be read) or
+ *           UARRAY2_MAP_PRIVATE (writes stay private to this
+ *           array and never reach the file), optionally with
+ *           UARRAY2_LOAD_VERIFY
+ *
+ * Returns: A new flat UArray2_T over the mapped file, freed with
+ *          UArray2_free.
+ *
+ * CRE: path is NULL, or flags is not a valid combination.
+ * CRE: the file cannot be opened or mapped, or is not a snapshot
+ *      of this version, or its header checksum is wrong.
+ * CRE: UARRAY2_LOAD_VERIFY is given and the payload checksum is
+ *      wrong.
+ * CRE: writing through UArray2_at on a RDONLY array (the process
+ *      is killed by the operating system).
+ */
+extern T UArray2_load(const char *path, int flags);
+
 /*
  * UArray2_free
  *
  * Deallocates all memory associated with *uarray2 and sets
  * *uarray2 to NULL. The caller relinquishes ownership of the
- * array.
+ * array. Freeing a view leaves its parent's elements untouched.
  *
  * Parameters:
  *   uarray2 - pointer to the UArray2_T to free
@@ -107,7 +366,8 @@ extern int UArray2_size(T uarray2);
  * Returns a pointer to the element at position (col, row).
  * The caller casts and dereferences this pointer to read or
  * write. The returned pointer is valid until UArray2_free is
- * called.
+ * called. On a sparse array this allocates the element's chunk
+ * if needed, since the caller may write through the pointer.
  *
  * Parameters:
  *   uarray2 - the array
@@ -121,6 +381,27 @@ extern int UArray2_size(T uarray2);
  */
 extern void *UArray2_at(T uarray2, int col, int row);
 
+/*
+ * UArray2_get
+ *
+ * Returns a read-only pointer to the element at (col, row). For
+ * arrays from UArray2_new_sparse this never allocates: an element
+ * whose chunk has never been written is read from a shared zero
+ * element. For all other arrays it is the same as UArray2_at.
+ * The pointer is valid until the next write to the array.
+ *
+ * Parameters:
+ *   uarray2 - the array
+ *   col     - column index (0 <= col < width)
+ *   row     - row index (0 <= row < height)
+ *
+ * Returns: const pointer to the value at (col, row).
+ *
+ * CRE: uarray2 is NULL.
+ * CRE: col or row is out of bounds.
+ */
+extern const void *UArray2_get(T uarray2, int col, int row);
+
 /*
  * UArray2_applyfun
  *
@@ -154,6 +435,32 @@ extern void UArray2_map_col_major(T uarray2,
                                   UArray2_applyfun *apply,
                                   void *cl);
 
+/*
+ * UArray2_map_col_major_prefetch
+ *
+ * Same as UArray2_map_col_major, but while visiting row r it
+ * prefetches the element distance rows further down the column.
+ * Each step of a column-major walk lands a whole row further on,
+ * which hardware prefetchers do not follow on wide arrays, so
+ * without this nearly every step waits on memory. Sparse and
+ * Morton arrays are mapped without prefetching.
+ *
+ * Parameters:
+ *   uarray2  - the array to traverse
+ *   apply    - function to call for each element
+ *   cl       - closure passed to each apply call
+ *   distance - rows to prefetch ahead, or
+ *              UARRAY2_PREFETCH_DEFAULT for a distance chosen by
+ *              element size from benchuarray2 measurements
+ *
+ * CRE: uarray2 is NULL, apply is NULL, or distance < 0.
+ */
+#define UARRAY2_PREFETCH_DEFAULT 0
+
+extern void UArray2_map_col_major_prefetch(T uarray2,
+                                           UArray2_applyfun *apply,
+                                           void *cl, int distance);
+
 /*
  * UArray2_map_row_major
  *
@@ -171,5 +478,488 @@ extern void UArray2_map_row_major(T uarray2,
                                   UArray2_applyfun *apply,
                                   void *cl);
 
+/*
+ * UArray2_pos
+ *
+ * A position in an array, as returned by the stopping maps.
+ */
+typedef struct UArray2_pos {
+        int col;
+        int row;
+} UArray2_pos;
+
+#define UARRAY2_CONTINUE 0
+#define UARRAY2_STOP     1
+
+/*
+ * UArray2_stopfun
+ *
+ * Apply function for the stopping maps. Same parameters as
+ * UArray2_applyfun; returns UARRAY2_STOP to end the traversal at
+ * this element or UARRAY2_CONTINUE to go on.
+ */
+typedef int UArray2_stopfun(int col, int row, T uarray2, void *elem,
+                            void *cl);
+
+/*
+ * UArray2_map_row_major_until / UArray2_map_col_major_until
+ *
+ * Like UArray2_map_row_major and UArray2_map_col_major, but stop
+ * as soon as apply returns UARRAY2_STOP, so searches and checks
+ * only scan as far as they need to.
+ *
+ * Parameters:
+ *   uarray2 - the array to traverse
+ *   apply   - function to call for each element, until it stops
+ *   cl      - closure passed to each apply call
+ *
+ * Returns: The position of the element at which apply stopped,
+ *          or {-1, -1} if it never did.
+ *
+ * CRE: uarray2 is NULL or apply is NULL.
+ */
+extern UArray2_pos UArray2_map_row_major_until(T uarray2,
+                                               UArray2_stopfun *apply,
+                                               void *cl);
+extern UArray2_pos UArray2_map_col_major_until(T uarray2,
+                                               UArray2_stopfun *apply,
+                                               void *cl);
+
+/*
+ * UArray2_map_materialized
+ *
+ * Calls the apply function, in row-major order, for every
+ * element of a sparse array whose chunk has been allocated,
+ * skipping the never-written (all-zero) rest. Elements of an
+ * allocated chunk are visited even if they are still zero. On a
+ * non-sparse array this is UArray2_map_row_major.
+ *
+ * Parameters:
+ *   uarray2 - the array to traverse
+ *   apply   - function to call for each element
+ *   cl      - closure passed to each apply call
+ *
+ * CRE: uarray2 is NULL or apply is NULL.
+ */
+extern void UArray2_map_materialized(T uarray2,
+                                     UArray2_applyfun *apply,
+                                     void *cl);
+
+/*
+ * UArray2_rect
+ *
+ * A rectangle of elements: width columns starting at column col
+ * and height rows starting at row row.
+ */
+typedef struct UArray2_rect {
+        int col;
+        int row;
+        int width;
+        int height;
+} UArray2_rect;
+
+/*
+ * UArray2_fill
+ *
+ * Sets every element of the array to the size bytes at value,
+ * using memset/memcpy rather than per-element calls. Filling a
+ * sparse array with zero releases all of its chunks.
+ *
+ * Parameters:
+ *   uarray2 - the array to fill
+ *   value   - pointer to one element's worth of bytes
+ *
+ * CRE: uarray2 is NULL or value is NULL.
+ */
+extern void UArray2_fill(T uarray2, const void *value);
+
+/*
+ * UArray2_copy
+ *
+ * Copies every element of src into the same position of dst.
+ * The arrays may be views sharing storage.
+ *
+ * Parameters:
+ *   dst - array to copy into
+ *   src - array to copy from
+ *
+ * CRE: dst or src is NULL.
+ * CRE: dst and src differ in width, height or element size.
+ */
+extern void UArray2_copy(T dst, T src);
+
+/*
+ * UArray2_blit
+ *
+ * Copies the rectangle rect of src into dst so that element
+ * (rect.col, rect.row) of src lands at (dx, dy) of dst. Rows are
+ * moved with memmove, so src and dst may be the same array or
+ * overlapping views of one array.
+ *
+ * Parameters:
+ *   dst  - array to copy into
+ *   dx   - destination column of the rectangle's left edge
+ *   dy   - destination row of the rectangle's top edge
+ *   src  - array to copy from
+ *   rect - rectangle of src to copy; may be empty
+ *
+ * CRE: dst or src is NULL, or their element sizes differ.
+ * CRE: rect does not lie within src, or the destination
+ *      rectangle does not lie within dst.
+ */
+extern void UArray2_blit(T dst, int dx, int dy, T src,
+                         UArray2_rect rect);
+
+/*
+ * UArray2_swap_rows
+ *
+ * Exchanges the contents of rows row1 and row2.
+ *
+ * Parameters:
+ *   uarray2 - the array
+ *   row1    - first row index
+ *   row2    - second row index
+ *
+ * CRE: uarray2 is NULL, or row1 or row2 is out of bounds.
+ */
+extern void UArray2_swap_rows(T uarray2, int row1, int row2);
+
+/*
+ * UArray2_transpose
+ *
+ * Returns a new height-by-width array whose element (row, col)
+ * is element (col, row) of src. The copy is done by recursive,
+ * cache-oblivious blocking, so a column-oriented pass can be run
+ * as a row-major pass over the transpose at close to memory
+ * speed. The caller frees the result with UArray2_free.
+ *
+ * Parameters:
+ *   src - the array to transpose
+ *
+ * Returns: A new UArray2_T holding the transpose of src.
+ *
+ * CRE: src is NULL.
+ * CRE: memory allocation failure.
+ */
+extern T UArray2_transpose(T src);
+
+/*
+ * UArray2_transpose_in_place
+ *
+ * Transposes a square array in place, exchanging element
+ * (col, row) with element (row, col) by the same cache-oblivious
+ * blocking as UArray2_transpose.
+ *
+ * Parameters:
+ *   uarray2 - the array to transpose
+ *
+ * CRE: uarray2 is NULL, sparse or Morton-ordered.
+ * CRE: the width and height of uarray2 differ.
+ */
+extern void UArray2_transpose_in_place(T uarray2);
+
+/*
+ * UArray2_map_storage_order
+ *
+ * Calls the apply function for each element in the order the
+ * elements are stored in memory: Z-order for an array from
+ * UArray2_new_morton, row-major for every other array. This is
+ * the fastest way to visit every element when order does not
+ * matter.
+ *
+ * Parameters:
+ *   uarray2 - the array to traverse
+ *   apply   - function to call for each element
+ *   cl      - closure passed to each apply call
+ *
+ * CRE: uarray2 is NULL or apply is NULL.
+ */
+extern void UArray2_map_storage_order(T uarray2,
+                                      UArray2_applyfun *apply,
+                                      void *cl);
+
+/*
+ * UArray2_border
+ *
+ * How UArray2_map_stencil supplies neighbours that fall outside
+ * the array:
+ *
+ *   UARRAY2_BORDER_CLAMP    - the nearest element on the edge
+ *   UARRAY2_BORDER_WRAP     - the element from the opposite edge
+ *   UARRAY2_BORDER_CONSTANT - an element of all zero bytes
+ */
+typedef enum {
+        UARRAY2_BORDER_CLAMP,
+        UARRAY2_BORDER_WRAP,
+        UARRAY2_BORDER_CONSTANT
+} UArray2_border;
+
+/*
+ * UArray2_stencilfun
+ *
+ * Function pointer type for the apply function used by
+ * UArray2_map_stencil. Called once for each element.
+ *
+ * Parameters:
+ *   col     - current column index
+ *   row     - current row index
+ *   uarray2 - the array being traversed
+ *   center  - read-only pointer to the current element; the
+ *             neighbour at offset (dc, dr), with |dc| and |dr| at
+ *             most the radius, is at
+ *             center + dr * pitch + dc * UArray2_size(uarray2)
+ *   pitch   - bytes between vertically adjacent neighbours
+ *   cl      - closure data passed through from the map call
+ */
+typedef void UArray2_stencilfun(int col, int row, T uarray2,
+                                const void *center, long pitch,
+                                void *cl);
+
+/*
+ * UArray2_map_stencil
+ *
+ * Calls the apply function for each element in row-major order,
+ * giving it direct pointer access to every neighbour within
+ * radius. Elements at least radius away from every edge get a
+ * pointer into the array itself, with no bounds checks at all.
+ * Only elements in the halo near the edges are served from a
+ * small copied neighbourhood filled in by the border mode. Since
+ * center may point into that copy, apply must write its results
+ * elsewhere (typically to a second array), not through center.
+ * Sparse and Morton arrays are served entirely from copies.
+ *
+ * Parameters:
+ *   uarray2 - the array to traverse
+ *   radius  - how far neighbours reach in each direction; >= 0
+ *   mode    - how neighbours outside the array are supplied
+ *   apply   - function to call for each element
+ *   cl      - closure passed to each apply call
+ *
+ * CRE: uarray2 is NULL or apply is NULL.
+ * CRE: radius < 0, or mode is not a UArray2_border value.
+ */
+extern void UArray2_map_stencil(T uarray2, int radius,
+                                UArray2_border mode,
+                                UArray2_stencilfun *apply, void *cl);
+
+/*
+ * UArray2_fill_ghosts
+ *
+ * Sets every ghost cell of an array from UArray2_new_padded by
+ * the border mode: UARRAY2_BORDER_CLAMP replicates the nearest
+ * edge element, UARRAY2_BORDER_WRAP copies from the opposite edge
+ * and UARRAY2_BORDER_CONSTANT zeroes them. Call it again whenever
+ * elements near an edge change. Does nothing if the array has no
+ * ghost border.
+ *
+ * Parameters:
+ *   uarray2 - the array whose border to fill
+ *   mode    - how the border is filled
+ *
+ * CRE: uarray2 is NULL, or mode is not a UArray2_border value.
+ */
+extern void UArray2_fill_ghosts(T uarray2, UArray2_border mode);
+
+/*
+ * UArray2_base
+ *
+ * Returns the address of element (0, 0) of a row-major array.
+ * Element (col, row) is at
+ * base + row * UArray2_pitch(uarray2) + col * UArray2_size(uarray2)
+ * for every in-bounds (col, row), and, for an array from
+ * UArray2_new_padded, for col and row up to ghost outside them.
+ *
+ * CRE: uarray2 is NULL, sparse, or in Morton order.
+ */
+extern void *UArray2_base(T uarray2);
+
+/*
+ * UArray2_pitch
+ *
+ * Returns the number of bytes from one row of a row-major array
+ * to the next. This is larger than width * size for padded
+ * arrays and for views.
+ *
+ * CRE: uarray2 is NULL, sparse, or in Morton order.
+ */
+extern long UArray2_pitch(T uarray2);
+
+/*
+ * UArray2_elem
+ *
+ * How the bytes of each element are read as a number by
+ * UArray2_integral.
+ */
+typedef enum {
+        UARRAY2_ELEM_U8,      /* unsigned char */
+        UARRAY2_ELEM_U16,     /* uint16_t */
+        UARRAY2_ELEM_I32,     /* int32_t */
+        UARRAY2_ELEM_U32      /* uint32_t */
+} UArray2_elem;
+
+/*
+ * UArray2_integral
+ *
+ * Builds the summed-area table of src: a new (width + 1) by
+ * (height + 1) array of int64_t whose element (col, row) is the
+ * sum of every src element above and to the left of (col, row),
+ * so row 0 and column 0 are zero. Any rectangle sum can then be
+ * read in constant time with UArray2_integral_sum. Large arrays
+ * are built on Pool_shared(), a band of rows per task.
+ *
+ * Parameters:
+ *   src  - the array to sum
+ *   type - how src's elements are read
+ *
+ * Returns: A new UArray2_T of int64_t; the caller frees it.
+ *
+ * CRE: src is NULL, or its element size does not match type.
+ * CRE: memory allocation failure.
+ */
+extern T UArray2_integral(T src, UArray2_elem type);
+
+/*
+ * UArray2_integral_sum
+ *
+ * Returns the sum of the elements in rect of the array whose
+ * summed-area table is integral, using four reads.
+ *
+ * Parameters:
+ *   integral - a table from UArray2_integral or Bit2_integral
+ *   rect     - rectangle of the original array; may be empty
+ *
+ * CRE: integral is NULL or its elements are not int64_t.
+ * CRE: rect does not lie within the original array.
+ */
+extern int64_t UArray2_integral_sum(T integral, UArray2_rect rect);
+
+/*
+ * UArray2_reducefun
+ *
+ * Folds one element into an accumulator for UArray2_reduce.
+ *
+ * Parameters:
+ *   col, row - position of the element
+ *   elem     - read-only pointer to the element
+ *   acc      - the calling thread's private accumulator
+ *   cl       - closure passed through from UArray2_reduce
+ */
+typedef void UArray2_reducefun(int col, int row, const void *elem,
+                               void *acc, void *cl);
+
+/*
+ * UArray2_combinefun
+ *
+ * Folds the accumulator other into acc for UArray2_reduce.
+ */
+typedef void UArray2_combinefun(void *acc, const void *other,
+                                void *cl);
+
+/*
+ * UArray2_reduce
+ *
+ * Folds every element of the array into acc. Large arrays are
+ * split into bands of rows run on Pool_shared(); each thread
+ * starts from its own copy of acc's initial value, folds its
+ * elements into that copy with per_elem, and the copies are
+ * folded into acc with combine at the end. The initial value must
+ * therefore be an identity of combine (0 for a sum, the largest
+ * value for a minimum), and the result must not depend on the
+ * order elements are folded in. per_elem may be called from
+ * several threads at once, each with its own accumulator.
+ *
+ * Parameters:
+ *   uarray2  - the array to reduce
+ *   acc      - initial value on entry, result on return
+ *   acc_size - size in bytes of the accumulator
+ *   combine  - folds one accumulator into another
+ *   per_elem - folds one element into an accumulator
+ *   cl       - closure passed to every call
+ *
+ * CRE: uarray2, acc, combine or per_elem is NULL.
+ * CRE: acc_size <= 0.
+ */
+extern void UArray2_reduce(T uarray2, void *acc, int acc_size,
+                           UArray2_combinefun *combine,
+                           UArray2_reducefun *per_elem, void *cl);
+
+/*
+ * UArray2_sum / UArray2_min / UArray2_max
+ *
+ * Return the sum, smallest or largest of the elements read as
+ * type, computed like UArray2_reduce but with no call per
+ * element.
+ *
+ * CRE: uarray2 is NULL, or its element size does not match type.
+ */
+extern int64_t UArray2_sum(T uarray2, UArray2_elem type);
+extern int64_t UArray2_min(T uarray2, UArray2_elem type);
+extern int64_t UArray2_max(T uarray2, UArray2_elem type);
+
+/*
+ * UArray2_histogram
+ *
+ * Sets counts[v] to the number of elements equal to v, for each
+ * 0 <= v < nbins. Elements outside that range are not counted.
+ * Each thread counts into a private histogram and the histograms
+ * are added at the end.
+ *
+ * Parameters:
+ *   uarray2 - the array to count
+ *   type    - how its elements are read
+ *   counts  - array of nbins counts to fill in
+ *   nbins   - number of bins; must be > 0
+ *
+ * CRE: uarray2 or counts is NULL, or nbins <= 0.
+ * CRE: the element size of uarray2 does not match type.
+ */
+extern void UArray2_histogram(T uarray2, UArray2_elem type,
+                              int64_t *counts, int nbins);
+
+/*
+ * UArray2_gather
+ *
+ * Copies the elements at a list of coordinates into out, so that
+ * out holds the element at coords[i] at out + i * size. All
+ * coordinates are checked once up front. Large batches on large
+ * arrays are visited sorted by row, and elements a few
+ * coordinates ahead are prefetched; on x86-64 processors that
+ * support AVX2 (checked at run time, so no -mavx2 is needed),
+ * 4-byte elements are gathered eight at a time, in the row-sorted
+ * order as well as in the listed one.
+ *
+ * Parameters:
+ *   uarray2 - the array to read
+ *   coords  - n positions within the array, in any order
+ *   n       - number of coordinates; may be 0
+ *   out     - room for n elements
+ *
+ * CRE: uarray2 is NULL, or n < 0.
+ * CRE: n > 0 and coords or out is NULL.
+ * CRE: a coordinate lies outside the array.
+ */
+extern void UArray2_gather(T uarray2, const UArray2_pos *coords, int n,
+                           void *out);
+
+/*
+ * UArray2_scatter
+ *
+ * The reverse of UArray2_gather: stores the element at
+ * in + i * size into the array at coords[i]. If a coordinate
+ * appears more than once, the last of its elements is stored.
+ *
+ * Parameters:
+ *   uarray2 - the array to write
+ *   coords  - n positions within the array, in any order
+ *   n       - number of coordinates; may be 0
+ *   in      - n elements to store
+ *
+ * CRE: uarray2 is NULL, or n < 0.
+ * CRE: n > 0 and coords or in is NULL.
+ * CRE: a coordinate lies outside the array.
+ */
+extern void UArray2_scatter(T uarray2, const UArray2_pos *coords,
+                            int n, const void *in);
+
 #undef T
 #endif
@@ -0,0 +1,106 @@
+/*
+ * uarray2rep.h
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/17/2026
+ *
+ * Purpose: Exposes the representation of UArray2_T, for
+ *          uarray2.c and for hot loops that need element access
+ *          inlined. Clients that only use uarray2.h still see an
+ *          opaque type. UArray2_fast_at and UArray2_fast_get
+ *          behave like UArray2_at and UArray2_get but are static
+ *          inline, so a flat array's element address is computed
+ *          in the caller with no function call.
+ *
+ * Key Insight: The fast accessors check their arguments only
+ *          when REP_DEBUG is defined. Build with -DREP_DEBUG while
+ *          testing to keep the same CREs as UArray2_at, and
+ *          without it in hot loops that already know their
+ *          indices are in bounds.
+ */
+
+#ifndef UARRAY2REP_INCLUDED
+#define UARRAY2REP_INCLUDED
+
+#include <stddef.h>
+#include "uarray2.h"
+#include "uarray.h"
+#include "assert.h"
+
+#ifdef REP_DEBUG
+#define REP_CHECK(e) assert(e)
+#else
+#define REP_CHECK(e) ((void)0)
+#endif
+
+/* How elements are laid out in memory */
+typedef enum {
+        UARRAY2_FLAT,         /* rows at elems + row * stride */
+        UARRAY2_SPARSE,       /* row-major chunks, made on write */
+        UARRAY2_MORTON        /* Z-order, padded to powers of two */
+} UArray2_layout;
+
+#define T UArray2_T
+struct T {
+        int width;
+        int height;
+        int size;
+        long stride;          /* bytes from one row to the next */
+        char *elems;          /* address of element (0, 0) */
+        UArray_T data;        /* owned storage, or NULL if mapped */
+        void *map;            /* start of the mapping, or NULL */
+        size_t map_length;    /* bytes mapped */
+        int map_flags;        /* file map flags; 0: from Pages_map */
+        UArray2_layout layout;
+        char **chunks;        /* sparse: chunks, NULL until written */
+        int nchunks;          /* sparse: number of chunk slots */
+        int chunk_elems;      /* sparse: elements per chunk */
+        char *zero;           /* sparse: one zeroed element for reads */
+        T parent;             /* view: array whose storage is shared */
+        int morton_bits;      /* morton: coordinate bits interleaved */
+        long morton_length;   /* morton: elements incl. padding */
+        int ghost;            /* padded: ghost cells on each side */
+};
+
+/*
+ * UArray2_fast_at
+ *
+ * Same contract as UArray2_at. Flat arrays (including views and
+ * padded arrays) are handled inline; sparse and Morton arrays
+ * fall back to UArray2_at. The CREs are checked only under
+ * REP_DEBUG.
+ */
+static inline void *UArray2_fast_at(T uarray2, int col, int row)
+{
+        REP_CHECK(uarray2 != NULL);
+        REP_CHECK(col >= 0 && col < uarray2->width);
+        REP_CHECK(row >= 0 && row < uarray2->height);
+
+        if (uarray2->layout != UARRAY2_FLAT) {
+                return UArray2_at(uarray2, col, row);
+        }
+        return uarray2->elems + row * uarray2->stride +
+               (long)col * uarray2->size;
+}
+
+/*
+ * UArray2_fast_get
+ *
+ * Same contract as UArray2_get; inline like UArray2_fast_at.
+ */
+static inline const void *UArray2_fast_get(T uarray2, int col,
+                                           int row)
+{
+        REP_CHECK(uarray2 != NULL);
+        REP_CHECK(col >= 0 && col < uarray2->width);
+        REP_CHECK(row >= 0 && row < uarray2->height);
+
+        if (uarray2->layout != UARRAY2_FLAT) {
+                return UArray2_get(uarray2, col, row);
+        }
+        return uarray2->elems + row * uarray2->stride +
+               (long)col * uarray2->size;
+}
+
+#undef T
+#endif
@@ -0,0 +1,292 @@
+/*
+ * uarray2soa.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/17/2026
+ *
+ * Purpose: Implements UArray2soa_T as one UArray2 plane per field
+ *          plus a copy of the field list.
+ *
+ * Key Insight: Gathering a struct is one small memcpy per field
+ *          from the same (col, row) of every plane, addressed from
+ *          each plane's base and pitch, so the whole-struct
+ *          interface costs nfields copies each way per element,
+ *          while single-field passes over a plane pay nothing for
+ *          the fields they ignore.
+ */
+
+#include <string.h>
+#include "uarray2soa.h"
+#include "assert.h"
+#include "mem.h"
+
+#define T UArray2soa_T
+struct T {
+        int width;
+        int height;
+        int size;             /* bytes in the whole struct */
+        int nfields;
+        UArray2soa_field *fields;
+        UArray2_T *planes;    /* plane i holds fields[i] */
+        char **bases;         /* element (0, 0) of each plane */
+        long *pitches;        /* bytes between rows of each plane */
+        char *temp;           /* gathered struct for UArray2soa_at */
+};
+
+/*
+ * name: check_fields
+ *
+ * description: Checks that every field lies inside a size-byte
+ * struct and that no two fields overlap.
+ *
+ * CRE: a field has size <= 0, lies outside the struct, or
+ *      overlaps another field.
+ */
+static void check_fields(int size, const UArray2soa_field *fields,
+                         int nfields)
+{
+        for (int i = 0; i < nfields; i++) {
+                assert(fields[i].size > 0);
+                assert(fields[i].offset >= 0);
+                assert(fields[i].offset <= size - fields[i].size);
+                for (int j = 0; j < i; j++) {
+                        assert(fields[i].offset + fields[i].size <=
+                               fields[j].offset ||
+                               fields[j].offset + fields[j].size <=
+                               fields[i].offset);
+                }
+        }
+}
+
+/*
+ * UArray2soa_new - see uarray2soa.h for contract
+ */
+T UArray2soa_new(int width, int height, int size,
+                 const UArray2soa_field *fields, int nfields)
+{
+        assert(width > 0);
+        assert(height > 0);
+        assert(size > 0);
+        assert(fields != NULL);
+        assert(nfields > 0);
+        check_fields(size, fields, nfields);
+
+        T soa;
+        NEW(soa);
+        soa->width   = width;
+        soa->height  = height;
+        soa->size    = size;
+        soa->nfields = nfields;
+        soa->fields  = ALLOC(nfields * (long)sizeof(UArray2soa_field));
+        soa->planes  = ALLOC(nfields * (long)sizeof(UArray2_T));
+        soa->bases   = ALLOC(nfields * (long)sizeof(char *));
+        soa->pitches = ALLOC(nfields * (long)sizeof(long));
+        soa->temp    = CALLOC(1, size);
+        memcpy(soa->fields, fields,
+               nfields * sizeof(UArray2soa_field));
+        for (int i = 0; i < nfields; i++) {
+                soa->planes[i]  = UArray2_new(width, height,
+                                              fields[i].size);
+                soa->bases[i]   = UArray2_base(soa->planes[i]);
+                soa->pitches[i] = UArray2_pitch(soa->planes[i]);
+        }
+        return soa;
+}
+
+/*
+ * UArray2soa_free - see uarray2soa.h for contract
+ */
+void UArray2soa_free(T *soa)
+{
+        assert(soa != NULL);
+        assert(*soa != NULL);
+
+        for (int i = 0; i < (*soa)->nfields; i++) {
+                UArray2_free(&(*soa)->planes[i]);
+        }
+        FREE((*soa)->planes);
+        FREE((*soa)->bases);
+        FREE((*soa)->pitches);
+        FREE((*soa)->fields);
+        FREE((*soa)->temp);
+        FREE(*soa);
+}
+
+/*
+ * UArray2soa_width - see uarray2soa.h for contract
+ */
+int UArray2soa_width(T soa)
+{
+        assert(soa != NULL);
+        return soa->width;
+}
+
+/*
+ * UArray2soa_height - see uarray2soa.h for contract
+ */
+int UArray2soa_height(T soa)
+{
+        assert(soa != NULL);
+        return soa->height;
+}
+
+/*
+ * UArray2soa_size - see uarray2soa.h for contract
+ */
+int UArray2soa_size(T soa)
+{
+        assert(soa != NULL);
+        return soa->size;
+}
+
+/*
+ * UArray2soa_nfields - see uarray2soa.h for contract
+ */
+int UArray2soa_nfields(T soa)
+{
+        assert(soa != NULL);
+        return soa->nfields;
+}
+
+/*
+ * UArray2soa_plane - see uarray2soa.h for contract
+ */
+UArray2_T UArray2soa_plane(T soa, int field)
+{
+        assert(soa != NULL);
+        assert(field >= 0 && field < soa->nfields);
+        return soa->planes[field];
+}
+
+/*
+ * UArray2soa_row - see uarray2soa.h for contract
+ */
+void *UArray2soa_row(T soa, int field, int row)
+{
+        assert(soa != NULL);
+        assert(field >= 0 && field < soa->nfields);
+        assert(row >= 0 && row < soa->height);
+
+        return soa->bases[field] + row * soa->pitches[field];
+}
+
+/*
+ * name: field_at
+ *
+ * description: Returns the address of field i of element
+ * (col, row) from the plane's base and pitch, unchecked.
+ */
+static inline char *field_at(T soa, int i, int col, int row)
+{
+        return soa->bases[i] + row * soa->pitches[i] +
+               (long)col * soa->fields[i].size;
+}
+
+/*
+ * name: gather
+ *
+ * description: Copies every field of element (col, row) from the
+ * planes into the struct at elem, unchecked.
+ */
+static inline void gather(T soa, int col, int row, char *elem)
+{
+        for (int i = 0; i < soa->nfields; i++) {
+                memcpy(elem + soa->fields[i].offset,
+                       field_at(soa, i, col, row),
+                       soa->fields[i].size);
+        }
+}
+
+/*
+ * name: scatter
+ *
+ * description: Copies every field of the struct at elem into
+ * element (col, row) of the planes, unchecked.
+ */
+static inline void scatter(T soa, int col, int row, const char *elem)
+{
+        for (int i = 0; i < soa->nfields; i++) {
+                memcpy(field_at(soa, i, col, row),
+                       elem + soa->fields[i].offset,
+                       soa->fields[i].size);
+        }
+}
+
+/*
+ * UArray2soa_get - see uarray2soa.h for contract
+ */
+void UArray2soa_get(T soa, int col, int row, void *elem)
+{
+        assert(soa != NULL);
+        assert(elem != NULL);
+        assert(col >= 0 && col < soa->width);
+        assert(row >= 0 && row < soa->height);
+
+        gather(soa, col, row, elem);
+}
+
+/*
+ * UArray2soa_put - see uarray2soa.h for contract
+ */
+void UArray2soa_put(T soa, int col, int row, const void *elem)
+{
+        assert(soa != NULL);
+        assert(elem != NULL);
+        assert(col >= 0 && col < soa->width);
+        assert(row >= 0 && row < soa->height);
+
+        scatter(soa, col, row, elem);
+}
+
+/*
+ * UArray2soa_at - see uarray2soa.h for contract
+ */
+const void *UArray2soa_at(T soa, int col, int row)
+{
+        assert(soa != NULL);
+        assert(col >= 0 && col < soa->width);
+        assert(row >= 0 && row < soa->height);
+
+        gather(soa, col, row, soa->temp);
+        return soa->temp;
+}
+
+/*
+ * UArray2soa_map_row_major - see uarray2soa.h for contract
+ */
+void UArray2soa_map_row_major(T soa, UArray2soa_applyfun *apply,
+                              void *cl)
+{
+        assert(soa != NULL);
+        assert(apply != NULL);
+
+        char *elem = CALLOC(1, soa->size);
+        for (int row = 0; row < soa->height; row++) {
+                for (int col = 0; col < soa->width; col++) {
+                        gather(soa, col, row, elem);
+                        apply(col, row, soa, elem, cl);
+                        scatter(soa, col, row, elem);
+                }
+        }
+        FREE(elem);
+}
+
+/*
+ * UArray2soa_map_col_major - see uarray2soa.h for contract
+ */
+void UArray2soa_map_col_major(T soa, UArray2soa_applyfun *apply,
+                              void *cl)
+{
+        assert(soa != NULL);
+        assert(apply != NULL);
+
+        char *elem = CALLOC(1, soa->size);
+        for (int col = 0; col < soa->width; col++) {
+                for (int row = 0; row < soa->height; row++) {
+                        gather(soa, col, row, elem);
+                        apply(col, row, soa, elem, cl);
+                        scatter(soa, col, row, elem);
+                }
+        }
+        FREE(elem);
+}
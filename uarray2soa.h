@@ -0,0 +1,177 @@
+/*
+ * uarray2soa.h
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/17/2026
+ *
+ * Purpose: Defines UArray2soa, a 2D array of struct elements
+ *          stored as a structure of arrays. The caller describes
+ *          the struct's fields with a list of (offset, size)
+ *          pairs, and each field is kept in its own plane, an
+ *          ordinary UArray2_T of that field's size. A pass that
+ *          reads one field uses that plane directly, through
+ *          UArray2soa_row or any UArray2 function; code written
+ *          for whole structs can still get, put and map them.
+ *
+ * Key Insight: In a UArray2 of structs {label, dist, flags}, a
+ *          pass over dist alone drags the other fields through
+ *          the cache with it. In its own plane, dist fills every
+ *          cache line it touches, so such a pass moves
+ *          sizeof(struct) / sizeof(dist) times less memory.
+ */
+
+#ifndef UARRAY2SOA_INCLUDED
+#define UARRAY2SOA_INCLUDED
+
+#include "uarray2.h"
+
+#define T UArray2soa_T
+typedef struct T *T;
+
+/*
+ * UArray2soa_field
+ *
+ * One field of the element struct: its offset within the struct
+ * and its size, as given by offsetof and sizeof. Bytes of the
+ * struct covered by no field (padding) are not stored.
+ */
+typedef struct UArray2soa_field {
+        int offset;
+        int size;
+} UArray2soa_field;
+
+/*
+ * UArray2soa_new
+ *
+ * Allocates a width-by-height array of size-byte structs whose
+ * nfields fields are described by fields, one zeroed plane per
+ * field. fields is copied, so it need not outlive the call.
+ *
+ * Parameters:
+ *   width   - number of columns; must be > 0
+ *   height  - number of rows; must be > 0
+ *   size    - size of the whole struct; must be > 0
+ *   fields  - the fields, in any order
+ *   nfields - number of fields; must be > 0
+ *
+ * Returns: A new UArray2soa_T, freed with UArray2soa_free.
+ *
+ * CRE: width, height, size or nfields <= 0, or fields is NULL.
+ * CRE: a field has size <= 0, lies outside the struct, or
+ *      overlaps another field.
+ */
+extern T UArray2soa_new(int width, int height, int size,
+                        const UArray2soa_field *fields, int nfields);
+
+/*
+ * UArray2soa_free
+ *
+ * Deallocates *soa and its planes, and sets *soa to NULL.
+ *
+ * CRE: soa is NULL or *soa is NULL.
+ */
+extern void UArray2soa_free(T *soa);
+
+/*
+ * UArray2soa_width, UArray2soa_height, UArray2soa_size,
+ * UArray2soa_nfields
+ *
+ * Return the number of columns, the number of rows, the size of
+ * the whole struct, and the number of fields.
+ *
+ * CRE: soa is NULL.
+ */
+extern int UArray2soa_width(T soa);
+extern int UArray2soa_height(T soa);
+extern int UArray2soa_size(T soa);
+extern int UArray2soa_nfields(T soa);
+
+/*
+ * UArray2soa_plane
+ *
+ * Returns the plane holding field number field (its index in the
+ * list given to UArray2soa_new): a flat UArray2_T whose element
+ * size is the field's size. The plane belongs to soa; use it with
+ * any UArray2 function, but never free it.
+ *
+ * CRE: soa is NULL, or field is not in [0, nfields).
+ */
+extern UArray2_T UArray2soa_plane(T soa, int field);
+
+/*
+ * UArray2soa_row
+ *
+ * Returns the address of field number field of element (0, row).
+ * The same field of elements (1, row) .. (width - 1, row) follows
+ * it contiguously, one field size apart, so a loop over a row of
+ * one field is a plain array scan.
+ *
+ * CRE: soa is NULL, field is not in [0, nfields), or row is out
+ *      of bounds.
+ */
+extern void *UArray2soa_row(T soa, int field, int row);
+
+/*
+ * UArray2soa_get
+ *
+ * Gathers element (col, row) from the planes into the struct at
+ * elem. Padding bytes of elem are left as they were.
+ *
+ * CRE: soa or elem is NULL, or (col, row) is out of bounds.
+ */
+extern void UArray2soa_get(T soa, int col, int row, void *elem);
+
+/*
+ * UArray2soa_put
+ *
+ * Scatters the struct at elem into the planes as element
+ * (col, row).
+ *
+ * CRE: soa or elem is NULL, or (col, row) is out of bounds.
+ */
+extern void UArray2soa_put(T soa, int col, int row, const void *elem);
+
+/*
+ * UArray2soa_at
+ *
+ * Compatibility accessor for code written against UArray2_at:
+ * gathers element (col, row) into a temporary struct owned by soa
+ * and returns its address, with padding bytes zero. The temporary
+ * is overwritten by the next call on soa and writes to it are not
+ * stored; use UArray2soa_put to change an element.
+ *
+ * CRE: soa is NULL, or (col, row) is out of bounds.
+ */
+extern const void *UArray2soa_at(T soa, int col, int row);
+
+/*
+ * UArray2soa_applyfun
+ *
+ * Apply function for the UArray2soa maps. elem points to a
+ * gathered copy of element (col, row) that apply may change.
+ */
+typedef void UArray2soa_applyfun(int col, int row, T soa, void *elem,
+                                 void *cl);
+
+/*
+ * UArray2soa_map_row_major, UArray2soa_map_col_major
+ *
+ * Call apply for every element, in row-major or column-major
+ * order, as the UArray2 maps do. Each element is gathered into a
+ * temporary struct before the call and scattered back after it,
+ * so code written for an array of structs works unchanged. That
+ * moves every field of every element twice, so these maps are
+ * slower than a UArray2 map over an array of the same structs;
+ * they are for porting whole-struct code. A pass that reads or
+ * writes only some fields must walk those fields' planes with
+ * UArray2soa_row or UArray2soa_plane instead.
+ *
+ * CRE: soa or apply is NULL.
+ */
+extern void UArray2soa_map_row_major(T soa, UArray2soa_applyfun *apply,
+                                     void *cl);
+extern void UArray2soa_map_col_major(T soa, UArray2soa_applyfun *apply,
+                                     void *cl);
+
+#undef T
+#endif
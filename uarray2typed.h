@@ -0,0 +1,180 @@
+/*
+ * uarray2typed.h
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/17/2026
+ *
+ * Purpose: Generates type-specialized front ends for UArray2.
+ *          DECLARE_UARRAY2(name, type) defines static inline
+ *          functions name_new, name_at, name_get, name_set,
+ *          name_row, name_map_row_major and name_map_col_major
+ *          (plus unchecked name_fast_* accessors) that take and
+ *          return type instead of void *. The
+ *          arrays they work on are ordinary UArray2_Ts, so typed
+ *          and untyped calls can be mixed freely on one array.
+ *          Instances for int, uint8_t, uint16_t, float and double
+ *          are declared at the bottom of this file.
+ *
+ * Key Insight: With the element type known at compile time, a
+ *          loop over name_row(array, row)[col] is plain array
+ *          indexing with no size multiplication and no call per
+ *          element, which the compiler can unroll and vectorize.
+ *          The typed accessors and maps are inline too, so a
+ *          static apply function can be inlined into them.
+ */
+
+#ifndef UARRAY2TYPED_INCLUDED
+#define UARRAY2TYPED_INCLUDED
+
+#include <stdint.h>
+#include "assert.h"
+#include "uarray2rep.h"
+
+/*
+ * DECLARE_UARRAY2
+ *
+ * Declares the typed front end name_* for elements of type type.
+ * Use it at most once per name in a translation unit.
+ *
+ *   name_new(width, height)
+ *           UArray2_new(width, height, sizeof(type)).
+ *   name_at(array, col, row)
+ *           type * to element (col, row); as UArray2_at.
+ *   name_get(array, col, row)
+ *           value of element (col, row); as UArray2_get.
+ *   name_set(array, col, row, value)
+ *           stores value at element (col, row).
+ *   name_row(array, row)
+ *           type * to element (0, row); elements (0 .. width - 1,
+ *           row) follow it contiguously.
+ *   name_fast_at, name_fast_get, name_fast_set, name_fast_row
+ *           the same, unchecked: built on the inline accessors of
+ *           uarray2rep.h, they check their CREs only when
+ *           REP_DEBUG is defined. For hot loops whose indices are
+ *           already known to be in bounds.
+ *   name_applyfun
+ *           apply function type taking a type * element.
+ *   name_map_row_major(array, apply, cl)
+ *   name_map_col_major(array, apply, cl)
+ *           call apply for every element, as the UArray2 maps do.
+ *
+ * CRE (every function): array is NULL, or its element size is not
+ *      sizeof(type).
+ * CRE (name_row and the maps): array is sparse or in Morton
+ *      order, or row is out of bounds.
+ * CRE (name_at, name_get, name_set): as for UArray2_at.
+ *
+ * All of these are checked in every build, so name_at is a
+ * drop-in replacement for UArray2_at; only the name_fast_*
+ * functions leave their checks to REP_DEBUG.
+ */
+#define DECLARE_UARRAY2(name, type)                                    \
+                                                                       \
+typedef void name##_applyfun(int col, int row, UArray2_T array,        \
+                             type *elem, void *cl);                    \
+                                                                       \
+static inline UArray2_T name##_new(int width, int height)              \
+{                                                                      \
+        return UArray2_new(width, height, sizeof(type));               \
+}                                                                      \
+                                                                       \
+static inline type *name##_at(UArray2_T array, int col, int row)       \
+{                                                                      \
+        assert(array != NULL);                                         \
+        assert(array->size == sizeof(type));                           \
+        assert(col >= 0 && col < array->width);                        \
+        assert(row >= 0 && row < array->height);                       \
+        return (type *)UArray2_fast_at(array, col, row);               \
+}                                                                      \
+                                                                       \
+static inline type name##_get(UArray2_T array, int col, int row)       \
+{                                                                      \
+        assert(array != NULL);                                         \
+        assert(array->size == sizeof(type));                           \
+        assert(col >= 0 && col < array->width);                        \
+        assert(row >= 0 && row < array->height);                       \
+        return *(const type *)UArray2_fast_get(array, col, row);       \
+}                                                                      \
+                                                                       \
+static inline void name##_set(UArray2_T array, int col, int row,       \
+                              type value)                              \
+{                                                                      \
+        *name##_at(array, col, row) = value;                           \
+}                                                                      \
+                                                                       \
+static inline type *name##_row(UArray2_T array, int row)               \
+{                                                                      \
+        assert(array != NULL);                                         \
+        assert(array->layout == UARRAY2_FLAT);                         \
+        assert(array->size == sizeof(type));                           \
+        assert(row >= 0 && row < array->height);                       \
+        return (type *)(array->elems + row * array->stride);           \
+}                                                                      \
+                                                                       \
+static inline type *name##_fast_at(UArray2_T array, int col, int row)  \
+{                                                                      \
+        REP_CHECK(array->size == sizeof(type));                        \
+        return (type *)UArray2_fast_at(array, col, row);               \
+}                                                                      \
+                                                                       \
+static inline type name##_fast_get(UArray2_T array, int col, int row)  \
+{                                                                      \
+        REP_CHECK(array->size == sizeof(type));                        \
+        return *(const type *)UArray2_fast_get(array, col, row);       \
+}                                                                      \
+                                                                       \
+static inline void name##_fast_set(UArray2_T array, int col, int row,  \
+                                   type value)                         \
+{                                                                      \
+        *name##_fast_at(array, col, row) = value;                      \
+}                                                                      \
+                                                                       \
+static inline type *name##_fast_row(UArray2_T array, int row)          \
+{                                                                      \
+        REP_CHECK(array->layout == UARRAY2_FLAT);                      \
+        REP_CHECK(array->size == sizeof(type));                        \
+        REP_CHECK(row >= 0 && row < array->height);                    \
+        return (type *)(array->elems + row * array->stride);           \
+}                                                                      \
+                                                                       \
+static inline void name##_map_row_major(UArray2_T array,               \
+                                        name##_applyfun *apply,        \
+                                        void *cl)                      \
+{                                                                      \
+        int width  = UArray2_width(array);                             \
+        int height = UArray2_height(array);                            \
+        assert(apply != NULL);                                         \
+        for (int row = 0; row < height; row++) {                       \
+                type *line = name##_row(array, row);                   \
+                for (int col = 0; col < width; col++) {                \
+                        apply(col, row, array, &line[col], cl);        \
+                }                                                      \
+        }                                                              \
+}                                                                      \
+                                                                       \
+static inline void name##_map_col_major(UArray2_T array,               \
+                                        name##_applyfun *apply,        \
+                                        void *cl)                      \
+{                                                                      \
+        int width  = UArray2_width(array);                             \
+        int height = UArray2_height(array);                            \
+        assert(apply != NULL);                                         \
+        assert(UArray2_size(array) == sizeof(type));                   \
+        char *base = UArray2_base(array);                              \
+        long pitch = UArray2_pitch(array);                             \
+        for (int col = 0; col < width; col++) {                        \
+                char *elem = base + col * (long)sizeof(type);          \
+                for (int row = 0; row < height; row++) {               \
+                        apply(col, row, array, (type *)elem, cl);      \
+                        elem += pitch;                                 \
+                }                                                      \
+        }                                                              \
+}
+
+DECLARE_UARRAY2(UArray2_int, int)
+DECLARE_UARRAY2(UArray2_u8, uint8_t)
+DECLARE_UARRAY2(UArray2_u16, uint16_t)
+DECLARE_UARRAY2(UArray2_float, float)
+DECLARE_UARRAY2(UArray2_double, double)
+
+#endif
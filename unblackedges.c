@@ -9,36 +9,55 @@
  *          is connected to the image border through other black
  *          pixels via 4-connected neighbors. Outputs a plain P1
  *          PBM file with those edge pixels turned white (0).
+ *          With --despeckle=K, interior black components smaller
+ *          than K pixels are also turned white. With --mask,
+ *          the pixels turned white are written out as a P4 mask
+ *          or run-length span list.
  *
  * Key Insight: We seed a BFS queue with all black border pixels,
  *          then iteratively spread inward through 4-connected
  *          black neighbors, turning each to white. Using BFS
  *          (not recursive DFS) avoids stack overflow on large
- *          images.
+ *          images. Despeckling labels each component once
+ *          instead, deciding from its area and whether it
+ *          reaches the border.
  */
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <limits.h>
+#include <string.h>
 #include "pnmrdr.h"
 #include "assert.h"
-#include "bit2.h"
+#include "cursor.h"
+#include "tiledges.h"
+#include "pipeline.h"
 #include "mem.h"
 
+#define PIPELINE_DEPTH 4   /* pages waiting between batch stages */
+#define MAX_THREADS 64     /* most threads per batch stage */
+
 /*
- * Queue node storing a single (col, row) coordinate pair.
+ * A single (col, row) pixel coordinate.
  */
-typedef struct Node {
+typedef struct Point {
         int col;
         int row;
-        struct Node *next;
-} Node;
+} Point;
 
 /*
- * Simple linked-list queue for BFS traversal.
+ * Array-backed queue for BFS traversal. A retaining queue keeps
+ * dequeued items until Queue_reset, so after a flood fill drains
+ * it, items[0 .. length) holds every pixel of the component and
+ * length is its area. A non-retaining queue slides live items
+ * down instead, so its storage tracks the BFS frontier only.
  */
 typedef struct Queue {
-        Node *front;
-        Node *rear;
+        Point *items;
+        int head;       /* index of next item to dequeue */
+        int length;     /* number of items enqueued since reset */
+        int capacity;   /* number of slots allocated in items */
+        int retain;     /* 1 if dequeued items must be kept */
 } Queue;
 
 /*
@@ -49,19 +68,22 @@ typedef struct Queue {
  * for freeing the queue by calling Queue_free.
  *
  * Parameters:
- *   none
+ *   retain - 1 to keep dequeued items until Queue_reset, else 0
  *
  * Returns:
  *   A pointer to a newly allocated empty queue
  *
  * CRE: Memory allocation fails (program will crash).
  */
-static Queue *Queue_new(void)
+static Queue *Queue_new(int retain)
 {
         Queue *q;
         NEW(q);
-        q->front = NULL;
-        q->rear  = NULL;
+        q->capacity = 64;
+        q->items    = ALLOC(q->capacity * (long)sizeof(Point));
+        q->head     = 0;
+        q->length   = 0;
+        q->retain   = retain;
         return q;
 }
 
@@ -81,15 +103,16 @@ static Queue *Queue_new(void)
  */
 static int Queue_empty(Queue *q)
 {
-        return q->front == NULL;
+        return q->head == q->length;
 }
 
 /*
  * name: Queue_enqueue
  *
  * description: Adds a new position (col, row) to the back of
- * the queue. If the queue is empty, this becomes the first
- * element. Otherwise it is added to the end.
+ * the queue. When storage is full, a non-retaining queue first
+ * slides its live items to the front; otherwise the storage is
+ * doubled.
  *
  * Parameters:
  *   q   - pointer to the queue
@@ -100,22 +123,26 @@ static int Queue_empty(Queue *q)
  *   void
  *
  * CRE: q is NULL.
+ * CRE: The capacity would pass INT_MAX items.
  * CRE: Memory allocation fails (program will crash).
  */
 static void Queue_enqueue(Queue *q, int col, int row)
 {
-        Node *n;
-        NEW(n);
-        n->col  = col;
-        n->row  = row;
-        n->next = NULL;
-
-        if (q->rear != NULL) {
-                q->rear->next = n;   /* Add to end if exists */
-        } else {
-                q->front = n;        /* Queue was empty */
+        if (q->length == q->capacity && !q->retain &&
+            q->head >= q->capacity / 2) {
+                q->length -= q->head;   /* Drop dequeued items */
+                memmove(q->items, q->items + q->head,
+                        q->length * sizeof(Point));
+                q->head = 0;
+        }
+        if (q->length == q->capacity) {
+                assert(q->capacity <= INT_MAX / 2);
+                q->capacity *= 2;   /* Grow storage geometrically */
+                RESIZE(q->items, q->capacity * (long)sizeof(Point));
         }
-        q->rear = n;
+        q->items[q->length].col = col;
+        q->items[q->length].row = row;
+        q->length++;
 }
 
 /*
@@ -123,7 +150,7 @@ static void Queue_enqueue(Queue *q, int col, int row)
  *
  * description: Removes and returns the first element from the
  * queue. The coordinates are stored in the pointers provided.
- * The removed element is freed from memory.
+ * A retaining queue keeps the item until Queue_reset.
  *
  * Parameters:
  *   q   - pointer to the queue
@@ -140,23 +167,36 @@ static void Queue_dequeue(Queue *q, int *col, int *row)
 {
         assert(!Queue_empty(q));
 
-        Node *n = q->front;
-        *col = n->col;              /* Extract coordinates */
-        *row = n->row;
-        q->front = n->next;
+        *col = q->items[q->head].col;   /* Extract coordinates */
+        *row = q->items[q->head].row;
+        q->head++;
+}
 
-        if (q->front == NULL) {
-                q->rear = NULL;     /* Queue is now empty */
-        }
-        FREE(n);
+/*
+ * name: Queue_reset
+ *
+ * description: Empties the queue and forgets every item enqueued
+ * so far, keeping the allocated storage for reuse.
+ *
+ * Parameters:
+ *   q - pointer to the queue to reset
+ *
+ * Returns:
+ *   void
+ *
+ * CRE: q is NULL.
+ */
+static void Queue_reset(Queue *q)
+{
+        q->head   = 0;
+        q->length = 0;
 }
 
 /*
  * name: Queue_free
  *
- * description: Frees all memory used by the queue. All remaining
- * elements are removed and deleted, then the queue structure
- * itself is deleted.
+ * description: Frees all memory used by the queue, including any
+ * items still stored in it.
  *
  * Parameters:
  *   q - pointer to the queue to free
@@ -168,13 +208,39 @@ static void Queue_dequeue(Queue *q, int *col, int *row)
  */
 static void Queue_free(Queue *q)
 {
-        while (!Queue_empty(q)) {
-                int c, r;
-                Queue_dequeue(q, &c, &r); /* Remove and free nodes */
-        }
+        FREE(q->items);
         FREE(q);
 }
 
+/*
+ * name: clear_pixel
+ *
+ * description: Turns the pixel at (col, row) white and, when a
+ * removal mask is being kept, records it there. Every pixel the
+ * engine removes goes through here, so the mask is exactly the
+ * set of pixels turned white.
+ *
+ * Parameters:
+ *   bitmap  - the bitmap image
+ *   removed - mask of removed pixels, or NULL if not kept
+ *   col     - column coordinate of the pixel
+ *   row     - row coordinate of the pixel
+ *
+ * Returns:
+ *   void
+ *
+ * CRE: bitmap is NULL.
+ * CRE: col or row is out of bounds.
+ */
+static void clear_pixel(Bit2_T bitmap, Bit2_T removed, int col,
+                        int row)
+{
+        Bit2_fast_put(bitmap, col, row, 0);
+        if (removed != NULL) {
+                Bit2_fast_put(removed, col, row, 1);
+        }
+}
+
 /*
  * name: enqueue_if_black
  *
@@ -184,10 +250,11 @@ static void Queue_free(Queue *q)
  * the queue.
  *
  * Parameters:
- *   q      - pointer to the queue
- *   bitmap - the bitmap image
- *   col    - column coordinate to check
- *   row    - row coordinate to check
+ *   q       - pointer to the queue
+ *   bitmap  - the bitmap image
+ *   removed - mask of removed pixels, or NULL if not kept
+ *   col     - column coordinate to check
+ *   row     - row coordinate to check
  *
  * Returns:
  *   void
@@ -195,23 +262,150 @@ static void Queue_free(Queue *q)
  * CRE: q is NULL.
  * CRE: bitmap is NULL.
  */
-static void enqueue_if_black(Queue *q, Bit2_T bitmap,
-                              int col, int row)
+static void enqueue_if_black(Queue *q, Bit2_T bitmap, Bit2_T removed,
+                             int col, int row)
 {
-        int width  = Bit2_width(bitmap);
-        int height = Bit2_height(bitmap);
+        int width  = bitmap->width;
+        int height = bitmap->height;
 
         /* Check if coordinates are valid */
         if (col >= 0 && col < width &&
             row >= 0 && row < height) {
                 /* Check if pixel is black */
-                if (Bit2_get(bitmap, col, row) == 1) {
-                        Bit2_put(bitmap, col, row, 0);
+                if (Bit2_fast_get(bitmap, col, row) == 1) {
+                        clear_pixel(bitmap, removed, col, row);
                         Queue_enqueue(q, col, row);
                 }
         }
 }
 
+/*
+ * name: on_border
+ *
+ * description: Tells whether (col, row) lies in the first or
+ * last row or column of a width by height image.
+ *
+ * Parameters:
+ *   width  - image width in pixels
+ *   height - image height in pixels
+ *   col    - column coordinate
+ *   row    - row coordinate
+ *
+ * Returns:
+ *   1 if the pixel is on the border, else 0
+ *
+ * CRE: none.
+ */
+static int on_border(int width, int height, int col, int row)
+{
+        return col == 0 || row == 0 ||
+               col == width - 1 || row == height - 1;
+}
+
+/*
+ * name: enqueue_unvisited
+ *
+ * description: Adds (col, row) to the queue if it is in bounds,
+ * black and not yet visited, and marks it visited. Unlike
+ * enqueue_if_black it leaves the pixel black, so a component
+ * that is kept never has to be restored.
+ *
+ * Parameters:
+ *   q       - pointer to the queue
+ *   bitmap  - the bitmap image
+ *   visited - bitmap the size of bitmap marking queued pixels
+ *   col     - column coordinate to check
+ *   row     - row coordinate to check
+ *
+ * Returns:
+ *   void
+ *
+ * CRE: q, bitmap or visited is NULL.
+ */
+static void enqueue_unvisited(Queue *q, Bit2_T bitmap, Bit2_T visited,
+                              int col, int row)
+{
+        if (col >= 0 && col < bitmap->width &&
+            row >= 0 && row < bitmap->height &&
+            Bit2_fast_get(bitmap, col, row) == 1 &&
+            Bit2_fast_get(visited, col, row) == 0) {
+                Bit2_fast_put(visited, col, row, 1);
+                Queue_enqueue(q, col, row);
+        }
+}
+
+/*
+ * name: remove_components
+ *
+ * description: Labels every black component in one raster scan
+ * and turns white each one that touches the border or has fewer
+ * than min_area pixels; used in place of the border flood when
+ * despeckling. Pixels are marked in a separate visited bitmap as
+ * the BFS reaches them, so each pixel is queued once however
+ * large its component, and the retaining queue keeps the
+ * component's pixels, which gives its area. Once the walk ends,
+ * a component that is not kept is cleared through clear_pixel.
+ *
+ * Parameters:
+ *   bitmap   - the bitmap image to process
+ *   removed  - mask of removed pixels, or NULL if not kept
+ *   min_area - smallest interior component size to keep
+ *
+ * Returns:
+ *   void
+ *
+ * CRE: bitmap is NULL.
+ * CRE: min_area < 1.
+ * CRE: memory allocation failure.
+ */
+static void remove_components(Bit2_T bitmap, Bit2_T removed,
+                              int min_area)
+{
+        assert(min_area >= 1);
+
+        int width      = Bit2_width(bitmap);
+        int height     = Bit2_height(bitmap);
+        Bit2_T visited = Bit2_new(width, height);
+        Queue *q       = Queue_new(1);
+
+        for (int row = 0; row < height; row++) {
+                for (int col = 0; col < width; col++) {
+                        Queue_reset(q);
+                        enqueue_unvisited(q, bitmap, visited, col, row);
+                        int border = 0;
+
+                        /* Walk the whole component */
+                        while (!Queue_empty(q)) {
+                                int c, r;
+                                Queue_dequeue(q, &c, &r);
+                                border |= on_border(width, height,
+                                                    c, r);
+                                enqueue_unvisited(q, bitmap, visited,
+                                                  c - 1, r);
+                                enqueue_unvisited(q, bitmap, visited,
+                                                  c + 1, r);
+                                enqueue_unvisited(q, bitmap, visited,
+                                                  c, r - 1);
+                                enqueue_unvisited(q, bitmap, visited,
+                                                  c, r + 1);
+                        }
+
+                        /* Queue lists every pixel of the component */
+                        if (!border && q->length >= min_area) {
+                                continue;
+                        }
+                        for (int i = 0; i < q->length; i++) {
+                                clear_pixel(bitmap, removed,
+                                            q->items[i].col,
+                                            q->items[i].row);
+                        }
+                }
+        }
+
+        Queue_free(q);
+        Bit2_free(&visited);
+}
+
 /*
  * name: remove_black_edges
  *
@@ -219,111 +413,675 @@ static void enqueue_if_black(Queue *q, Bit2_T bitmap,
  * border. Starting from black pixels on all four edges, it
  * spreads inward through neighbors that are also black, turning
  * each to white. Black regions completely surrounded by white
- * pixels are left unchanged.
+ * pixels are left unchanged, unless despeckling is requested and
+ * they are smaller than the despeckle threshold; then a single
+ * labeling pass (remove_components) does both jobs.
  *
  * Parameters:
- *   bitmap - the bitmap image to process
+ *   bitmap    - the bitmap image to process
+ *   removed   - if not NULL, a bitmap of the same size in which
+ *               every pixel turned white is set to 1
+ *   despeckle - remove interior components with fewer than this
+ *               many pixels; 0 keeps every interior component
  *
  * Returns:
  *   void
  *
  * CRE: bitmap is NULL.
  * CRE: bitmap width or height is less than 1.
+ * CRE: despeckle < 0.
  */
-static void remove_black_edges(Bit2_T bitmap)
+static void remove_black_edges(Bit2_T bitmap, Bit2_T removed,
+                               int despeckle)
 {
+        assert(despeckle >= 0);
+
+        if (despeckle > 0) {
+                remove_components(bitmap, removed, despeckle);
+                return;
+        }
+
         int width  = Bit2_width(bitmap);
         int height = Bit2_height(bitmap);
-        Queue *q   = Queue_new();
+        Queue *q   = Queue_new(0);
 
         /* Add black pixels from all four edges to queue */
         for (int col = 0; col < width; col++) {
-                enqueue_if_black(q, bitmap, col, 0);
-                enqueue_if_black(q, bitmap, col, height - 1);
+                enqueue_if_black(q, bitmap, removed, col, 0);
+                enqueue_if_black(q, bitmap, removed, col, height - 1);
         }
         for (int row = 1; row < height - 1; row++) {
-                enqueue_if_black(q, bitmap, 0, row);
-                enqueue_if_black(q, bitmap, width - 1, row);
+                enqueue_if_black(q, bitmap, removed, 0, row);
+                enqueue_if_black(q, bitmap, removed, width - 1, row);
         }
 
         /* Spread to neighbors left, right, up, down */
         while (!Queue_empty(q)) {
                 int col, row;
                 Queue_dequeue(q, &col, &row);
-                enqueue_if_black(q, bitmap, col - 1, row);
-                enqueue_if_black(q, bitmap, col + 1, row);
-                enqueue_if_black(q, bitmap, col, row - 1);
-                enqueue_if_black(q, bitmap, col, row + 1);
+                enqueue_if_black(q, bitmap, removed, col - 1, row);
+                enqueue_if_black(q, bitmap, removed, col + 1, row);
+                enqueue_if_black(q, bitmap, removed, col, row - 1);
+                enqueue_if_black(q, bitmap, removed, col, row + 1);
         }
 
         Queue_free(q);
 }
 
+/*
+ * name: parse_despeckle
+ *
+ * description: Parses the value of a --despeckle=K option.
+ *
+ * Parameters:
+ *   text - the characters after "--despeckle="
+ *
+ * Returns:
+ *   K, or -1 if text is not a non-negative decimal integer
+ *
+ * CRE: text is NULL.
+ */
+static int parse_despeckle(const char *text)
+{
+        char *end;
+        long value = strtol(text, &end, 10);
+
+        if (end == text || *end != '\0' || value < 0 ||
+            value > INT_MAX) {
+                return -1;
+        }
+        return (int)value;
+}
+
+/*
+ * name: read_bitmap
+ *
+ * description: Reads every pixel of a PBM image into a new
+ * bitmap. The caller frees the bitmap with Bit2_free.
+ *
+ * Parameters:
+ *   reader - reader positioned at the first pixel
+ *
+ * Returns:
+ *   a new bitmap holding the image
+ *
+ * CRE: reader is NULL.
+ * CRE: the image is not a PBM or has a zero dimension.
+ */
+static Bit2_T read_bitmap(Pnmrdr_T reader)
+{
+        Pnmrdr_mapdata data = Pnmrdr_data(reader);
+
+        assert(data.type == Pnmrdr_bit);
+        assert(data.width > 0);
+        assert(data.height > 0);
+
+        /* Create bitmap to hold all pixels */
+        Bit2_T bitmap = Bit2_new((int)data.width,
+                                  (int)data.height);
+
+        /* Read and store all pixels from input */
+        Bit2_cursor c;
+        for (Bit2_cursor_begin(&c, bitmap, CURSOR_ROW_MAJOR);
+             Bit2_cursor_valid(&c); Bit2_cursor_next(&c)) {
+                int pixel = Pnmrdr_get(reader);
+                assert(pixel == 0 || pixel == 1);
+                Bit2_cursor_put(&c, pixel);
+        }
+        return bitmap;
+}
+
 /*
  * name: print_pbm
  *
- * description: Outputs the bitmap to the screen in plain PBM
- * format (P1). Each row of pixels is printed on its own line,
- * with pixel values separated by spaces.
+ * description: Outputs the bitmap in plain PBM format (P1). Each
+ * row of pixels is printed on its own line, with pixel values
+ * separated by spaces.
  *
  * Parameters:
+ *   out    - stream to write to
  *   bitmap - the bitmap image to print
  *
  * Returns:
  *   void
  *
- * CRE: bitmap is NULL.
+ * CRE: out or bitmap is NULL.
  */
-static void print_pbm(Bit2_T bitmap)
+static void print_pbm(FILE *out, Bit2_T bitmap)
 {
         int width  = Bit2_width(bitmap);
         int height = Bit2_height(bitmap);
 
-        printf("P1\n");             /* P1 is plain PBM format */
-        printf("%d %d\n", width, height);
+        fprintf(out, "P1\n");       /* P1 is plain PBM format */
+        fprintf(out, "%d %d\n", width, height);
+
+        Bit2_cursor c;
+        for (Bit2_cursor_begin(&c, bitmap, CURSOR_ROW_MAJOR);
+             Bit2_cursor_valid(&c); Bit2_cursor_next(&c)) {
+                if (c.col > 0) {
+                        putc(' ', out); /* Space between bits */
+                }
+                putc('0' + Bit2_cursor_get(&c), out);
+                if (c.col == width - 1) {
+                        putc('\n', out);
+                }
+        }
+}
+
+/*
+ * name: parse_budget
+ *
+ * description: Parses the value of a --tile-budget=BYTES option:
+ * a positive decimal byte count with an optional k, m or g
+ * suffix (powers of 1024).
+ *
+ * Parameters:
+ *   text - the characters after "--tile-budget="
+ *
+ * Returns:
+ *   the budget in bytes, or -1 if text is malformed
+ *
+ * CRE: text is NULL.
+ */
+static long parse_budget(const char *text)
+{
+        char *end;
+        long value = strtol(text, &end, 10);
+        int shift = 0;
+
+        switch (*end) {
+        case 'k': case 'K': shift = 10; end++; break;
+        case 'm': case 'M': shift = 20; end++; break;
+        case 'g': case 'G': shift = 30; end++; break;
+        default: break;
+        }
+        if (end == text || *end != '\0' || value <= 0 ||
+            value > (LONG_MAX >> shift)) {
+                return -1;
+        }
+        return value << shift;
+}
+
+/*
+ * name: write_mask_pbm
+ *
+ * description: Writes the removal mask as a raw PBM (P4) image:
+ * a 1 bit marks a pixel that was turned white. Rows are packed
+ * eight pixels per byte, most significant bit first, and padded
+ * to a whole byte.
+ *
+ * Parameters:
+ *   out     - stream to write to
+ *   removed - mask of removed pixels
+ *
+ * Returns:
+ *   void
+ *
+ * CRE: out or removed is NULL.
+ */
+static void write_mask_pbm(FILE *out, Bit2_T removed)
+{
+        int width  = Bit2_width(removed);
+        int height = Bit2_height(removed);
+
+        fprintf(out, "P4\n%d %d\n", width, height);
 
         for (int row = 0; row < height; row++) {
+                int byte = 0;
                 for (int col = 0; col < width; col++) {
-                        if (col > 0) {
-                                printf(" "); /* Space between bits */
+                        byte = (byte << 1) |
+                               Bit2_get(removed, col, row);
+                        if (col % 8 == 7) {
+                                putc(byte, out);
+                                byte = 0;
                         }
-                        printf("%d", Bit2_get(bitmap, col, row));
                 }
-                printf("\n");
+                if (width % 8 != 0) {
+                        /* Pad the last byte of the row with 0s */
+                        putc(byte << (8 - width % 8), out);
+                }
         }
 }
 
+/*
+ * name: write_mask_rle
+ *
+ * description: Writes the removal mask as a run-length list. The
+ * first line holds the image width and height; each following
+ * line is one horizontal span of removed pixels as
+ * "row start length", in row-major order.
+ *
+ * Parameters:
+ *   out     - stream to write to
+ *   removed - mask of removed pixels
+ *
+ * Returns:
+ *   void
+ *
+ * CRE: out or removed is NULL.
+ */
+static void write_mask_rle(FILE *out, Bit2_T removed)
+{
+        int width  = Bit2_width(removed);
+        int height = Bit2_height(removed);
+
+        fprintf(out, "%d %d\n", width, height);
+
+        for (int row = 0; row < height; row++) {
+                int col = 0;
+                while (col < width) {
+                        if (Bit2_get(removed, col, row) == 0) {
+                                col++;
+                                continue;
+                        }
+                        int start = col;
+                        while (col < width &&
+                               Bit2_get(removed, col, row) == 1) {
+                                col++;
+                        }
+                        fprintf(out, "%d %d %d\n", row, start,
+                                col - start);
+                }
+        }
+}
+
+/*
+ * name: write_mask
+ *
+ * description: Writes the removal mask to path in the requested
+ * format. A path of "-" writes to standard output.
+ *
+ * Parameters:
+ *   path    - file to create, or "-" for standard output
+ *   rle     - 1 for the run-length list, 0 for a P4 bitmap
+ *   removed - mask of removed pixels
+ *
+ * Returns:
+ *   void
+ *
+ * CRE: path or removed is NULL.
+ * CRE: path cannot be opened for writing.
+ */
+static void write_mask(const char *path, int rle, Bit2_T removed)
+{
+        FILE *out = stdout;
+
+        if (strcmp(path, "-") != 0) {
+                out = fopen(path, "wb");
+                assert(out != NULL);
+        }
+
+        if (rle) {
+                write_mask_rle(out, removed);
+        } else {
+                write_mask_pbm(out, removed);
+        }
+
+        if (out != stdout) {
+                fclose(out);
+        }
+}
+
+/*
+ * One page of a batch run as it moves through the pipeline.
+ */
+typedef struct Page {
+        int index;          /* position in the batch's input list */
+        Bit2_T bitmap;
+} Page;
+
+/*
+ * Settings shared by every page of a batch run.
+ */
+typedef struct Batch {
+        char **inputs;      /* input file names */
+        const char *outdir; /* directory the outputs are written to */
+        int despeckle;      /* as for remove_black_edges */
+} Batch;
+
+/*
+ * name: batch_read
+ *
+ * description: Pipeline reader stage: loads input file index.
+ *
+ * CRE: the file cannot be opened or is not a valid PBM image.
+ */
+static void *batch_read(int index, void *cl)
+{
+        Batch *batch = cl;
+        FILE *fp = fopen(batch->inputs[index], "rb");
+        assert(fp != NULL);
+
+        Pnmrdr_T reader = Pnmrdr_new(fp);
+        Page *page;
+        NEW(page);
+        page->index  = index;
+        page->bitmap = read_bitmap(reader);
+
+        Pnmrdr_free(&reader);
+        fclose(fp);
+        return page;
+}
+
+/*
+ * name: batch_work
+ *
+ * description: Pipeline worker stage: cleans one page.
+ */
+static void batch_work(void *item, void *cl)
+{
+        Batch *batch = cl;
+        Page *page = item;
+
+        remove_black_edges(page->bitmap, NULL, batch->despeckle);
+}
+
+/*
+ * name: base_name
+ *
+ * description: Returns the part of path after its last '/', the
+ * name a batch run writes the page under in its output directory.
+ *
+ * Parameters:
+ *   path - a file name
+ *
+ * Returns:
+ *   A pointer into path
+ *
+ * CRE: path is NULL.
+ */
+static const char *base_name(const char *path)
+{
+        const char *slash = strrchr(path, '/');
+        return slash != NULL ? slash + 1 : path;
+}
+
+/*
+ * name: compare_names
+ *
+ * description: qsort comparison of two base names, by strcmp.
+ */
+static int compare_names(const void *a, const void *b)
+{
+        return strcmp(*(const char *const *)a,
+                      *(const char *const *)b);
+}
+
+/*
+ * name: duplicate_base
+ *
+ * description: Finds a base name shared by two batch inputs, whose
+ * outputs would overwrite each other. Sorts a copy of the base
+ * names and compares neighbors.
+ *
+ * Parameters:
+ *   inputs  - input file names
+ *   ninputs - number of input file names
+ *
+ * Returns:
+ *   A repeated base name (pointing into inputs), or NULL if all
+ *   base names differ
+ *
+ * CRE: inputs is NULL while ninputs > 0.
+ */
+static const char *duplicate_base(char **inputs, int ninputs)
+{
+        if (ninputs < 2) {
+                return NULL;
+        }
+
+        const char **bases = ALLOC(ninputs * (long)sizeof(char *));
+        for (int i = 0; i < ninputs; i++) {
+                bases[i] = base_name(inputs[i]);
+        }
+        qsort(bases, ninputs, sizeof(char *), compare_names);
+
+        const char *found = NULL;
+        for (int i = 1; i < ninputs && found == NULL; i++) {
+                if (strcmp(bases[i - 1], bases[i]) == 0) {
+                        found = bases[i];
+                }
+        }
+        FREE(bases);
+        return found;
+}
+
+/*
+ * name: batch_write
+ *
+ * description: Pipeline writer stage: prints one page to the
+ * file of the same base name in the output directory, then
+ * frees the page.
+ *
+ * CRE: the output file cannot be created.
+ */
+static void batch_write(void *item, void *cl)
+{
+        Batch *batch = cl;
+        Page *page = item;
+        const char *base = base_name(batch->inputs[page->index]);
+        char *path = ALLOC(strlen(batch->outdir) + strlen(base) + 2);
+        sprintf(path, "%s/%s", batch->outdir, base);
+
+        FILE *out = fopen(path, "wb");
+        assert(out != NULL);
+        print_pbm(out, page->bitmap);
+        fclose(out);
+
+        FREE(path);
+        Bit2_free(&page->bitmap);
+        FREE(page);
+}
+
+/*
+ * name: print_stats
+ *
+ * description: Reports a batch run's throughput and how busy
+ * each pipeline stage was, to stderr. The stage closest to 100%
+ * is the one limiting throughput.
+ */
+static void print_stats(Pipeline_stats *stats)
+{
+        static const char *names[PIPELINE_STAGES] = {
+                "read", "work", "write"
+        };
+
+        fprintf(stderr, "%d pages in %.3f s (%.1f pages/s)\n",
+                stats->items, stats->wall,
+                stats->wall > 0 ? stats->items / stats->wall : 0.0);
+        for (int s = 0; s < PIPELINE_STAGES; s++) {
+                double capacity = stats->wall * stats->threads[s];
+                fprintf(stderr, "  %-5s %2d thread(s) busy %.3f s "
+                        "utilization %5.1f%%\n", names[s],
+                        stats->threads[s], stats->busy[s],
+                        capacity > 0 ? 100 * stats->busy[s] / capacity
+                                     : 0.0);
+        }
+}
+
+/*
+ * name: parse_threads
+ *
+ * description: Parses the value of a --threads=R,W,X option: the
+ * number of reader, worker and writer threads.
+ *
+ * Parameters:
+ *   text    - the characters after "--threads="
+ *   threads - filled in with the three counts
+ *
+ * Returns:
+ *   1 on success, 0 if text is malformed
+ *
+ * CRE: text or threads is NULL.
+ */
+static int parse_threads(const char *text, int threads[PIPELINE_STAGES])
+{
+        for (int s = 0; s < PIPELINE_STAGES; s++) {
+                char *end;
+                long value = strtol(text, &end, 10);
+                char sep = s < PIPELINE_STAGES - 1 ? ',' : '\0';
+
+                if (end == text || *end != sep || value < 1 ||
+                    value > MAX_THREADS) {
+                        return 0;
+                }
+                threads[s] = (int)value;
+                text = end + 1;
+        }
+        return 1;
+}
+
+/*
+ * name: usage
+ *
+ * description: Prints the command-line synopsis to stderr.
+ *
+ * Parameters:
+ *   progname - name the program was invoked as (argv[0])
+ *
+ * Returns:
+ *   EXIT_FAILURE, so callers can return it from main
+ */
+static int usage(const char *progname)
+{
+        fprintf(stderr, "Usage: %s [--despeckle=K] [--mask=PATH "
+                "[--mask-format=pbm|rle]] [filename]\n"
+                "       %s --tile-budget=BYTES[k|m|g] [filename]\n"
+                "       %s --batch=OUTDIR [--despeckle=K] "
+                "[--threads=R,W,X] [--stats] file...\n",
+                progname, progname, progname);
+        return EXIT_FAILURE;
+}
+
 /*
  * name: main
  *
  * description: Reads a bitmap image and removes black pixels
  * connected to the image borders. The image is read from a file
- * (if a filename is provided) or from standard input. After
- * processing, the result is printed as a plain PBM image.
+ * (if a filename is provided) or from standard input. With
+ * --despeckle=K, interior black components of fewer than K pixels
+ * are removed in the same pass. After processing, the result is
+ * printed as a plain PBM image. With --mask=PATH, the set of
+ * pixels turned white is also written to PATH, as a P4 bitmap or
+ * (with --mask-format=rle) a run-length span list; a PATH of "-"
+ * sends the mask to stdout in place of the image. With
+ * --tile-budget=BYTES, the image never lives in memory as a
+ * whole; it is processed in disk-backed tiles (see tiledges.h).
+ * With --batch=OUTDIR, every named file is cleaned and written
+ * under the same name in OUTDIR, through a pipeline of R reader,
+ * W worker and X writer threads (--threads=R,W,X); --stats
+ * reports how busy each stage was. Two inputs with the same base
+ * name are an error, since one output would overwrite the other.
  *
  * Parameters:
- *   argc - number of command-line arguments (must be 1 or 2)
- *   argv - array of command-line arguments (optional filename)
+ *   argc - number of command-line arguments
+ *   argv - array of command-line arguments: options, then an
+ *          optional filename (or, with --batch, any number)
  *
  * Returns:
  *   EXIT_SUCCESS if image is processed successfully,
- *   EXIT_FAILURE if arguments are invalid
+ *   EXIT_FAILURE if arguments are invalid (including --threads
+ *   or --stats without --batch)
  *
- * CRE: more than 1 command-line argument provided.
  * CRE: file cannot be opened for reading.
  * CRE: input is not a valid PBM image.
  */
 int main(int argc, char *argv[])
 {
         FILE *fp = NULL;
+        const char *filename = NULL;
+        int despeckle = 0;
+        const char *mask_path = NULL;
+        int mask_rle = 0;
+        int mask_format = 0;
+        long tile_budget = 0;
+        const char *batch_dir = NULL;
+        int threads[PIPELINE_STAGES] = { 1, 2, 1 };
+        int stats = 0;
+        int ninputs = 0;
+        char **inputs = ALLOC(argc * (long)sizeof(char *));
+
+        /* Collect options and filenames */
+        int valid = 1;
+        int batch_only = 0;     /* --threads or --stats seen */
+        for (int i = 1; i < argc && valid; i++) {
+                if (strncmp(argv[i], "--despeckle=", 12) == 0) {
+                        despeckle = parse_despeckle(argv[i] + 12);
+                        valid = despeckle >= 0;
+                } else if (strncmp(argv[i], "--mask=", 7) == 0 &&
+                           argv[i][7] != '\0') {
+                        mask_path = argv[i] + 7;
+                } else if (strcmp(argv[i], "--mask-format=pbm") == 0) {
+                        mask_rle = 0;
+                        mask_format = 1;
+                } else if (strcmp(argv[i], "--mask-format=rle") == 0) {
+                        mask_rle = 1;
+                        mask_format = 1;
+                } else if (strncmp(argv[i], "--tile-budget=",
+                                   14) == 0) {
+                        tile_budget = parse_budget(argv[i] + 14);
+                        valid = tile_budget > 0;
+                } else if (strncmp(argv[i], "--batch=", 8) == 0 &&
+                           argv[i][8] != '\0') {
+                        batch_dir = argv[i] + 8;
+                } else if (strncmp(argv[i], "--threads=", 10) == 0) {
+                        valid = parse_threads(argv[i] + 10, threads);
+                        batch_only = 1;
+                } else if (strcmp(argv[i], "--stats") == 0) {
+                        stats = 1;
+                        batch_only = 1;
+                } else {
+                        inputs[ninputs++] = argv[i];
+                }
+        }
+
+        /* A mask format means nothing without a mask */
+        if (mask_format && mask_path == NULL) {
+                valid = 0;
+        }
+
+        /* Batch runs overlap reading, cleaning and writing pages */
+        if (batch_dir != NULL) {
+                const char *twice = duplicate_base(inputs, ninputs);
+                if (twice != NULL) {
+                        fprintf(stderr, "%s: more than one input "
+                                "would be written to %s/%s\n",
+                                argv[0], batch_dir, twice);
+                        FREE(inputs);
+                        return EXIT_FAILURE;
+                }
+                if (mask_path != NULL || tile_budget > 0) {
+                        valid = 0;
+                }
+                if (valid) {
+                        Batch batch = { inputs, batch_dir, despeckle };
+                        Pipeline_stats timing;
+                        Pipeline_run(ninputs, batch_read, batch_work,
+                                     batch_write, &batch, threads,
+                                     PIPELINE_DEPTH, &timing);
+                        if (stats) {
+                                print_stats(&timing);
+                        }
+                }
+                FREE(inputs);
+                return valid ? EXIT_SUCCESS : usage(argv[0]);
+        }
+
+        /* Otherwise at most one filename and no batch options */
+        filename = ninputs == 1 ? inputs[0] : NULL;
+        FREE(inputs);
+        if (!valid || ninputs > 1 || batch_only) {
+                return usage(argv[0]);
+        }
+
+        /* The tiled engine only removes border components */
+        if (tile_budget > 0 && (despeckle > 0 || mask_path != NULL)) {
+                return usage(argv[0]);
+        }
 
         /* Open file for reading if provided, else use stdin */
-        if (argc > 2) {
-                fprintf(stderr, "Usage: %s [filename]\n",
-                        argv[0]);
-                return EXIT_FAILURE;
-        } else if (argc == 2) {
-                fp = fopen(argv[1], "rb");
+        if (filename != NULL) {
+                fp = fopen(filename, "rb");
                 assert(fp != NULL);
         } else {
                 fp = stdin;
@@ -337,21 +1095,33 @@ int main(int argc, char *argv[])
         assert(data.width > 0);
         assert(data.height > 0);
 
-        /* Create bitmap to hold all pixels */
-        Bit2_T bitmap = Bit2_new((int)data.width,
-                                  (int)data.height);
-
-        /* Read and store all pixels from input */
-        for (int row = 0; row < (int)data.height; row++) {
-                for (int col = 0; col < (int)data.width; col++) {
-                        int pixel = Pnmrdr_get(reader);
-                        Bit2_put(bitmap, col, row, pixel);
+        /* Huge images go through disk-backed tiles instead */
+        if (tile_budget > 0) {
+                Tiledges_remove(reader, stdout, tile_budget);
+                Pnmrdr_free(&reader);
+                if (fp != stdin) {
+                        fclose(fp);
                 }
+                return EXIT_SUCCESS;
+        }
+
+        Bit2_T bitmap = read_bitmap(reader);
+
+        /* Only track removed pixels if the mask is wanted */
+        Bit2_T removed = NULL;
+        if (mask_path != NULL) {
+                removed = Bit2_new((int)data.width, (int)data.height);
         }
 
-        /* Process image and output */
-        remove_black_edges(bitmap);
-        print_pbm(bitmap);
+        /* Process image and output; a mask on stdout replaces it */
+        remove_black_edges(bitmap, removed, despeckle);
+        if (mask_path == NULL || strcmp(mask_path, "-") != 0) {
+                print_pbm(stdout, bitmap);
+        }
+        if (removed != NULL) {
+                write_mask(mask_path, mask_rle, removed);
+                Bit2_free(&removed);
+        }
 
         /* Free all memory and close files */
         Pnmrdr_free(&reader);
@@ -361,4 +1131,4 @@ int main(int argc, char *argv[])
         }
 
         return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
@@ -0,0 +1,213 @@
+/*
+ * useblit.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/17/2026
+ *
+ * Purpose: Checks the bulk operations UArray2_fill, UArray2_copy,
+ *          UArray2_blit and UArray2_swap_rows against a plain C
+ *          array holding the same elements. Blits run between two
+ *          arrays, within one array in every direction of overlap,
+ *          and between overlapping views of one parent, on flat
+ *          and Morton-ordered arrays.
+ *
+ * Key Insight: A blit must behave as if the rectangle were first
+ *          copied to a scratch buffer, so the model does exactly
+ *          that; an overlapping blit that walks its rows or
+ *          elements in the wrong direction reads elements it has
+ *          already overwritten and disagrees with the model.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <uarray2.h>
+
+#define W 23
+#define H 17
+
+/*
+ * name: load
+ *
+ * description: Sets element (col, row) of a and model[row][col]
+ * to seed + 1000 * row + col.
+ */
+static void load(UArray2_T a, int model[H][W], int seed)
+{
+        for (int row = 0; row < H; row++) {
+                for (int col = 0; col < W; col++) {
+                        model[row][col] = seed + 1000 * row + col;
+                        *(int *)UArray2_at(a, col, row) =
+                                model[row][col];
+                }
+        }
+}
+
+/*
+ * name: same
+ *
+ * description: Returns whether a and model hold the same elements.
+ */
+static bool same(UArray2_T a, int model[H][W])
+{
+        bool ok = true;
+        for (int row = 0; row < H; row++) {
+                for (int col = 0; col < W; col++) {
+                        ok &= *(int *)UArray2_at(a, col, row) ==
+                              model[row][col];
+                }
+        }
+        return ok;
+}
+
+/*
+ * name: model_blit
+ *
+ * description: Blits rect of from into to at (dx, dy) through a
+ * scratch copy, the behaviour UArray2_blit promises.
+ */
+static void model_blit(int to[H][W], int dx, int dy, int from[H][W],
+                       UArray2_rect rect)
+{
+        static int scratch[H][W];
+        for (int r = 0; r < rect.height; r++) {
+                for (int c = 0; c < rect.width; c++) {
+                        scratch[r][c] =
+                                from[rect.row + r][rect.col + c];
+                }
+        }
+        for (int r = 0; r < rect.height; r++) {
+                for (int c = 0; c < rect.width; c++) {
+                        to[dy + r][dx + c] = scratch[r][c];
+                }
+        }
+}
+
+/*
+ * name: new_array
+ *
+ * description: Returns a new W by H array of ints, Morton-ordered
+ * if morton is set.
+ */
+static UArray2_T new_array(bool morton)
+{
+        return morton ? UArray2_new_morton(W, H, sizeof(int))
+                      : UArray2_new(W, H, sizeof(int));
+}
+
+/*
+ * name: check_arrays
+ *
+ * description: Checks fill, copy, swap_rows and blits between and
+ * within arrays of one layout.
+ */
+static bool check_arrays(bool morton)
+{
+        static int ma[H][W], mb[H][W];
+        UArray2_T a = new_array(morton);
+        UArray2_T b = new_array(morton);
+        bool ok = true;
+
+        int seven = 7;
+        UArray2_fill(a, &seven);
+        for (int row = 0; row < H; row++) {
+                for (int col = 0; col < W; col++) {
+                        ma[row][col] = 7;
+                }
+        }
+        ok &= same(a, ma);
+
+        load(b, mb, 1);
+        UArray2_copy(a, b);
+        ok &= same(a, mb);
+
+        UArray2_swap_rows(a, 2, 9);
+        UArray2_swap_rows(a, 4, 4);
+        load(b, mb, 1);
+        memcpy(ma, mb, sizeof(ma));
+        memcpy(ma[2], mb[9], sizeof(ma[2]));
+        memcpy(ma[9], mb[2], sizeof(ma[9]));
+        ok &= same(a, ma);
+
+        /* Between two arrays, including an empty rectangle */
+        UArray2_rect rect = { 3, 2, 8, 6 };
+        UArray2_rect empty = { 5, 5, 0, 4 };
+        load(a, ma, 0);
+        UArray2_blit(a, 14, 10, b, rect);
+        UArray2_blit(a, 0, 0, b, empty);
+        model_blit(ma, 14, 10, mb, rect);
+        ok &= same(a, ma);
+
+        /* Within one array, shifted every way */
+        for (int dr = -2; dr <= 2; dr++) {
+                for (int dc = -2; dc <= 2; dc++) {
+                        UArray2_rect mid = { 4, 4, 12, 8 };
+                        load(a, ma, 0);
+                        UArray2_blit(a, 4 + dc, 4 + dr, a, mid);
+                        model_blit(ma, 4 + dc, 4 + dr, ma, mid);
+                        if (!same(a, ma)) {
+                                printf("FAIL overlap %d %d layout "
+                                       "%d\n", dc, dr, morton);
+                                ok = false;
+                        }
+                }
+        }
+
+        UArray2_free(&b);
+        UArray2_free(&a);
+        return ok;
+}
+
+/*
+ * name: check_views
+ *
+ * description: Blits between two overlapping views of one flat
+ * array, in both directions.
+ */
+static bool check_views(void)
+{
+        static int model[H][W];
+        UArray2_T parent = UArray2_new(W, H, sizeof(int));
+        UArray2_T left   = UArray2_view(parent, 0, 0, 15, 12);
+        UArray2_T right  = UArray2_view(parent, 3, 2, 15, 12);
+        UArray2_rect rect = { 1, 1, 12, 9 };
+        bool ok = true;
+
+        load(parent, model, 0);
+        UArray2_blit(right, 1, 1, left, rect);
+        model_blit(model, 4, 3, model,
+                   (UArray2_rect){ 1, 1, 12, 9 });
+        ok &= same(parent, model);
+
+        load(parent, model, 0);
+        UArray2_blit(left, 1, 1, right, rect);
+        model_blit(model, 1, 1, model,
+                   (UArray2_rect){ 4, 3, 12, 9 });
+        ok &= same(parent, model);
+
+        UArray2_free(&right);
+        UArray2_free(&left);
+        UArray2_free(&parent);
+        return ok;
+}
+
+int main(void)
+{
+        bool ok = true;
+
+        for (int morton = 0; morton <= 1; morton++) {
+                if (!check_arrays(morton)) {
+                        printf("FAIL arrays layout %d\n", morton);
+                        ok = false;
+                }
+        }
+        if (!check_views()) {
+                printf("FAIL views\n");
+                ok = false;
+        }
+
+        printf("The blits are %sOK!\n", ok ? "" : "NOT ");
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,259 @@
+/*
+ * useconvert.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/17/2026
+ *
+ * Purpose: Checks the conversions of bit2conv.h. For graymaps of
+ *          every element type, of widths on both sides of the
+ *          16-element SIMD runs and the 64-bit words, in flat and
+ *          Morton layouts, checks UArray2_to_Bit2 with every
+ *          comparison against thresholds inside and outside the
+ *          type's range, then expands the bitmap back with
+ *          Bit2_to_UArray2 and counts it with Bit2_count. Also
+ *          checks that UArray2_otsu splits a two-valued graymap
+ *          between its values.
+ *
+ * Key Insight: Every bit and element is compared with the same
+ *          comparison done one element at a time, so the packed,
+ *          SIMD and banded paths must all agree with the obvious
+ *          loop.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <bit2conv.h>
+
+/*
+ * name: type_size
+ *
+ * description: Returns the size in bytes of an element of type.
+ */
+static int type_size(UArray2_elem type)
+{
+        return type == UARRAY2_ELEM_U8 ? 1
+             : type == UARRAY2_ELEM_U16 ? 2 : 4;
+}
+
+/*
+ * name: type_max
+ *
+ * description: Returns the largest value of type.
+ */
+static int64_t type_max(UArray2_elem type)
+{
+        switch (type) {
+        case UARRAY2_ELEM_U8:  return UINT8_MAX;
+        case UARRAY2_ELEM_U16: return UINT16_MAX;
+        case UARRAY2_ELEM_I32: return INT32_MAX;
+        default:               return UINT32_MAX;
+        }
+}
+
+/*
+ * name: get_elem
+ *
+ * description: Returns element (col, row) of a read as type.
+ */
+static int64_t get_elem(UArray2_T a, int col, int row,
+                        UArray2_elem type)
+{
+        const void *p = UArray2_get(a, col, row);
+        switch (type) {
+        case UARRAY2_ELEM_U8:  return *(const uint8_t *)p;
+        case UARRAY2_ELEM_U16: return *(const uint16_t *)p;
+        case UARRAY2_ELEM_I32: return *(const int32_t *)p;
+        default:               return *(const uint32_t *)p;
+        }
+}
+
+/*
+ * name: put_elem
+ *
+ * description: Stores value as type in element (col, row) of a.
+ */
+static void put_elem(UArray2_T a, int col, int row, UArray2_elem type,
+                     int64_t value)
+{
+        void *p = UArray2_at(a, col, row);
+        switch (type) {
+        case UARRAY2_ELEM_U8:  *(uint8_t *)p = value;  break;
+        case UARRAY2_ELEM_U16: *(uint16_t *)p = value; break;
+        case UARRAY2_ELEM_I32: *(int32_t *)p = value;  break;
+        default:               *(uint32_t *)p = value; break;
+        }
+}
+
+/*
+ * name: holds
+ *
+ * description: Returns whether "value op threshold" holds.
+ */
+static bool holds(int64_t value, Bit2_compare op, int64_t threshold)
+{
+        switch (op) {
+        case BIT2_LT: return value <  threshold;
+        case BIT2_LE: return value <= threshold;
+        case BIT2_GT: return value >  threshold;
+        case BIT2_GE: return value >= threshold;
+        case BIT2_EQ: return value == threshold;
+        default:      return value != threshold;
+        }
+}
+
+/*
+ * name: make_graymap
+ *
+ * description: Returns a new graymap of type whose elements come
+ * from a fixed pseudo-random sequence, with every sixth element
+ * set to 7 so that equality comparisons see matches.
+ */
+static UArray2_T make_graymap(int width, int height, UArray2_elem type,
+                              bool morton)
+{
+        int size = type_size(type);
+        UArray2_T a = morton ? UArray2_new_morton(width, height, size)
+                             : UArray2_new(width, height, size);
+        uint32_t seed = 12345;
+
+        for (int row = 0; row < height; row++) {
+                for (int col = 0; col < width; col++) {
+                        seed = seed * 1103515245u + 12345u;
+                        int64_t v = (seed >> 8) % (type_max(type) + 1);
+                        if ((row * width + col) % 6 == 0) {
+                                v = 7;
+                        }
+                        if (type == UARRAY2_ELEM_I32 && seed % 3 == 0) {
+                                v = -v;
+                        }
+                        put_elem(a, col, row, type, v);
+                }
+        }
+        return a;
+}
+
+/*
+ * name: check_threshold
+ *
+ * description: Converts a with op and threshold, and checks every
+ * bit, the bit count, and the expansion back to a graymap.
+ */
+static bool check_threshold(UArray2_T a, UArray2_elem type,
+                            Bit2_compare op, int64_t threshold)
+{
+        int width  = UArray2_width(a);
+        int height = UArray2_height(a);
+        Bit2_T bits = UArray2_to_Bit2(a, type, op, threshold);
+        UArray2_T back = Bit2_to_UArray2(bits, type, 3,
+                                         type_max(type));
+        long ones = 0;
+        bool ok = Bit2_width(bits) == width &&
+                  Bit2_height(bits) == height;
+
+        for (int row = 0; row < height && ok; row++) {
+                for (int col = 0; col < width; col++) {
+                        int bit = holds(get_elem(a, col, row, type),
+                                        op, threshold);
+                        ones += bit;
+                        ok &= Bit2_get(bits, col, row) == bit;
+                        ok &= get_elem(back, col, row, type) ==
+                              (bit ? type_max(type) : 3);
+                }
+        }
+        ok &= Bit2_count(bits) == ones;
+
+        Bit2_free(&bits);
+        UArray2_free(&back);
+        return ok;
+}
+
+/*
+ * name: check_otsu
+ *
+ * description: Checks that UArray2_otsu puts the threshold of a
+ * graymap holding only the values 20 and 200 between them, and
+ * returns the value of a constant graymap.
+ */
+static bool check_otsu(void)
+{
+        UArray2_T a = UArray2_new(50, 20, 1);
+        for (int row = 0; row < 20; row++) {
+                for (int col = 0; col < 50; col++) {
+                        put_elem(a, col, row, UARRAY2_ELEM_U8,
+                                 col < 15 ? 20 : 200);
+                }
+        }
+        int64_t split = UArray2_otsu(a, UARRAY2_ELEM_U8);
+        bool ok = split >= 20 && split < 200;
+
+        UArray2_fill(a, &(uint8_t){ 90 });
+        ok &= UArray2_otsu(a, UARRAY2_ELEM_U8) == 90;
+        UArray2_free(&a);
+        return ok;
+}
+
+/*
+ * name: check_graymap
+ *
+ * description: Checks every comparison against thresholds below,
+ * inside and above the range of type on one graymap, printing
+ * each failure.
+ */
+static bool check_graymap(int width, int height, UArray2_elem type,
+                          bool morton)
+{
+        UArray2_T a = make_graymap(width, height, type, morton);
+        int64_t max = type_max(type);
+        int64_t thresholds[] = { -1, 0, 7, max / 2, max, max + 1 };
+        bool ok = true;
+
+        for (int i = 0; i < 6; i++) {
+                for (int op = BIT2_LT; op <= BIT2_NE; op++) {
+                        if (check_threshold(a, type, op,
+                                            thresholds[i])) {
+                                continue;
+                        }
+                        printf("FAIL %dx%d size %d layout %d op %d "
+                               "threshold %lld\n", width, height,
+                               type_size(type), morton, op,
+                               (long long)thresholds[i]);
+                        ok = false;
+                }
+        }
+        UArray2_free(&a);
+        return ok;
+}
+
+int main(void)
+{
+        static const int shapes[][2] = {
+                { 1, 1 }, { 15, 2 }, { 16, 3 }, { 17, 1 }, { 63, 2 },
+                { 64, 2 }, { 65, 3 }, { 130, 2 }, { 300, 260 }
+        };
+        static const UArray2_elem types[] = {
+                UARRAY2_ELEM_U8, UARRAY2_ELEM_U16, UARRAY2_ELEM_I32,
+                UARRAY2_ELEM_U32
+        };
+        int nshapes = sizeof(shapes) / sizeof(shapes[0]);
+        bool ok = true;
+
+        for (int s = 0; s < nshapes; s++) {
+                for (int t = 0; t < 4; t++) {
+                        for (int morton = 0; morton <= 1; morton++) {
+                                ok &= check_graymap(shapes[s][0],
+                                                    shapes[s][1],
+                                                    types[t], morton);
+                        }
+                }
+        }
+        if (!check_otsu()) {
+                printf("FAIL otsu\n");
+                ok = false;
+        }
+
+        printf("The conversions are %sOK!\n", ok ? "" : "NOT ");
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,251 @@
+/*
+ * usecursor.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/18/2026
+ *
+ * Purpose: Checks the cursors of cursor.h in all three orders.
+ *          UArray2 cursors over flat, padded, view, Morton and
+ *          sparse arrays, and Bit2 cursors over bitmaps of widths
+ *          around a 64-bit word, must visit every position once,
+ *          in the order a plain reference loop gives, including
+ *          tiled walks whose tiles do not divide the array (so the
+ *          right and bottom tiles are smaller) or are larger than
+ *          it. Each UArray2 cursor's element must be UArray2_at's,
+ *          and each Bit2 cursor must read and write the right bit.
+ *
+ * Key Insight: Every Bit2 walk flips each bit as it goes and must
+ *          leave the exact complement behind, so a mask or word
+ *          pointer stepped wrongly across a word boundary, or down
+ *          a column, is caught even if the positions are right.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <cursor.h>
+#include <uarray2.h>
+#include <bit2.h>
+
+#define NORDERS 6           /* row, column, and four tile sizes */
+
+/*
+ * name: reference
+ *
+ * description: Fills order with the positions of a width by
+ * height walk, as col, row pairs: row-major for tile 0,
+ * column-major for tile -1, and tiled with tile-sized tiles
+ * otherwise.
+ */
+static void reference(int *order, int width, int height, int tile)
+{
+        long n = 0;
+
+        if (tile == 0) {
+                /* One tile covering the array is a row-major walk */
+                tile = width > height ? width : height;
+        }
+        if (tile < 0) {
+                for (int col = 0; col < width; col++) {
+                        for (int row = 0; row < height; row++) {
+                                order[n++] = col;
+                                order[n++] = row;
+                        }
+                }
+                return;
+        }
+        for (int row0 = 0; row0 < height; row0 += tile) {
+                for (int col0 = 0; col0 < width; col0 += tile) {
+                        for (int row = row0;
+                             row < row0 + tile && row < height; row++) {
+                                for (int col = col0;
+                                     col < col0 + tile && col < width;
+                                     col++) {
+                                        order[n++] = col;
+                                        order[n++] = row;
+                                }
+                        }
+                }
+        }
+}
+
+/*
+ * name: uarray2_begin
+ *
+ * description: Starts c on a in the order numbered by tile, as
+ * for reference.
+ */
+static void uarray2_begin(UArray2_cursor *c, UArray2_T a, int tile)
+{
+        if (tile == 0) {
+                UArray2_cursor_begin(c, a, CURSOR_ROW_MAJOR);
+        } else if (tile < 0) {
+                UArray2_cursor_begin(c, a, CURSOR_COL_MAJOR);
+        } else {
+                UArray2_cursor_begin_tiled(c, a, tile);
+        }
+}
+
+/*
+ * name: bit2_begin
+ *
+ * description: Starts c on bits in the order numbered by tile, as
+ * for reference.
+ */
+static void bit2_begin(Bit2_cursor *c, Bit2_T bits, int tile)
+{
+        if (tile == 0) {
+                Bit2_cursor_begin(c, bits, CURSOR_ROW_MAJOR);
+        } else if (tile < 0) {
+                Bit2_cursor_begin(c, bits, CURSOR_COL_MAJOR);
+        } else {
+                Bit2_cursor_begin_tiled(c, bits, tile);
+        }
+}
+
+/*
+ * name: check_uarray2
+ *
+ * description: Walks a with a cursor in the order numbered by
+ * tile and returns whether it visits the reference positions,
+ * each with UArray2_at's element.
+ */
+static bool check_uarray2(UArray2_T a, int tile, const int *order)
+{
+        long length = (long)UArray2_width(a) * UArray2_height(a);
+        long n = 0;
+        bool ok = true;
+        UArray2_cursor c;
+
+        for (uarray2_begin(&c, a, tile); UArray2_cursor_valid(&c);
+             UArray2_cursor_next(&c)) {
+                if (n == length) {
+                        return false;   /* walked past the end */
+                }
+                ok &= c.col == order[2 * n] &&
+                      c.row == order[2 * n + 1] &&
+                      UArray2_cursor_elem(&c) ==
+                      UArray2_at(a, c.col, c.row);
+                n++;
+        }
+        return ok && n == length;
+}
+
+/*
+ * name: check_bit2
+ *
+ * description: Walks bits with a cursor in the order numbered by
+ * tile, flipping each bit, and returns whether it visits the
+ * reference positions, reads each bit right and leaves the
+ * complement of the bitmap.
+ */
+static bool check_bit2(Bit2_T bits, int tile, const int *order)
+{
+        int width   = Bit2_width(bits);
+        int height  = Bit2_height(bits);
+        long length = (long)width * height;
+        Bit2_T before = Bit2_new(width, height);
+        long n = 0;
+        bool ok = true;
+        Bit2_cursor c;
+
+        for (int row = 0; row < height; row++) {
+                for (int col = 0; col < width; col++) {
+                        Bit2_put(before, col, row,
+                                 Bit2_get(bits, col, row));
+                }
+        }
+        for (bit2_begin(&c, bits, tile); Bit2_cursor_valid(&c);
+             Bit2_cursor_next(&c)) {
+                if (n == length) {
+                        ok = false;     /* walked past the end */
+                        break;
+                }
+                int bit = Bit2_get(before, c.col, c.row);
+                ok &= c.col == order[2 * n] &&
+                      c.row == order[2 * n + 1] &&
+                      Bit2_cursor_get(&c) == bit &&
+                      Bit2_cursor_put(&c, !bit) == bit;
+                n++;
+        }
+        ok &= n == length;
+        for (int row = 0; row < height && ok; row++) {
+                for (int col = 0; col < width; col++) {
+                        ok &= Bit2_get(bits, col, row) !=
+                              Bit2_get(before, col, row);
+                }
+        }
+        Bit2_free(&before);
+        return ok;
+}
+
+/*
+ * name: check_shape
+ *
+ * description: Runs every cursor over width by height arrays and
+ * bitmaps in every order, printing each failure.
+ */
+static bool check_shape(int width, int height)
+{
+        static const int tiles[NORDERS] = { 0, -1, 1, 3, 8, 64 };
+        int *order = malloc(2 * (long)width * height * sizeof(int));
+        UArray2_T parent = UArray2_new(width + 5, height + 2, 3);
+        UArray2_T arrays[] = {
+                UArray2_new(width, height, 3),
+                UArray2_new_padded(width, height, 3, 2),
+                UArray2_view(parent, 4, 1, width, height),
+                UArray2_new_morton(width, height, 3),
+                UArray2_new_sparse(width, height, 3)
+        };
+        Bit2_T bits = Bit2_new(width, height);
+        bool ok = true;
+
+        for (int row = 0; row < height; row++) {
+                for (int col = 0; col < width; col++) {
+                        Bit2_put(bits, col, row, rand() % 2);
+                }
+        }
+        for (int t = 0; t < NORDERS; t++) {
+                reference(order, width, height, tiles[t]);
+                for (int i = 0; i < 5; i++) {
+                        if (!check_uarray2(arrays[i], tiles[t],
+                                           order)) {
+                                printf("FAIL %dx%d layout %d tile "
+                                       "%d\n", width, height, i,
+                                       tiles[t]);
+                                ok = false;
+                        }
+                }
+                if (!check_bit2(bits, tiles[t], order)) {
+                        printf("FAIL bitmap %dx%d tile %d\n", width,
+                               height, tiles[t]);
+                        ok = false;
+                }
+        }
+        Bit2_free(&bits);
+        for (int i = 4; i >= 0; i--) {
+                UArray2_free(&arrays[i]);
+        }
+        UArray2_free(&parent);
+        free(order);
+        return ok;
+}
+
+int main(void)
+{
+        static const int shapes[][2] = {
+                { 1, 1 }, { 1, 13 }, { 13, 1 }, { 7, 5 }, { 63, 9 },
+                { 64, 8 }, { 65, 17 }, { 130, 67 }, { 200, 3 }
+        };
+        int nshapes = sizeof(shapes) / sizeof(shapes[0]);
+        bool ok = true;
+
+        srand(68);
+        for (int s = 0; s < nshapes; s++) {
+                ok &= check_shape(shapes[s][0], shapes[s][1]);
+        }
+
+        printf("The cursors are %sOK!\n", ok ? "" : "NOT ");
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
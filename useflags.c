@@ -0,0 +1,254 @@
+/*
+ * useflags.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/18/2026
+ *
+ * Purpose: Checks UArray2_new_flags and Bit2_new_flags with every
+ *          valid combination of flags. Every byte of every element,
+ *          and every bit, must start out zero, including on arrays
+ *          big enough for FIRST_TOUCH to zero them in bands on the
+ *          thread pool and for HUGEPAGE to matter; each new array
+ *          is made after an earlier one of the same size was filled
+ *          and freed, so reused memory would be seen. Written
+ *          elements must read back, and unknown flags and
+ *          POPULATE with FIRST_TOUCH must be checked runtime
+ *          errors.
+ *
+ * Key Insight: The zero check reads every row through UArray2_base
+ *          and UArray2_pitch, and Bit2_count counts whole words, so
+ *          a band of rows the pool skipped, or stray bits past the
+ *          width, are seen.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <uarray2.h>
+#include <bit2.h>
+
+#define NBAD 4              /* bad calls made by bad_call */
+
+/*
+ * name: fill
+ *
+ * description: Apply function storing a nonzero pattern in every
+ * byte of each element.
+ */
+static void fill(int col, int row, UArray2_T a, void *elem, void *cl)
+{
+        (void)cl;
+        for (int i = 0; i < UArray2_size(a); i++) {
+                ((unsigned char *)elem)[i] =
+                        (unsigned char)(col + row * 3 + i) | 1;
+        }
+}
+
+/*
+ * name: is_zero
+ *
+ * description: Returns whether every byte of every element of a
+ * is zero.
+ */
+static bool is_zero(UArray2_T a)
+{
+        const unsigned char *base = UArray2_base(a);
+        long pitch = UArray2_pitch(a);
+        long row_bytes = (long)UArray2_width(a) * UArray2_size(a);
+        bool ok = true;
+
+        for (int row = 0; row < UArray2_height(a); row++) {
+                const unsigned char *line = base + row * pitch;
+                for (long i = 0; i < row_bytes; i++) {
+                        ok &= line[i] == 0;
+                }
+        }
+        return ok;
+}
+
+/*
+ * name: holds_fill
+ *
+ * description: Returns whether a holds the pattern stored by fill.
+ */
+static bool holds_fill(UArray2_T a)
+{
+        const unsigned char *base = UArray2_base(a);
+        long pitch = UArray2_pitch(a);
+        int size = UArray2_size(a);
+        bool ok = true;
+
+        for (int row = 0; row < UArray2_height(a); row++) {
+                const unsigned char *elem = base + row * pitch;
+                for (int col = 0; col < UArray2_width(a); col++) {
+                        for (int i = 0; i < size; i++, elem++) {
+                                ok &= *elem == ((unsigned char)
+                                                (col + row * 3 + i) |
+                                                1);
+                        }
+                }
+        }
+        return ok;
+}
+
+/*
+ * name: check_uarray2
+ *
+ * description: Makes, checks, fills and frees a width by height
+ * array of size-byte elements with flags twice; prints and
+ * returns false on any failure.
+ */
+static bool check_uarray2(int width, int height, int size, int flags)
+{
+        bool ok = true;
+
+        for (int pass = 0; pass < 2; pass++) {
+                UArray2_T a = UArray2_new_flags(width, height, size,
+                                                flags);
+                bool zero = UArray2_width(a) == width &&
+                            UArray2_height(a) == height &&
+                            UArray2_size(a) == size &&
+                            UArray2_pitch(a) >= (long)width * size &&
+                            is_zero(a);
+                UArray2_map_row_major(a, fill, NULL);
+                if (!zero || !holds_fill(a)) {
+                        printf("FAIL %dx%d size %d flags %d pass %d\n",
+                               width, height, size, flags, pass);
+                        ok = false;
+                }
+                UArray2_free(&a);
+        }
+        return ok;
+}
+
+/*
+ * name: check_bit2
+ *
+ * description: Makes, checks, sets and frees a width by height
+ * bitmap with flags twice; prints and returns false on any
+ * failure.
+ */
+static bool check_bit2(int width, int height, int flags)
+{
+        bool ok = true;
+
+        for (int pass = 0; pass < 2; pass++) {
+                Bit2_T bits = Bit2_new_flags(width, height, flags);
+                bool good = Bit2_width(bits) == width &&
+                            Bit2_height(bits) == height &&
+                            Bit2_count(bits) == 0;
+                for (int row = 0; row < height; row++) {
+                        for (int col = 0; col < width; col++) {
+                                good &= Bit2_get(bits, col, row) == 0;
+                                Bit2_put(bits, col, row, 1);
+                        }
+                }
+                good &= Bit2_count(bits) == (long)width * height;
+                if (!good) {
+                        printf("FAIL bitmap %dx%d flags %d pass %d\n",
+                               width, height, flags, pass);
+                        ok = false;
+                }
+                Bit2_free(&bits);
+        }
+        return ok;
+}
+
+/*
+ * name: bad_call
+ *
+ * description: Makes the bad call numbered which, each a checked
+ * runtime error.
+ */
+static void bad_call(int which)
+{
+        switch (which) {
+        case 0:
+                UArray2_new_flags(4, 4, 1, 0x8);
+                break;
+        case 1:
+                UArray2_new_flags(4, 4, 1, UARRAY2_ALLOC_POPULATE |
+                                  UARRAY2_ALLOC_FIRST_TOUCH);
+                break;
+        case 2:
+                Bit2_new_flags(4, 4, 0x10);
+                break;
+        case 3:
+                Bit2_new_flags(4, 4, BIT2_ALLOC_POPULATE |
+                               BIT2_ALLOC_FIRST_TOUCH);
+                break;
+        }
+}
+
+/*
+ * name: dies
+ *
+ * description: Makes bad call which in a child process, with its
+ * standard error discarded, and returns whether the child was
+ * killed by a signal rather than exiting.
+ */
+static bool dies(int which)
+{
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0) {
+                if (freopen("/dev/null", "w", stderr) == NULL) {
+                        _exit(0);
+                }
+                bad_call(which);
+                _exit(0);
+        }
+        int status;
+        if (pid < 0 || waitpid(pid, &status, 0) != pid) {
+                return false;
+        }
+        return WIFSIGNALED(status);
+}
+
+int main(void)
+{
+        static const int flag_sets[] = {
+                0,
+                UARRAY2_ALLOC_HUGEPAGE,
+                UARRAY2_ALLOC_POPULATE,
+                UARRAY2_ALLOC_FIRST_TOUCH,
+                UARRAY2_ALLOC_HUGEPAGE | UARRAY2_ALLOC_POPULATE,
+                UARRAY2_ALLOC_HUGEPAGE | UARRAY2_ALLOC_FIRST_TOUCH
+        };
+        static const int shapes[][2] = {
+                { 1, 1 }, { 65, 3 }, { 300, 257 }, { 1100, 500 }
+        };
+        static const int sizes[] = { 1, 3, 8 };
+        int nsets   = sizeof(flag_sets) / sizeof(flag_sets[0]);
+        int nshapes = sizeof(shapes) / sizeof(shapes[0]);
+        bool ok = true;
+
+        for (int f = 0; f < nsets; f++) {
+                for (int s = 0; s < nshapes; s++) {
+                        int w = shapes[s][0];
+                        int h = shapes[s][1];
+                        for (int z = 0; z < 3; z++) {
+                                ok &= check_uarray2(w, h, sizes[z],
+                                                    flag_sets[f]);
+                        }
+                        /* The Bit2 flags have the same values */
+                        ok &= check_bit2(w, h, flag_sets[f]);
+                        ok &= check_bit2(w + 63, h, flag_sets[f]);
+                }
+        }
+        for (int which = 0; which < NBAD; which++) {
+                if (!dies(which)) {
+                        printf("FAIL bad call %d was allowed\n",
+                               which);
+                        ok = false;
+                }
+        }
+
+        printf("The allocation flags are %sOK!\n", ok ? "" : "NOT ");
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,184 @@
+/*
+ * usegather.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/17/2026
+ *
+ * Purpose: Checks the batched accessors UArray2_gather,
+ *          UArray2_scatter, Bit2_get_many and Bit2_put_many. Each
+ *          runs on a small array and on one large enough that big
+ *          batches are sorted by row, with batches of every length
+ *          around the eight-element AVX2 gather, and every result
+ *          is compared with the same batch replayed through the
+ *          single-element accessors.
+ *
+ * Key Insight: Every batch repeats some coordinates with different
+ *          values, so a scatter or put that visits the batch in
+ *          row order must still let the last value listed win, as
+ *          the in-order replay does.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <uarray2.h>
+#include <bit2.h>
+
+#define BATCH 5000            /* past the row-sort threshold */
+
+/*
+ * name: random_coords
+ *
+ * description: Fills coords with n pseudo-random positions in a
+ * width by height grid, with every seventh one repeating the one
+ * three places before it.
+ */
+static void random_coords(UArray2_pos *coords, int n, int width,
+                          int height)
+{
+        for (int i = 0; i < n; i++) {
+                if (i >= 3 && i % 7 == 0) {
+                        coords[i] = coords[i - 3];
+                } else {
+                        coords[i].col = rand() % width;
+                        coords[i].row = rand() % height;
+                }
+        }
+}
+
+/*
+ * name: check_uarray2
+ *
+ * description: Gathers from and scatters into a width by height
+ * array of ints (flat, or Morton when morton is set) with a batch
+ * of n coordinates, and compares against UArray2_at.
+ */
+static bool check_uarray2(int width, int height, bool morton, int n)
+{
+        UArray2_T a = morton ? UArray2_new_morton(width, height,
+                                                  sizeof(int))
+                             : UArray2_new(width, height, sizeof(int));
+        UArray2_pos *coords = malloc((n + 1) * sizeof(UArray2_pos));
+        int *values = malloc((n + 1) * sizeof(int));
+        int *expect = malloc((long)width * height * sizeof(int));
+        bool ok = true;
+
+        for (int row = 0; row < height; row++) {
+                for (int col = 0; col < width; col++) {
+                        *(int *)UArray2_at(a, col, row) =
+                                1000 * row + col;
+                        expect[row * width + col] = 1000 * row + col;
+                }
+        }
+        random_coords(coords, n, width, height);
+
+        UArray2_gather(a, coords, n, values);
+        for (int i = 0; i < n; i++) {
+                ok &= values[i] == 1000 * coords[i].row + coords[i].col;
+        }
+
+        /* Scatter, then replay the batch one element at a time */
+        for (int i = 0; i < n; i++) {
+                values[i] = -i - 1;
+        }
+        UArray2_scatter(a, coords, n, values);
+        for (int i = 0; i < n; i++) {
+                expect[coords[i].row * width + coords[i].col] =
+                        values[i];
+        }
+        for (int row = 0; row < height; row++) {
+                for (int col = 0; col < width; col++) {
+                        ok &= *(int *)UArray2_at(a, col, row) ==
+                              expect[row * width + col];
+                }
+        }
+
+        free(expect);
+        free(values);
+        free(coords);
+        UArray2_free(&a);
+        return ok;
+}
+
+/*
+ * name: check_bit2
+ *
+ * description: Reads and writes a width by height bitmap with
+ * batches of n coordinates, and compares against Bit2_get.
+ */
+static bool check_bit2(int width, int height, int n)
+{
+        Bit2_T bits   = Bit2_new(width, height);
+        Bit2_T expect = Bit2_new(width, height);
+        UArray2_pos *coords = malloc((n + 1) * sizeof(UArray2_pos));
+        Bit2_pos *pos = malloc((n + 1) * sizeof(Bit2_pos));
+        unsigned char *values = malloc(n + 1);
+        bool ok = true;
+
+        for (int row = 0; row < height; row++) {
+                for (int col = 0; col < width; col++) {
+                        Bit2_put(bits, col, row, (col ^ row) & 1);
+                        Bit2_put(expect, col, row, (col ^ row) & 1);
+                }
+        }
+        random_coords(coords, n, width, height);
+        for (int i = 0; i < n; i++) {
+                pos[i].col = coords[i].col;
+                pos[i].row = coords[i].row;
+        }
+
+        Bit2_get_many(bits, pos, n, values);
+        for (int i = 0; i < n; i++) {
+                ok &= values[i] == ((pos[i].col ^ pos[i].row) & 1);
+        }
+
+        /* A repeat always gets the value its original did not */
+        for (int i = 0; i < n; i++) {
+                values[i] = (i >= 3 && i % 7 == 0) ? !values[i - 3]
+                                                   : rand() & 1;
+        }
+        Bit2_put_many(bits, pos, n, values);
+        for (int i = 0; i < n; i++) {
+                Bit2_put(expect, pos[i].col, pos[i].row, values[i]);
+        }
+        for (int row = 0; row < height; row++) {
+                for (int col = 0; col < width; col++) {
+                        ok &= Bit2_get(bits, col, row) ==
+                              Bit2_get(expect, col, row);
+                }
+        }
+
+        free(values);
+        free(pos);
+        free(coords);
+        Bit2_free(&expect);
+        Bit2_free(&bits);
+        return ok;
+}
+
+int main(void)
+{
+        bool ok = true;
+
+        srand(40);
+        for (int n = 0; n <= 20; n++) {
+                if (!check_uarray2(13, 11, false, n) ||
+                    !check_uarray2(13, 11, true, n) ||
+                    !check_bit2(70, 5, n)) {
+                        printf("FAIL small batch of %d\n", n);
+                        ok = false;
+                }
+        }
+        if (!check_uarray2(600, 600, false, BATCH)) {
+                printf("FAIL large UArray2 batch\n");
+                ok = false;
+        }
+        if (!check_bit2(4096, 2100, BATCH)) {
+                printf("FAIL large Bit2 batch\n");
+                ok = false;
+        }
+
+        printf("The batches are %sOK!\n", ok ? "" : "NOT ");
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
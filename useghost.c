@@ -0,0 +1,197 @@
+/*
+ * useghost.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/18/2026
+ *
+ * Purpose: Checks UArray2_new_padded and UArray2_fill_ghosts in
+ *          all three border modes. Every ghost cell, corners
+ *          included, is read through UArray2_base and
+ *          UArray2_pitch and compared with the element the mode
+ *          names: the nearest edge element for CLAMP, the one from
+ *          the opposite edge for WRAP (even when the border is
+ *          deeper than the array), and zero bytes for CONSTANT.
+ *          The logical elements must be left alone, and a second
+ *          fill must pick up changed edge elements.
+ *
+ * Key Insight: Every byte of element (col, row) is a function of
+ *          col, row and the byte's index, so a ghost copied from
+ *          the wrong element, or copied only in part, does not
+ *          match.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <uarray2.h>
+
+/*
+ * name: byte_of
+ *
+ * description: Returns byte i of the element stored at (col, row),
+ * shifted by generation so refills can be told apart.
+ */
+static unsigned char byte_of(int col, int row, int i, int generation)
+{
+        return (unsigned char)(col * 13 + row * 71 + i * 37 +
+                               generation * 5 + 1);
+}
+
+/*
+ * name: fill
+ *
+ * description: Apply function storing each element's pattern for
+ * the generation *cl.
+ */
+static void fill(int col, int row, UArray2_T a, void *elem, void *cl)
+{
+        for (int i = 0; i < UArray2_size(a); i++) {
+                ((unsigned char *)elem)[i] =
+                        byte_of(col, row, i, *(int *)cl);
+        }
+}
+
+/*
+ * name: source
+ *
+ * description: Returns the coordinate in [0, n) whose element a
+ * cell at coordinate i holds under mode: i itself if in range,
+ * otherwise the ghost's source, or -1 for a zeroed ghost.
+ */
+static int source(int i, int n, UArray2_border mode)
+{
+        if (i >= 0 && i < n) {
+                return i;
+        }
+        if (mode == UARRAY2_BORDER_CLAMP) {
+                return i < 0 ? 0 : n - 1;
+        }
+        if (mode == UARRAY2_BORDER_WRAP) {
+                return ((i % n) + n) % n;
+        }
+        return -1;
+}
+
+/*
+ * name: check_cells
+ *
+ * description: Returns whether every cell of the padded array a,
+ * logical and ghost, holds what mode and generation call for.
+ */
+static bool check_cells(UArray2_T a, int ghost, UArray2_border mode,
+                        int generation)
+{
+        int width  = UArray2_width(a);
+        int height = UArray2_height(a);
+        int size   = UArray2_size(a);
+        const unsigned char *base = UArray2_base(a);
+        long pitch = UArray2_pitch(a);
+        bool ok = true;
+
+        for (int row = -ghost; row < height + ghost; row++) {
+                for (int col = -ghost; col < width + ghost; col++) {
+                        const unsigned char *elem =
+                                base + row * pitch + (long)col * size;
+                        int from_col = source(col, width, mode);
+                        int from_row = source(row, height, mode);
+                        for (int i = 0; i < size; i++) {
+                                int want = from_col < 0 ||
+                                           from_row < 0
+                                        ? 0
+                                        : byte_of(from_col, from_row,
+                                                  i, generation);
+                                ok &= elem[i] == want;
+                        }
+                }
+        }
+        return ok;
+}
+
+/*
+ * name: is_zero
+ *
+ * description: Returns whether every byte of every cell of the
+ * padded array a, logical and ghost, is zero.
+ */
+static bool is_zero(UArray2_T a, int ghost)
+{
+        int size = UArray2_size(a);
+        const unsigned char *base = UArray2_base(a);
+        long pitch = UArray2_pitch(a);
+        long row_bytes = (long)(UArray2_width(a) + 2 * ghost) * size;
+        bool ok = true;
+
+        for (int row = -ghost; row < UArray2_height(a) + ghost; row++) {
+                const unsigned char *line =
+                        base + row * pitch - (long)ghost * size;
+                for (long i = 0; i < row_bytes; i++) {
+                        ok &= line[i] == 0;
+                }
+        }
+        return ok;
+}
+
+/*
+ * name: check_shape
+ *
+ * description: Fills the ghosts of a width by height array of
+ * size-byte elements with a border ghost deep, which must start
+ * out zero, in every mode and twice each; prints and returns false
+ * on any mismatch.
+ */
+static bool check_shape(int width, int height, int size, int ghost)
+{
+        static const UArray2_border modes[] = {
+                UARRAY2_BORDER_CLAMP, UARRAY2_BORDER_WRAP,
+                UARRAY2_BORDER_CONSTANT
+        };
+        UArray2_T a = UArray2_new_padded(width, height, size, ghost);
+        int generation = 0;
+        bool ok = is_zero(a, ghost);
+
+        if (!ok) {
+                printf("FAIL %dx%d size %d ghost %d not zeroed\n",
+                       width, height, size, ghost);
+        }
+        for (int m = 0; m < 3; m++) {
+                for (int pass = 0; pass < 2; pass++) {
+                        generation++;
+                        UArray2_map_row_major(a, fill, &generation);
+                        UArray2_fill_ghosts(a, modes[m]);
+                        if (!check_cells(a, ghost, modes[m],
+                                         generation)) {
+                                printf("FAIL %dx%d size %d ghost %d "
+                                       "mode %d\n", width, height,
+                                       size, ghost, m);
+                                ok = false;
+                        }
+                }
+        }
+        UArray2_free(&a);
+        return ok;
+}
+
+int main(void)
+{
+        static const int shapes[][2] = {
+                { 1, 1 }, { 2, 1 }, { 1, 3 }, { 5, 4 }, { 17, 9 },
+                { 64, 3 }, { 100, 77 }
+        };
+        static const int sizes[] = { 1, 4, 12 };
+        int nshapes = sizeof(shapes) / sizeof(shapes[0]);
+        bool ok = true;
+
+        for (int s = 0; s < nshapes; s++) {
+                for (int z = 0; z < 3; z++) {
+                        for (int ghost = 0; ghost <= 3; ghost++) {
+                                ok &= check_shape(shapes[s][0],
+                                                  shapes[s][1],
+                                                  sizes[z], ghost);
+                        }
+                }
+        }
+
+        printf("The ghost cells are %sOK!\n", ok ? "" : "NOT ");
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,272 @@
+/*
+ * useintegral.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/18/2026
+ *
+ * Purpose: Checks UArray2_integral, Bit2_integral and
+ *          UArray2_integral_sum against brute force. Graymaps of
+ *          every element type, extremes included, and flat,
+ *          padded, view and Morton layouts, and bitmaps of widths
+ *          around a 64-bit word at densities from empty to full,
+ *          are summed; some are big enough to be built on the
+ *          thread pool in several column strips. Every table entry
+ *          is compared with a plain running sum, and random
+ *          rectangles, empty ones included, with a double loop
+ *          over the source.
+ *
+ * Key Insight: The brute-force sums read the source one element
+ *          at a time through UArray2_get and Bit2_get, so they
+ *          share no code with the tables they check.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <uarray2.h>
+#include <bit2.h>
+#include <bit2conv.h>
+
+#define RECTS 50            /* random rectangles per source */
+
+/*
+ * name: read_value
+ *
+ * description: Returns element (col, row) of a read as type.
+ */
+static int64_t read_value(UArray2_T a, int col, int row,
+                          UArray2_elem type)
+{
+        const void *elem = UArray2_get(a, col, row);
+
+        switch (type) {
+        case UARRAY2_ELEM_U8:  return *(const uint8_t *)elem;
+        case UARRAY2_ELEM_U16: return *(const uint16_t *)elem;
+        case UARRAY2_ELEM_I32: return *(const int32_t *)elem;
+        default:               return *(const uint32_t *)elem;
+        }
+}
+
+/*
+ * name: store_random
+ *
+ * description: Stores a random value of type at element (col, row)
+ * of a; one value in eight is the type's most extreme.
+ */
+static void store_random(UArray2_T a, int col, int row,
+                         UArray2_elem type)
+{
+        void *elem = UArray2_at(a, col, row);
+        uint32_t bits = (uint32_t)rand() << 16 ^ (uint32_t)rand();
+        bool extreme = rand() % 8 == 0;
+
+        switch (type) {
+        case UARRAY2_ELEM_U8:
+                *(uint8_t *)elem = extreme ? UINT8_MAX : (uint8_t)bits;
+                break;
+        case UARRAY2_ELEM_U16:
+                *(uint16_t *)elem = extreme ? UINT16_MAX
+                                            : (uint16_t)bits;
+                break;
+        case UARRAY2_ELEM_I32:
+                *(int32_t *)elem = extreme
+                        ? INT32_MIN
+                        : (int32_t)(bits - ((uint32_t)1 << 31));
+                break;
+        default:
+                *(uint32_t *)elem = extreme ? UINT32_MAX : bits;
+                break;
+        }
+}
+
+/*
+ * Reads element (col, row) of the source, a UArray2 or a Bit2,
+ * for the brute-force checks.
+ */
+typedef int64_t Reader(void *src, int col, int row, void *cl);
+
+/*
+ * name: read_uarray2
+ *
+ * description: Reader for a UArray2 source whose type is *cl.
+ */
+static int64_t read_uarray2(void *src, int col, int row, void *cl)
+{
+        return read_value(src, col, row, *(UArray2_elem *)cl);
+}
+
+/*
+ * name: read_bit2
+ *
+ * description: Reader for a Bit2 source.
+ */
+static int64_t read_bit2(void *src, int col, int row, void *cl)
+{
+        (void)cl;
+        return Bit2_get(src, col, row);
+}
+
+/*
+ * name: check_table
+ *
+ * description: Returns whether integral is the summed-area table
+ * of the width by height source read by read: every entry equals
+ * a plain running sum, and UArray2_integral_sum of random
+ * rectangles, and of the empty and whole ones, equals a double
+ * loop over the source.
+ */
+static bool check_table(UArray2_T integral, void *src, int width,
+                        int height, Reader *read, void *cl)
+{
+        bool ok = UArray2_width(integral) == width + 1 &&
+                  UArray2_height(integral) == height + 1 &&
+                  UArray2_size(integral) == (int)sizeof(int64_t);
+        int64_t *above = calloc(width + 1, sizeof(int64_t));
+
+        if (!ok) {
+                free(above);
+                return false;
+        }
+        for (int col = 0; col <= width; col++) {
+                ok &= *(const int64_t *)UArray2_get(integral, col, 0)
+                      == 0;
+        }
+        for (int row = 0; row < height; row++) {
+                int64_t line = 0;
+                ok &= *(const int64_t *)UArray2_get(integral, 0,
+                                                    row + 1) == 0;
+                for (int col = 0; col < width; col++) {
+                        line += read(src, col, row, cl);
+                        above[col + 1] += line;
+                        ok &= *(const int64_t *)UArray2_get(
+                                      integral, col + 1, row + 1) ==
+                              above[col + 1];
+                }
+        }
+        free(above);
+
+        for (int r = 0; r < RECTS + 2; r++) {
+                UArray2_rect rect = { 0, 0, width, height };
+                if (r < RECTS) {
+                        rect.col    = rand() % (width + 1);
+                        rect.row    = rand() % (height + 1);
+                        rect.width  = rand() % (width - rect.col + 1);
+                        rect.height = rand() % (height - rect.row + 1);
+                } else if (r == RECTS) {
+                        rect.col   = width;
+                        rect.width = 0;
+                }
+                int64_t sum = 0;
+                for (int row = 0; row < rect.height; row++) {
+                        for (int col = 0; col < rect.width; col++) {
+                                sum += read(src, rect.col + col,
+                                            rect.row + row, cl);
+                        }
+                }
+                ok &= UArray2_integral_sum(integral, rect) == sum;
+        }
+        return ok;
+}
+
+/*
+ * name: check_uarray2
+ *
+ * description: Checks UArray2_integral of width by height arrays
+ * of type in every layout, printing each failure.
+ */
+static bool check_uarray2(int width, int height, UArray2_elem type,
+                          int size)
+{
+        UArray2_T parent = UArray2_new(width + 7, height + 3, size);
+        UArray2_T sources[] = {
+                UArray2_new(width, height, size),
+                UArray2_new_padded(width, height, size, 2),
+                UArray2_view(parent, 5, 2, width, height),
+                UArray2_new_morton(width, height, size)
+        };
+        bool ok = true;
+
+        for (int s = 0; s < 4; s++) {
+                for (int row = 0; row < height; row++) {
+                        for (int col = 0; col < width; col++) {
+                                store_random(sources[s], col, row,
+                                             type);
+                        }
+                }
+                UArray2_T integral = UArray2_integral(sources[s], type);
+                if (!check_table(integral, sources[s], width, height,
+                                 read_uarray2, &type)) {
+                        printf("FAIL %dx%d type %d layout %d\n", width,
+                               height, (int)type, s);
+                        ok = false;
+                }
+                UArray2_free(&integral);
+        }
+        for (int s = 3; s >= 0; s--) {
+                UArray2_free(&sources[s]);
+        }
+        UArray2_free(&parent);
+        return ok;
+}
+
+/*
+ * name: check_bit2
+ *
+ * description: Checks Bit2_integral of a width by height bitmap
+ * with about percent of its bits set, printing any failure.
+ */
+static bool check_bit2(int width, int height, int percent)
+{
+        Bit2_T bits = Bit2_new(width, height);
+        bool ok;
+
+        for (int row = 0; row < height; row++) {
+                for (int col = 0; col < width; col++) {
+                        Bit2_put(bits, col, row,
+                                 rand() % 100 < percent);
+                }
+        }
+        UArray2_T integral = Bit2_integral(bits);
+        ok = check_table(integral, bits, width, height, read_bit2,
+                         NULL);
+        if (!ok) {
+                printf("FAIL bitmap %dx%d %d%%\n", width, height,
+                       percent);
+        }
+        UArray2_free(&integral);
+        Bit2_free(&bits);
+        return ok;
+}
+
+int main(void)
+{
+        static const int shapes[][2] = {
+                { 1, 1 }, { 1, 17 }, { 63, 2 }, { 64, 3 }, { 65, 9 },
+                { 130, 41 }, { 400, 300 }, { 1500, 60 }
+        };
+        static const UArray2_elem types[] = {
+                UARRAY2_ELEM_U8, UARRAY2_ELEM_U16, UARRAY2_ELEM_I32,
+                UARRAY2_ELEM_U32
+        };
+        static const int sizes[]    = { 1, 2, 4, 4 };
+        static const int percents[] = { 0, 3, 50, 97, 100 };
+        int nshapes = sizeof(shapes) / sizeof(shapes[0]);
+        bool ok = true;
+
+        srand(64);
+        for (int s = 0; s < nshapes; s++) {
+                for (int t = 0; t < 4; t++) {
+                        ok &= check_uarray2(shapes[s][0], shapes[s][1],
+                                            types[t], sizes[t]);
+                }
+                for (int p = 0; p < 5; p++) {
+                        ok &= check_bit2(shapes[s][0], shapes[s][1],
+                                         percents[p]);
+                }
+        }
+
+        printf("The integrals are %sOK!\n", ok ? "" : "NOT ");
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
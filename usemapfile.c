@@ -0,0 +1,227 @@
+/*
+ * usemapfile.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/18/2026
+ *
+ * Purpose: Checks UArray2_map_file round trips. A file created
+ *          with UARRAY2_MAP_CREATE must read as zeros; elements
+ *          written through a RDWR mapping must be seen by a later
+ *          RDONLY mapping that takes its width, height and size
+ *          from the file; writes to a PRIVATE mapping must not
+ *          reach the file; and the map functions must visit a
+ *          mapped array, and a view of one, like any other array.
+ *
+ * Key Insight: Every mapping is freed before the file is mapped
+ *          again, so each check sees only what an earlier mapping
+ *          left in the file, not memory it still shares.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+#include <uarray2.h>
+
+#define SIZE 6              /* not a power of two */
+
+/*
+ * name: byte_of
+ *
+ * description: Returns byte i of the element written at
+ * (col, row).
+ */
+static unsigned char byte_of(int col, int row, int i)
+{
+        return (unsigned char)(col * 11 + row * 89 + i * 23 + 1);
+}
+
+/*
+ * name: fill
+ *
+ * description: Apply function storing each element's pattern.
+ */
+static void fill(int col, int row, UArray2_T a, void *elem, void *cl)
+{
+        (void)cl;
+        for (int i = 0; i < UArray2_size(a); i++) {
+                ((unsigned char *)elem)[i] = byte_of(col, row, i);
+        }
+}
+
+/*
+ * name: check_elem
+ *
+ * description: Apply function clearing *cl if an element does not
+ * hold the pattern of the parent element at (col + col0,
+ * row + row0); cl points to { ok, col0, row0 }.
+ */
+static void check_elem(int col, int row, UArray2_T a, void *elem,
+                       void *cl)
+{
+        int *state = cl;
+        for (int i = 0; i < UArray2_size(a); i++) {
+                if (((unsigned char *)elem)[i] !=
+                    byte_of(col + state[1], row + state[2], i)) {
+                        state[0] = 0;
+                }
+        }
+}
+
+/*
+ * name: holds_pattern
+ *
+ * description: Returns whether a is width by height with elements
+ * of SIZE bytes holding the pattern stored by fill, checked by
+ * both map functions and by UArray2_get.
+ */
+static bool holds_pattern(UArray2_T a, int width, int height)
+{
+        int state[3] = { 1, 0, 0 };
+        bool ok = UArray2_width(a) == width &&
+                  UArray2_height(a) == height &&
+                  UArray2_size(a) == SIZE;
+
+        if (!ok) {
+                return false;
+        }
+        UArray2_map_row_major(a, check_elem, state);
+        UArray2_map_col_major(a, check_elem, state);
+        ok = state[0];
+        for (int row = 0; row < height; row++) {
+                for (int col = 0; col < width; col++) {
+                        ok &= ((const unsigned char *)
+                               UArray2_get(a, col, row))[SIZE - 1] ==
+                              byte_of(col, row, SIZE - 1);
+                }
+        }
+        return ok;
+}
+
+/*
+ * name: is_zero
+ *
+ * description: Returns whether every byte of every element of a
+ * is zero.
+ */
+static bool is_zero(UArray2_T a)
+{
+        bool ok = true;
+
+        for (int row = 0; row < UArray2_height(a); row++) {
+                for (int col = 0; col < UArray2_width(a); col++) {
+                        const unsigned char *elem =
+                                UArray2_get(a, col, row);
+                        for (int i = 0; i < SIZE; i++) {
+                                ok &= elem[i] == 0;
+                        }
+                }
+        }
+        return ok;
+}
+
+/*
+ * name: check_view
+ *
+ * description: Returns whether a view into the middle of the
+ * mapped array a, which holds the pattern, is visited in both
+ * orders with the parent's elements.
+ */
+static bool check_view(UArray2_T a)
+{
+        int width  = UArray2_width(a);
+        int height = UArray2_height(a);
+        int col0   = width / 3;
+        int row0   = height / 4;
+        UArray2_T view = UArray2_view(a, col0, row0, width - col0,
+                                      height - row0);
+        int state[3] = { 1, col0, row0 };
+
+        UArray2_map_row_major(view, check_elem, state);
+        UArray2_map_col_major(view, check_elem, state);
+        UArray2_free(&view);
+        return state[0];
+}
+
+/*
+ * name: check_shape
+ *
+ * description: Runs every round trip on a width by height file at
+ * path, which must not exist, printing each failure.
+ */
+static bool check_shape(int width, int height, const char *path)
+{
+        bool ok = true;
+
+        UArray2_T a = UArray2_map_file(path, width, height, SIZE,
+                                       UARRAY2_MAP_RDWR |
+                                       UARRAY2_MAP_CREATE);
+        if (!is_zero(a)) {
+                printf("FAIL %dx%d new file not zeroed\n", width,
+                       height);
+                ok = false;
+        }
+        UArray2_map_row_major(a, fill, NULL);
+        UArray2_free(&a);
+
+        /* The file supplies the shape when the arguments are 0 */
+        a = UArray2_map_file(path, 0, 0, 0, UARRAY2_MAP_RDONLY);
+        if (!holds_pattern(a, width, height) || !check_view(a)) {
+                printf("FAIL %dx%d RDWR writes not in file\n", width,
+                       height);
+                ok = false;
+        }
+        UArray2_free(&a);
+
+        /* Private writes are seen by the array, not by the file */
+        a = UArray2_map_file(path, width, height, SIZE,
+                             UARRAY2_MAP_PRIVATE);
+        unsigned char zero[SIZE] = { 0 };
+        UArray2_fill(a, zero);
+        if (!is_zero(a)) {
+                printf("FAIL %dx%d private writes lost\n", width,
+                       height);
+                ok = false;
+        }
+        UArray2_free(&a);
+
+        a = UArray2_map_file(path, width, 0, SIZE,
+                             UARRAY2_MAP_RDWR);
+        if (!holds_pattern(a, width, height)) {
+                printf("FAIL %dx%d private writes reached file\n",
+                       width, height);
+                ok = false;
+        }
+        UArray2_free(&a);
+        return ok;
+}
+
+int main(void)
+{
+        static const int shapes[][2] = {
+                { 1, 1 }, { 7, 3 }, { 3, 700 }, { 683, 1 },
+                { 300, 200 }, { 1025, 517 }
+        };
+        int nshapes = sizeof(shapes) / sizeof(shapes[0]);
+        char path[] = "/tmp/usemapfileXXXXXX";
+        int fd = mkstemp(path);
+        bool ok = true;
+
+        if (fd < 0) {
+                perror("usemapfile");
+                return EXIT_FAILURE;
+        }
+        close(fd);
+
+        for (int s = 0; s < nshapes; s++) {
+                remove(path);
+                ok &= check_shape(shapes[s][0], shapes[s][1], path);
+        }
+        remove(path);
+
+        printf("The mapped files are %sOK!\n", ok ? "" : "NOT ");
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
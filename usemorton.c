@@ -0,0 +1,261 @@
+/*
+ * usemorton.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/18/2026
+ *
+ * Purpose: Checks UArray2_new_morton against UArray2_new on sizes
+ *          that are not square and not powers of two, where the
+ *          Z-order storage is padded and split into blocks. Every
+ *          element must have storage of its own; both maps must
+ *          visit the same elements in the same order as on a flat
+ *          array; UArray2_map_storage_order must visit each
+ *          element once, in increasing address order; and copies,
+ *          blits, reductions and gathers between the layouts must
+ *          agree.
+ *
+ * Key Insight: The flat and Morton arrays are filled with the
+ *          same values, so any difference in what an operation
+ *          sees or produces is a Morton indexing error.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <uarray2.h>
+
+/*
+ * Closure for record: the elements visited so far, as (col, row,
+ * value) triples, and how many there are.
+ */
+struct Trace {
+        int *seen;
+        long n;
+};
+
+/*
+ * name: record
+ *
+ * description: Apply function appending each visited element's
+ * position and value to a Trace.
+ */
+static void record(int col, int row, UArray2_T a, void *elem, void *cl)
+{
+        struct Trace *t = cl;
+
+        (void)a;
+        t->seen[3 * t->n]     = col;
+        t->seen[3 * t->n + 1] = row;
+        t->seen[3 * t->n + 2] = *(int *)elem;
+        t->n++;
+}
+
+/*
+ * name: same_trace
+ *
+ * description: Runs map over a and b, which are the same size,
+ * and returns whether both visit the same elements with the same
+ * values in the same order.
+ */
+static bool same_trace(void (*map)(UArray2_T, UArray2_applyfun *,
+                                   void *),
+                       UArray2_T a, UArray2_T b)
+{
+        long length = (long)UArray2_width(a) * UArray2_height(a);
+        struct Trace ta = { malloc(3 * length * sizeof(int)), 0 };
+        struct Trace tb = { malloc(3 * length * sizeof(int)), 0 };
+        bool ok;
+
+        map(a, record, &ta);
+        map(b, record, &tb);
+        ok = ta.n == length && tb.n == length;
+        for (long i = 0; i < 3 * length && ok; i++) {
+                ok = ta.seen[i] == tb.seen[i];
+        }
+        free(tb.seen);
+        free(ta.seen);
+        return ok;
+}
+
+/*
+ * Closure for storage: how often each element was visited, the
+ * last address visited, and whether all is well so far.
+ */
+struct Storage {
+        char *visits;
+        uintptr_t last;
+        bool ok;
+};
+
+/*
+ * name: storage
+ *
+ * description: Apply function for UArray2_map_storage_order that
+ * counts each element's visits and checks that addresses rise
+ * and match UArray2_at.
+ */
+static void storage(int col, int row, UArray2_T a, void *elem,
+                    void *cl)
+{
+        struct Storage *s = cl;
+        uintptr_t addr = (uintptr_t)elem;
+
+        s->ok &= elem == UArray2_at(a, col, row);
+        s->ok &= s->last == 0 || addr > s->last;
+        s->last = addr;
+        s->visits[(long)row * UArray2_width(a) + col]++;
+}
+
+/*
+ * name: check_storage
+ *
+ * description: Returns whether UArray2_map_storage_order visits
+ * every element of a exactly once, in increasing address order.
+ */
+static bool check_storage(UArray2_T a)
+{
+        long length = (long)UArray2_width(a) * UArray2_height(a);
+        struct Storage s = { calloc(length, 1), 0, true };
+
+        UArray2_map_storage_order(a, storage, &s);
+        for (long i = 0; i < length; i++) {
+                s.ok &= s.visits[i] == 1;
+        }
+        free(s.visits);
+        return s.ok;
+}
+
+/*
+ * name: equal
+ *
+ * description: Returns whether the int arrays a and b, of the
+ * same size, hold the same elements, read through UArray2_get.
+ */
+static bool equal(UArray2_T a, UArray2_T b)
+{
+        bool ok = true;
+
+        for (int row = 0; row < UArray2_height(a); row++) {
+                for (int col = 0; col < UArray2_width(a); col++) {
+                        ok &= *(const int *)UArray2_get(a, col, row) ==
+                              *(const int *)UArray2_get(b, col, row);
+                }
+        }
+        return ok;
+}
+
+/*
+ * name: check_shape
+ *
+ * description: Runs every comparison on width by height arrays,
+ * printing each failure.
+ */
+static bool check_shape(int width, int height)
+{
+        UArray2_T flat   = UArray2_new(width, height, sizeof(int));
+        UArray2_T morton = UArray2_new_morton(width, height,
+                                              sizeof(int));
+        UArray2_T copy   = UArray2_new_morton(width, height,
+                                              sizeof(int));
+        bool ok = true;
+
+        /* Distinct storage: every value written survives */
+        for (int row = 0; row < height; row++) {
+                for (int col = 0; col < width; col++) {
+                        int value = rand();
+                        *(int *)UArray2_at(flat, col, row)   = value;
+                        *(int *)UArray2_at(morton, col, row) = value;
+                }
+        }
+        ok &= equal(flat, morton);
+        if (!ok) {
+                printf("FAIL %dx%d at/get\n", width, height);
+        }
+        if (!same_trace(UArray2_map_row_major, flat, morton) ||
+            !same_trace(UArray2_map_col_major, flat, morton)) {
+                printf("FAIL %dx%d map order\n", width, height);
+                ok = false;
+        }
+        if (!check_storage(morton) || !check_storage(flat)) {
+                printf("FAIL %dx%d storage order\n", width, height);
+                ok = false;
+        }
+
+        /* Copies and blits between the layouts */
+        UArray2_copy(copy, flat);
+        bool moved = equal(copy, morton);
+        int zero = 0;
+        UArray2_fill(flat, &zero);
+        UArray2_copy(flat, morton);
+        moved &= equal(flat, morton);
+        UArray2_rect rect = { width / 3, height / 4, width - width / 3,
+                              height - height / 4 };
+        UArray2_fill(copy, &zero);
+        UArray2_blit(copy, 0, 0, morton, rect);
+        for (int row = 0; row < rect.height; row++) {
+                for (int col = 0; col < rect.width; col++) {
+                        moved &= *(int *)UArray2_at(copy, col, row) ==
+                                 *(int *)UArray2_at(flat,
+                                                    rect.col + col,
+                                                    rect.row + row);
+                }
+        }
+        if (!moved) {
+                printf("FAIL %dx%d copy/blit\n", width, height);
+                ok = false;
+        }
+
+        /* Reductions and gathers see the same elements */
+        int n = width * height < 300 ? width * height : 300;
+        UArray2_pos *coords = malloc(n * sizeof(*coords));
+        int *from_flat   = malloc(n * sizeof(int));
+        int *from_morton = malloc(n * sizeof(int));
+        for (int i = 0; i < n; i++) {
+                coords[i].col = rand() % width;
+                coords[i].row = rand() % height;
+        }
+        UArray2_gather(flat, coords, n, from_flat);
+        UArray2_gather(morton, coords, n, from_morton);
+        bool same = UArray2_sum(flat, UARRAY2_ELEM_I32) ==
+                    UArray2_sum(morton, UARRAY2_ELEM_I32) &&
+                    UArray2_min(flat, UARRAY2_ELEM_I32) ==
+                    UArray2_min(morton, UARRAY2_ELEM_I32) &&
+                    UArray2_max(flat, UARRAY2_ELEM_I32) ==
+                    UArray2_max(morton, UARRAY2_ELEM_I32);
+        for (int i = 0; i < n; i++) {
+                same &= from_flat[i] == from_morton[i];
+        }
+        if (!same) {
+                printf("FAIL %dx%d reduce/gather\n", width, height);
+                ok = false;
+        }
+
+        free(from_morton);
+        free(from_flat);
+        free(coords);
+        UArray2_free(&copy);
+        UArray2_free(&morton);
+        UArray2_free(&flat);
+        return ok;
+}
+
+int main(void)
+{
+        static const int shapes[][2] = {
+                { 1, 1 }, { 1, 9 }, { 9, 1 }, { 2, 3 }, { 3, 2 },
+                { 5, 17 }, { 17, 5 }, { 33, 31 }, { 100, 7 },
+                { 7, 100 }, { 129, 65 }, { 300, 70 }, { 513, 257 }
+        };
+        int nshapes = sizeof(shapes) / sizeof(shapes[0]);
+        bool ok = true;
+
+        srand(60);
+        for (int s = 0; s < nshapes; s++) {
+                ok &= check_shape(shapes[s][0], shapes[s][1]);
+        }
+
+        printf("The Morton arrays are %sOK!\n", ok ? "" : "NOT ");
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
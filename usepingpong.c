@@ -0,0 +1,343 @@
+/*
+ * usepingpong.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/18/2026
+ *
+ * Purpose: Checks Pingpong_iterate and Pingpong_map. An integer
+ *          five-point kernel, reading its neighbours from the ghost
+ *          cells, is run for several step counts and border modes
+ *          serially, on pools of one to four threads and on the
+ *          shared pool; every result must equal a plain reference
+ *          computed on ordinary C arrays, and every step must
+ *          compute each row exactly once. One Pingpong_map step
+ *          must match one Pingpong_iterate step.
+ *
+ * Key Insight: The kernel is exact integer arithmetic, so the
+ *          serial and pooled results must agree bit for bit, and
+ *          any row computed from a stale or half-written front
+ *          array shows up as a difference.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <pingpong.h>
+#include <pool.h>
+
+#define STEPS 7             /* most iterations run */
+
+/*
+ * Closure for band: how many times each row of the current step
+ * has been computed.
+ */
+struct Band {
+        int *computed;
+};
+
+/*
+ * name: kernel
+ *
+ * description: Returns the next value of an element from its own
+ * value and its four neighbours'.
+ */
+static int kernel(int center, int north, int south, int west, int east)
+{
+        return (center * 3 + north + south * 5 + west * 7 + east) %
+               100003;
+}
+
+/*
+ * name: band
+ *
+ * description: Pingpong_bandfun applying kernel to rows row0 ..
+ * row1 - 1, reading neighbours from front through its base and
+ * pitch, ghost cells included.
+ */
+static void band(UArray2_T front, UArray2_T back, int row0, int row1,
+                 void *cl)
+{
+        struct Band *b = cl;
+        const char *src = UArray2_base(front);
+        char *dst = UArray2_base(back);
+        long pitch = UArray2_pitch(front);
+        long dpitch = UArray2_pitch(back);
+
+        for (int row = row0; row < row1; row++) {
+                const int *line  = (const int *)(src + row * pitch);
+                const int *above = (const int *)(src + (row - 1) *
+                                                 pitch);
+                const int *below = (const int *)(src + (row + 1) *
+                                                 pitch);
+                int *out = (int *)(dst + row * dpitch);
+                for (int col = 0; col < UArray2_width(front); col++) {
+                        out[col] = kernel(line[col], above[col],
+                                          below[col], line[col - 1],
+                                          line[col + 1]);
+                }
+                b->computed[row]++;
+        }
+}
+
+/*
+ * name: step
+ *
+ * description: Pingpong_stepfun applying kernel to one element,
+ * reading neighbours through UArray2_get with the edges clamped.
+ */
+static void step(int col, int row, UArray2_T front, const void *src,
+                 void *dst, void *cl)
+{
+        int width  = UArray2_width(front);
+        int height = UArray2_height(front);
+        int up     = row > 0 ? row - 1 : 0;
+        int down   = row < height - 1 ? row + 1 : height - 1;
+        int left   = col > 0 ? col - 1 : 0;
+        int right  = col < width - 1 ? col + 1 : width - 1;
+
+        (void)cl;
+        *(int *)dst = kernel(*(const int *)src,
+                             *(const int *)UArray2_get(front, col, up),
+                             *(const int *)UArray2_get(front, col,
+                                                       down),
+                             *(const int *)UArray2_get(front, left,
+                                                       row),
+                             *(const int *)UArray2_get(front, right,
+                                                       row));
+}
+
+/*
+ * name: source
+ *
+ * description: Returns the coordinate in [0, n) that coordinate i
+ * reads under mode, or -1 if it reads zero.
+ */
+static int source(int i, int n, UArray2_border mode)
+{
+        if (i >= 0 && i < n) {
+                return i;
+        }
+        if (mode == UARRAY2_BORDER_CLAMP) {
+                return i < 0 ? 0 : n - 1;
+        }
+        if (mode == UARRAY2_BORDER_WRAP) {
+                return ((i % n) + n) % n;
+        }
+        return -1;
+}
+
+/*
+ * name: neighbour
+ *
+ * description: Returns the value grid cell (col, row) reads under
+ * mode, from a width by height row-major grid.
+ */
+static int neighbour(const int *grid, int width, int height, int col,
+                     int row, UArray2_border mode)
+{
+        int c = source(col, width, mode);
+        int r = source(row, height, mode);
+        return c < 0 || r < 0 ? 0 : grid[(long)r * width + c];
+}
+
+/*
+ * name: reference
+ *
+ * description: Runs steps steps of kernel on the width by height
+ * row-major grid, in place, with plain C arrays.
+ */
+static void reference(int *grid, int width, int height, int steps,
+                      UArray2_border mode)
+{
+        long length = (long)width * height;
+        int *next = malloc(length * sizeof(int));
+
+        for (int s = 0; s < steps; s++) {
+                for (int row = 0; row < height; row++) {
+                        for (int col = 0; col < width; col++) {
+                                next[(long)row * width + col] = kernel(
+                                        grid[(long)row * width + col],
+                                        neighbour(grid, width, height,
+                                                  col, row - 1, mode),
+                                        neighbour(grid, width, height,
+                                                  col, row + 1, mode),
+                                        neighbour(grid, width, height,
+                                                  col - 1, row, mode),
+                                        neighbour(grid, width, height,
+                                                  col + 1, row, mode));
+                        }
+                }
+                memcpy(grid, next, length * sizeof(int));
+        }
+        free(next);
+}
+
+/*
+ * name: holds
+ *
+ * description: Returns whether the int array a holds the width by
+ * height row-major grid.
+ */
+static bool holds(UArray2_T a, const int *grid)
+{
+        bool ok = true;
+
+        for (int row = 0; row < UArray2_height(a); row++) {
+                for (int col = 0; col < UArray2_width(a); col++) {
+                        ok &= *(const int *)UArray2_get(a, col, row) ==
+                              grid[(long)row * UArray2_width(a) + col];
+                }
+        }
+        return ok;
+}
+
+/*
+ * name: load
+ *
+ * description: Returns a new pair whose front array holds the
+ * width by height row-major grid.
+ */
+static Pingpong_T load(const int *grid, int width, int height)
+{
+        Pingpong_T pair = Pingpong_new(width, height, sizeof(int), 1);
+        UArray2_T front = Pingpong_front(pair);
+
+        for (int row = 0; row < height; row++) {
+                for (int col = 0; col < width; col++) {
+                        *(int *)UArray2_at(front, col, row) =
+                                grid[(long)row * width + col];
+                }
+        }
+        return pair;
+}
+
+/*
+ * name: run
+ *
+ * description: Iterates a pair loaded with start for steps steps
+ * on pool (NULL: serially) and returns whether the result is
+ * expect and every row was computed once per step.
+ */
+static bool run(const int *start, const int *expect, int width,
+                int height, int steps, UArray2_border mode,
+                Pool_T pool)
+{
+        Pingpong_T pair = load(start, width, height);
+        struct Band b = { calloc(height, sizeof(int)) };
+        bool ok;
+
+        Pingpong_iterate(pair, steps, mode, band, &b, pool);
+        ok = holds(Pingpong_front(pair), expect);
+        for (int row = 0; row < height; row++) {
+                ok &= b.computed[row] == steps;
+        }
+        free(b.computed);
+        Pingpong_free(&pair);
+        return ok;
+}
+
+/*
+ * name: check_map
+ *
+ * description: Returns whether one Pingpong_map step, then a
+ * swap, leaves the result of one clamped step in front.
+ */
+static bool check_map(const int *start, int width, int height)
+{
+        long length = (long)width * height;
+        int *expect = malloc(length * sizeof(int));
+        Pingpong_T pair = load(start, width, height);
+        bool ok;
+
+        memcpy(expect, start, length * sizeof(int));
+        reference(expect, width, height, 1, UARRAY2_BORDER_CLAMP);
+        Pingpong_map(pair, step, NULL);
+        Pingpong_swap(pair);
+        ok = holds(Pingpong_front(pair), expect);
+        free(expect);
+        Pingpong_free(&pair);
+        return ok;
+}
+
+/*
+ * name: check_shape
+ *
+ * description: Runs every comparison on width by height pairs
+ * with the given pools, printing each failure.
+ */
+static bool check_shape(int width, int height, Pool_T *pools,
+                        int npools)
+{
+        static const UArray2_border modes[] = {
+                UARRAY2_BORDER_CLAMP, UARRAY2_BORDER_WRAP,
+                UARRAY2_BORDER_CONSTANT
+        };
+        long length = (long)width * height;
+        int *start  = malloc(length * sizeof(int));
+        int *expect = malloc(length * sizeof(int));
+        bool ok = true;
+
+        for (long i = 0; i < length; i++) {
+                start[i] = rand() % 100003;
+        }
+        for (int m = 0; m < 3; m++) {
+                for (int steps = 0; steps <= STEPS; steps += 3) {
+                        memcpy(expect, start, length * sizeof(int));
+                        reference(expect, width, height, steps,
+                                  modes[m]);
+                        if (!run(start, expect, width, height, steps,
+                                 modes[m], NULL)) {
+                                printf("FAIL %dx%d mode %d steps %d "
+                                       "serial\n", width, height, m,
+                                       steps);
+                                ok = false;
+                        }
+                        for (int p = 0; p < npools; p++) {
+                                if (!run(start, expect, width, height,
+                                         steps, modes[m], pools[p])) {
+                                        printf("FAIL %dx%d mode %d "
+                                               "steps %d pool %d\n",
+                                               width, height, m,
+                                               steps, p);
+                                        ok = false;
+                                }
+                        }
+                }
+        }
+        if (!check_map(start, width, height)) {
+                printf("FAIL %dx%d map\n", width, height);
+                ok = false;
+        }
+        free(expect);
+        free(start);
+        return ok;
+}
+
+int main(void)
+{
+        static const int shapes[][2] = {
+                { 1, 1 }, { 3, 1 }, { 1, 50 }, { 37, 23 },
+                { 200, 129 }
+        };
+        int nshapes = sizeof(shapes) / sizeof(shapes[0]);
+        Pool_T pools[] = {
+                Pool_new(1), Pool_new(2), Pool_new(4), Pool_shared()
+        };
+        int npools = sizeof(pools) / sizeof(pools[0]);
+        bool ok = true;
+
+        srand(63);
+        for (int s = 0; s < nshapes; s++) {
+                ok &= check_shape(shapes[s][0], shapes[s][1], pools,
+                                  npools);
+        }
+        for (int p = 0; p < npools - 1; p++) {
+                Pool_free(&pools[p]);
+        }
+
+        printf("The ping-pong iterations are %sOK!\n",
+               ok ? "" : "NOT ");
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
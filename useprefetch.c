@@ -0,0 +1,270 @@
+/*
+ * useprefetch.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/18/2026
+ *
+ * Purpose: Checks UArray2_map_col_major_prefetch and
+ *          Bit2_map_col_major_prefetch against the plain
+ *          column-major maps. On flat, padded, view, Morton,
+ *          sparse and file-mapped arrays of several element sizes,
+ *          and on bitmaps of widths around a 64-bit word, each
+ *          must call apply once per element in column-major order
+ *          with the element the plain map passes, for the default
+ *          distance and for distances of one row, the whole column
+ *          and more than the column. A negative distance must be a
+ *          checked runtime error.
+ *
+ * Key Insight: The prefetching maps split each column into a part
+ *          with a prefetch ahead and a tail without one, so the
+ *          distances are picked to make either part empty; an
+ *          element dropped or repeated where they meet shows up in
+ *          the call count and position.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <uarray2.h>
+#include <bit2.h>
+
+#define NLAYOUTS 6          /* array layouts made by check_shape */
+#define NBAD 2              /* bad calls made by bad_call */
+
+/*
+ * Closure for the apply functions: the array or bitmap walked,
+ * its height, the calls made so far, and whether all is well.
+ */
+struct Walk {
+        void *array;
+        int height;
+        long calls;
+        bool ok;
+};
+
+/*
+ * name: visit_uarray2
+ *
+ * description: UArray2_applyfun checking that (col, row) is the
+ * next position of a column-major walk and that elem is
+ * UArray2_at's.
+ */
+static void visit_uarray2(int col, int row, UArray2_T a, void *elem,
+                          void *cl)
+{
+        struct Walk *w = cl;
+
+        w->ok &= a == w->array &&
+                 (long)col * w->height + row == w->calls &&
+                 elem == UArray2_at(a, col, row);
+        w->calls++;
+}
+
+/*
+ * name: visit_bit2
+ *
+ * description: Bit2_applyfun checking that (col, row) is the next
+ * position of a column-major walk and that elem is the bit there.
+ */
+static void visit_bit2(int col, int row, Bit2_T bits, int elem,
+                       void *cl)
+{
+        struct Walk *w = cl;
+
+        w->ok &= bits == w->array &&
+                 (long)col * w->height + row == w->calls &&
+                 elem == Bit2_get(bits, col, row);
+        w->calls++;
+}
+
+/*
+ * name: walk_uarray2
+ *
+ * description: Maps a column-major with the plain map when
+ * distance is -1 and the prefetching map otherwise, and returns
+ * whether every element was visited once, in order.
+ */
+static bool walk_uarray2(UArray2_T a, int distance)
+{
+        struct Walk w = { a, UArray2_height(a), 0, true };
+
+        if (distance < 0) {
+                UArray2_map_col_major(a, visit_uarray2, &w);
+        } else {
+                UArray2_map_col_major_prefetch(a, visit_uarray2, &w,
+                                               distance);
+        }
+        return w.ok && w.calls ==
+               (long)UArray2_width(a) * UArray2_height(a);
+}
+
+/*
+ * name: walk_bit2
+ *
+ * description: Maps bits column-major as walk_uarray2 maps an
+ * array, and returns whether every bit was visited once, in
+ * order.
+ */
+static bool walk_bit2(Bit2_T bits, int distance)
+{
+        struct Walk w = { bits, Bit2_height(bits), 0, true };
+
+        if (distance < 0) {
+                Bit2_map_col_major(bits, visit_bit2, &w);
+        } else {
+                Bit2_map_col_major_prefetch(bits, visit_bit2, &w,
+                                            distance);
+        }
+        return w.ok && w.calls ==
+               (long)Bit2_width(bits) * Bit2_height(bits);
+}
+
+/*
+ * name: check_shape
+ *
+ * description: Walks width by height arrays of size-byte elements
+ * in every layout, and a bitmap, with every distance, printing
+ * each failure. path names a file the mapped array may create.
+ */
+static bool check_shape(int width, int height, int size,
+                        const char *path)
+{
+        int distances[] = {
+                -1, UARRAY2_PREFETCH_DEFAULT, 1, 3, height - 1,
+                height, height + 5
+        };
+        int ndistances = sizeof(distances) / sizeof(distances[0]);
+        UArray2_T parent = UArray2_new(width + 3, height + 5, size);
+        UArray2_T arrays[NLAYOUTS];
+        Bit2_T bits = Bit2_new(width, height);
+        bool ok = true;
+
+        remove(path);
+        arrays[0] = UArray2_new(width, height, size);
+        arrays[1] = UArray2_new_padded(width, height, size, 3);
+        arrays[2] = UArray2_view(parent, 2, 4, width, height);
+        arrays[3] = UArray2_new_morton(width, height, size);
+        arrays[4] = UArray2_new_sparse(width, height, size);
+        arrays[5] = UArray2_map_file(path, width, height, size,
+                                     UARRAY2_MAP_RDWR |
+                                     UARRAY2_MAP_CREATE);
+        for (int row = 0; row < height; row++) {
+                for (int col = 0; col < width; col++) {
+                        Bit2_put(bits, col, row, rand() % 2);
+                }
+        }
+
+        for (int d = 0; d < ndistances; d++) {
+                for (int i = 0; i < NLAYOUTS; i++) {
+                        if (!walk_uarray2(arrays[i], distances[d])) {
+                                printf("FAIL %dx%d size %d layout %d "
+                                       "distance %d\n", width, height,
+                                       size, i, distances[d]);
+                                ok = false;
+                        }
+                }
+                if (size == 1 && !walk_bit2(bits, distances[d])) {
+                        printf("FAIL bitmap %dx%d distance %d\n",
+                               width, height, distances[d]);
+                        ok = false;
+                }
+        }
+
+        Bit2_free(&bits);
+        for (int i = NLAYOUTS - 1; i >= 0; i--) {
+                UArray2_free(&arrays[i]);
+        }
+        UArray2_free(&parent);
+        return ok;
+}
+
+/*
+ * name: bad_call
+ *
+ * description: Makes the bad call numbered which, each a checked
+ * runtime error.
+ */
+static void bad_call(int which)
+{
+        UArray2_T a = UArray2_new(5, 4, 2);
+        Bit2_T bits = Bit2_new(5, 4);
+        struct Walk w = { NULL, 4, 0, true };
+
+        switch (which) {
+        case 0:
+                UArray2_map_col_major_prefetch(a, visit_uarray2, &w,
+                                               -1);
+                break;
+        case 1:
+                Bit2_map_col_major_prefetch(bits, visit_bit2, &w, -1);
+                break;
+        }
+}
+
+/*
+ * name: dies
+ *
+ * description: Makes bad call which in a child process, with its
+ * standard error discarded, and returns whether the child was
+ * killed by a signal rather than exiting.
+ */
+static bool dies(int which)
+{
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0) {
+                if (freopen("/dev/null", "w", stderr) == NULL) {
+                        _exit(0);
+                }
+                bad_call(which);
+                _exit(0);
+        }
+        int status;
+        if (pid < 0 || waitpid(pid, &status, 0) != pid) {
+                return false;
+        }
+        return WIFSIGNALED(status);
+}
+
+int main(void)
+{
+        static const int shapes[][2] = {
+                { 1, 1 }, { 1, 20 }, { 20, 1 }, { 63, 17 },
+                { 65, 40 }, { 130, 67 }, { 700, 129 }
+        };
+        static const int sizes[] = { 1, 2, 4, 12 };
+        int nshapes = sizeof(shapes) / sizeof(shapes[0]);
+        char path[] = "/tmp/useprefetchXXXXXX";
+        int fd = mkstemp(path);
+        bool ok = true;
+
+        if (fd < 0) {
+                perror("useprefetch");
+                return EXIT_FAILURE;
+        }
+        close(fd);
+
+        srand(74);
+        for (int s = 0; s < nshapes; s++) {
+                for (int z = 0; z < 4; z++) {
+                        ok &= check_shape(shapes[s][0], shapes[s][1],
+                                          sizes[z], path);
+                }
+        }
+        remove(path);
+        for (int which = 0; which < NBAD; which++) {
+                if (!dies(which)) {
+                        printf("FAIL bad call %d was allowed\n",
+                               which);
+                        ok = false;
+                }
+        }
+
+        printf("The prefetching maps are %sOK!\n", ok ? "" : "NOT ");
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
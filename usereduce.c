@@ -0,0 +1,246 @@
+/*
+ * usereduce.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/18/2026
+ *
+ * Purpose: Checks UArray2_reduce, UArray2_sum, UArray2_min,
+ *          UArray2_max and UArray2_histogram against plain loops,
+ *          for every element type, for flat, padded, view, Morton
+ *          and sparse arrays, and for arrays both below and above
+ *          the size at which the work is split across the thread
+ *          pool.
+ *
+ * Key Insight: The UArray2_reduce accumulator also sums each
+ *          value weighted by its position and starts its minimum
+ *          at the largest value, so an element visited twice or
+ *          not at all, handed the wrong position, or folded into a
+ *          copy not started from the initial value, changes the
+ *          result.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <uarray2.h>
+
+#define NBINS 300           /* histogram bins; some values fall out */
+
+/*
+ * Accumulator for UArray2_reduce: the number of elements, their
+ * sum, their sum weighted by position, and their minimum.
+ */
+struct Acc {
+        int64_t count;
+        int64_t sum;
+        uint64_t weighted;
+        int64_t min;
+};
+
+/*
+ * name: read_value
+ *
+ * description: Returns the element at elem read as type.
+ */
+static int64_t read_value(const void *elem, UArray2_elem type)
+{
+        switch (type) {
+        case UARRAY2_ELEM_U8:  return *(const uint8_t *)elem;
+        case UARRAY2_ELEM_U16: return *(const uint16_t *)elem;
+        case UARRAY2_ELEM_I32: return *(const int32_t *)elem;
+        default:               return *(const uint32_t *)elem;
+        }
+}
+
+/*
+ * name: store_random
+ *
+ * description: Stores a random value of type at elem; small
+ * values are common so that the histogram has counts to check.
+ */
+static void store_random(void *elem, UArray2_elem type)
+{
+        uint32_t bits = (uint32_t)rand() << 16 ^ (uint32_t)rand();
+
+        if (rand() % 2) {
+                bits %= NBINS + 20;
+        }
+        switch (type) {
+        case UARRAY2_ELEM_U8:
+                *(uint8_t *)elem = (uint8_t)bits;
+                break;
+        case UARRAY2_ELEM_U16:
+                *(uint16_t *)elem = (uint16_t)bits;
+                break;
+        case UARRAY2_ELEM_I32:
+                *(int32_t *)elem = (int32_t)bits;
+                break;
+        default:
+                *(uint32_t *)elem = bits;
+                break;
+        }
+}
+
+/*
+ * name: weight
+ *
+ * description: Returns the weight of position (col, row) in the
+ * weighted sum.
+ */
+static uint64_t weight(int col, int row)
+{
+        return (uint64_t)row * 1000003 + (uint64_t)col * 7 + 1;
+}
+
+/*
+ * name: fold
+ *
+ * description: UArray2_reducefun adding one element, whose type
+ * is *cl, to a struct Acc.
+ */
+static void fold(int col, int row, const void *elem, void *acc,
+                 void *cl)
+{
+        struct Acc *a = acc;
+        int64_t value = read_value(elem, *(UArray2_elem *)cl);
+
+        a->count++;
+        a->sum += value;
+        a->weighted += (uint64_t)value * weight(col, row);
+        if (value < a->min) {
+                a->min = value;
+        }
+}
+
+/*
+ * name: combine
+ *
+ * description: UArray2_combinefun folding one struct Acc into
+ * another.
+ */
+static void combine(void *acc, const void *other, void *cl)
+{
+        struct Acc *a = acc;
+        const struct Acc *b = other;
+
+        (void)cl;
+        a->count    += b->count;
+        a->sum      += b->sum;
+        a->weighted += b->weighted;
+        if (b->min < a->min) {
+                a->min = b->min;
+        }
+}
+
+/*
+ * name: check_array
+ *
+ * description: Returns whether every reduction of a, whose
+ * elements are read as type, matches a plain loop.
+ */
+static bool check_array(UArray2_T a, UArray2_elem type)
+{
+        struct Acc want = { 0, 0, 0, INT64_MAX };
+        struct Acc got  = { 0, 0, 0, INT64_MAX };
+        int64_t max = INT64_MIN;
+        int64_t want_bins[NBINS] = { 0 };
+        int64_t got_bins[NBINS];
+        bool ok;
+
+        for (int row = 0; row < UArray2_height(a); row++) {
+                for (int col = 0; col < UArray2_width(a); col++) {
+                        const void *elem = UArray2_get(a, col, row);
+                        int64_t value = read_value(elem, type);
+                        fold(col, row, elem, &want, &type);
+                        if (value > max) {
+                                max = value;
+                        }
+                        if (value >= 0 && value < NBINS) {
+                                want_bins[value]++;
+                        }
+                }
+        }
+
+        UArray2_reduce(a, &got, sizeof(got), combine, fold, &type);
+        ok = got.count == want.count && got.sum == want.sum &&
+             got.weighted == want.weighted && got.min == want.min;
+        ok &= UArray2_sum(a, type) == want.sum;
+        ok &= UArray2_min(a, type) == want.min;
+        ok &= UArray2_max(a, type) == max;
+        UArray2_histogram(a, type, got_bins, NBINS);
+        for (int v = 0; v < NBINS; v++) {
+                ok &= got_bins[v] == want_bins[v];
+        }
+        return ok;
+}
+
+/*
+ * name: check_shape
+ *
+ * description: Checks width by height arrays of type in every
+ * layout, printing each failure.
+ */
+static bool check_shape(int width, int height, UArray2_elem type,
+                        int size)
+{
+        UArray2_T parent = UArray2_new(width + 4, height + 9, size);
+        UArray2_T arrays[] = {
+                UArray2_new(width, height, size),
+                UArray2_new_padded(width, height, size, 1),
+                UArray2_view(parent, 3, 8, width, height),
+                UArray2_new_morton(width, height, size),
+                UArray2_new_sparse(width, height, size)
+        };
+        bool ok = true;
+
+        for (int i = 0; i < 5; i++) {
+                for (int row = 0; row < height; row++) {
+                        for (int col = 0; col < width; col++) {
+                                /* Leave most sparse chunks unwritten */
+                                if (i == 4 && row % 5 != 0) {
+                                        continue;
+                                }
+                                store_random(UArray2_at(arrays[i], col,
+                                                        row), type);
+                        }
+                }
+                if (!check_array(arrays[i], type)) {
+                        printf("FAIL %dx%d type %d layout %d\n", width,
+                               height, (int)type, i);
+                        ok = false;
+                }
+        }
+        for (int i = 4; i >= 0; i--) {
+                UArray2_free(&arrays[i]);
+        }
+        UArray2_free(&parent);
+        return ok;
+}
+
+int main(void)
+{
+        static const int shapes[][2] = {
+                { 1, 1 }, { 1, 30 }, { 30, 1 }, { 17, 13 },
+                { 300, 257 }, { 2000, 70 }
+        };
+        static const UArray2_elem types[] = {
+                UARRAY2_ELEM_U8, UARRAY2_ELEM_U16, UARRAY2_ELEM_I32,
+                UARRAY2_ELEM_U32
+        };
+        static const int sizes[] = { 1, 2, 4, 4 };
+        int nshapes = sizeof(shapes) / sizeof(shapes[0]);
+        bool ok = true;
+
+        srand(65);
+        for (int s = 0; s < nshapes; s++) {
+                for (int t = 0; t < 4; t++) {
+                        ok &= check_shape(shapes[s][0], shapes[s][1],
+                                          types[t], sizes[t]);
+                }
+        }
+
+        printf("The reductions are %sOK!\n", ok ? "" : "NOT ");
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
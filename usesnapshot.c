@@ -0,0 +1,255 @@
+/*
+ * usesnapshot.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/17/2026
+ *
+ * Purpose: Checks UArray2_save/UArray2_load and Bit2_save/Bit2_load.
+ *          Arrays of every layout (flat, Morton, sparse, padded and
+ *          views) and bitmaps of widths on both sides of a 64-bit
+ *          word are saved to a temporary file and loaded back
+ *          read-only, read-only with the payload checksum verified,
+ *          and private; writes to a private load must not reach
+ *          the file.
+ *
+ * Key Insight: The file is reloaded after every private load has
+ *          overwritten all of its elements, so a private mapping
+ *          that was really shared would be seen as a changed file.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+#include <uarray2.h>
+#include <bit2.h>
+
+#define SIZE 12             /* odd-sized, not a power of two */
+
+/*
+ * name: byte_of
+ *
+ * description: Returns byte i of the element saved at (col, row).
+ */
+static unsigned char byte_of(int col, int row, int i)
+{
+        return (unsigned char)(col * 3 + row * 101 + i * 17 + 1);
+}
+
+/*
+ * name: fill
+ *
+ * description: Apply function storing each element's pattern.
+ */
+static void fill(int col, int row, UArray2_T a, void *elem, void *cl)
+{
+        (void)cl;
+        for (int i = 0; i < UArray2_size(a); i++) {
+                ((unsigned char *)elem)[i] = byte_of(col, row, i);
+        }
+}
+
+/*
+ * name: holds_pattern
+ *
+ * description: Returns whether a is width by height with elements
+ * of SIZE bytes holding the pattern stored by fill.
+ */
+static bool holds_pattern(UArray2_T a, int width, int height)
+{
+        bool ok = UArray2_width(a) == width &&
+                  UArray2_height(a) == height &&
+                  UArray2_size(a) == SIZE;
+
+        for (int row = 0; row < height && ok; row++) {
+                for (int col = 0; col < width; col++) {
+                        const unsigned char *elem =
+                                UArray2_get(a, col, row);
+                        for (int i = 0; i < SIZE; i++) {
+                                ok &= elem[i] == byte_of(col, row, i);
+                        }
+                }
+        }
+        return ok;
+}
+
+/*
+ * name: check_loads
+ *
+ * description: Saves a, which holds the pattern, to path and
+ * checks every way of loading it back.
+ */
+static bool check_loads(UArray2_T a, const char *path)
+{
+        int width  = UArray2_width(a);
+        int height = UArray2_height(a);
+        int modes[] = {
+                UARRAY2_MAP_RDONLY,
+                UARRAY2_MAP_RDONLY | UARRAY2_LOAD_VERIFY,
+                UARRAY2_MAP_PRIVATE | UARRAY2_LOAD_VERIFY
+        };
+        bool ok = true;
+
+        UArray2_save(a, path);
+        for (int m = 0; m < 3; m++) {
+                UArray2_T b = UArray2_load(path, modes[m]);
+                ok &= holds_pattern(b, width, height);
+                UArray2_free(&b);
+        }
+
+        /* Private writes are seen by the array, not by the file */
+        UArray2_T b = UArray2_load(path, UARRAY2_MAP_PRIVATE);
+        unsigned char zero[SIZE] = { 0 };
+        UArray2_fill(b, zero);
+        ok &= ((unsigned char *)UArray2_at(b, width - 1,
+                                           height - 1))[0] == 0;
+        UArray2_free(&b);
+
+        b = UArray2_load(path, UARRAY2_MAP_RDONLY);
+        ok &= holds_pattern(b, width, height);
+        UArray2_free(&b);
+        return ok;
+}
+
+/*
+ * name: check_uarray2
+ *
+ * description: Checks a width by height array of every layout,
+ * printing each failure.
+ */
+static bool check_uarray2(int width, int height, const char *path)
+{
+        UArray2_T parent = UArray2_new(width + 9, height + 5, SIZE);
+        UArray2_T arrays[] = {
+                UArray2_new(width, height, SIZE),
+                UArray2_new_morton(width, height, SIZE),
+                UArray2_new_sparse(width, height, SIZE),
+                UArray2_new_padded(width, height, SIZE, 2),
+                UArray2_view(parent, 4, 3, width, height)
+        };
+        bool ok = true;
+
+        for (int i = 0; i < 5; i++) {
+                UArray2_map_row_major(arrays[i], fill, NULL);
+                if (!check_loads(arrays[i], path)) {
+                        printf("FAIL %dx%d layout %d\n", width, height,
+                               i);
+                        ok = false;
+                }
+        }
+        for (int i = 4; i >= 0; i--) {
+                UArray2_free(&arrays[i]);
+        }
+        UArray2_free(&parent);
+        return ok;
+}
+
+/*
+ * name: bit_of
+ *
+ * description: Returns the bit saved at (col, row).
+ */
+static int bit_of(int col, int row)
+{
+        return ((col * 5 + row * 3) % 7) < 3;
+}
+
+/*
+ * name: holds_bits
+ *
+ * description: Returns whether bits is width by height and holds
+ * the pattern of bit_of.
+ */
+static bool holds_bits(Bit2_T bits, int width, int height)
+{
+        bool ok = Bit2_width(bits) == width &&
+                  Bit2_height(bits) == height;
+
+        for (int row = 0; row < height && ok; row++) {
+                for (int col = 0; col < width; col++) {
+                        ok &= Bit2_get(bits, col, row) ==
+                              bit_of(col, row);
+                }
+        }
+        return ok;
+}
+
+/*
+ * name: check_bit2
+ *
+ * description: Saves a width by height bitmap to path and checks
+ * every way of loading it back.
+ */
+static bool check_bit2(int width, int height, const char *path)
+{
+        Bit2_T bits = Bit2_new(width, height);
+        int modes[] = {
+                BIT2_MAP_RDONLY,
+                BIT2_MAP_RDONLY | BIT2_LOAD_VERIFY,
+                BIT2_MAP_PRIVATE | BIT2_LOAD_VERIFY
+        };
+        bool ok = true;
+
+        for (int row = 0; row < height; row++) {
+                for (int col = 0; col < width; col++) {
+                        Bit2_put(bits, col, row, bit_of(col, row));
+                }
+        }
+        Bit2_save(bits, path);
+        for (int m = 0; m < 3; m++) {
+                Bit2_T b = Bit2_load(path, modes[m]);
+                ok &= holds_bits(b, width, height);
+                ok &= Bit2_count(b) == Bit2_count(bits);
+                Bit2_free(&b);
+        }
+
+        /* Private writes are seen by the bitmap, not by the file */
+        Bit2_T b = Bit2_load(path, BIT2_MAP_PRIVATE);
+        for (int row = 0; row < height; row++) {
+                for (int col = 0; col < width; col++) {
+                        Bit2_put(b, col, row, !bit_of(col, row));
+                }
+        }
+        ok &= Bit2_get(b, 0, 0) != bit_of(0, 0);
+        Bit2_free(&b);
+
+        b = Bit2_load(path, BIT2_MAP_RDONLY);
+        ok &= holds_bits(b, width, height);
+        Bit2_free(&b);
+        Bit2_free(&bits);
+
+        if (!ok) {
+                printf("FAIL bitmap %dx%d\n", width, height);
+        }
+        return ok;
+}
+
+int main(void)
+{
+        static const int shapes[][2] = {
+                { 1, 1 }, { 7, 3 }, { 63, 2 }, { 64, 5 }, { 65, 4 },
+                { 300, 200 }
+        };
+        int nshapes = sizeof(shapes) / sizeof(shapes[0]);
+        char path[] = "/tmp/usesnapshotXXXXXX";
+        int fd = mkstemp(path);
+        bool ok = true;
+
+        if (fd < 0) {
+                perror("usesnapshot");
+                return EXIT_FAILURE;
+        }
+        close(fd);
+
+        for (int s = 0; s < nshapes; s++) {
+                ok &= check_uarray2(shapes[s][0], shapes[s][1], path);
+                ok &= check_bit2(shapes[s][0], shapes[s][1], path);
+        }
+        remove(path);
+
+        printf("The snapshots are %sOK!\n", ok ? "" : "NOT ");
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
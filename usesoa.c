@@ -0,0 +1,355 @@
+/*
+ * usesoa.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/18/2026
+ *
+ * Purpose: Checks UArray2soa. A new array must read back zero;
+ *          every struct put must come back from UArray2soa_get and
+ *          UArray2soa_at field by field, with the padding of the
+ *          caller's struct left alone and that of the temporary
+ *          zero; each field must be in its own plane, at
+ *          UArray2soa_row, where UArray2 reads and writes see the
+ *          same values as the struct accessors; and the maps must
+ *          visit every element in order and store what apply
+ *          changes. Bad field lists and out-of-bounds indices
+ *          must be checked runtime errors.
+ *
+ * Key Insight: The fields are listed out of struct order and have
+ *          three different sizes, so a plane picked by position in
+ *          the struct rather than in the list, or a field copied
+ *          with the wrong size or offset, changes a value.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <uarray2.h>
+#include <uarray2soa.h>
+
+#define NFIELDS 4           /* fields of struct Pixel */
+#define NBAD 10             /* bad calls made by bad_call */
+#define PAD 0xA5            /* byte left in padding by the caller */
+
+/*
+ * The element struct, with padding after label and after flags.
+ */
+struct Pixel {
+        uint8_t label;
+        double dist;
+        uint16_t flags;
+        int32_t id;
+};
+
+/* The fields of struct Pixel, out of struct order */
+static const UArray2soa_field fields[NFIELDS] = {
+        { offsetof(struct Pixel, dist),  sizeof(double)   },
+        { offsetof(struct Pixel, id),    sizeof(int32_t)  },
+        { offsetof(struct Pixel, label), sizeof(uint8_t)  },
+        { offsetof(struct Pixel, flags), sizeof(uint16_t) }
+};
+
+/*
+ * Closure for the map checks: the array's shape, whether the map
+ * is column-major, the calls made so far, and whether all is well.
+ */
+struct Walk {
+        int width;
+        int height;
+        bool col_major;
+        long calls;
+        bool ok;
+};
+
+/*
+ * name: pixel_of
+ *
+ * description: Returns the struct Pixel stored at (col, row) in
+ * round k, with every padding byte PAD.
+ */
+static struct Pixel pixel_of(int col, int row, int k)
+{
+        struct Pixel p;
+
+        memset(&p, PAD, sizeof(p));
+        p.label = (uint8_t)(col * 7 + row + k);
+        p.dist  = col * 0.25 - row * 3.0 + k;
+        p.flags = (uint16_t)(col * 301 + row * 17 + k);
+        p.id    = col * 100003 - row * 11 - k;
+        return p;
+}
+
+/*
+ * name: same_fields
+ *
+ * description: Returns whether a and b hold the same fields.
+ */
+static bool same_fields(const struct Pixel *a, const struct Pixel *b)
+{
+        return a->label == b->label && a->dist == b->dist &&
+               a->flags == b->flags && a->id == b->id;
+}
+
+/*
+ * name: padding_is
+ *
+ * description: Returns whether every padding byte of p is byte.
+ */
+static bool padding_is(const struct Pixel *p, int byte)
+{
+        const unsigned char *bytes = (const unsigned char *)p;
+        bool ok = true;
+
+        for (size_t i = 0; i < sizeof(*p); i++) {
+                bool covered = false;
+                for (int f = 0; f < NFIELDS; f++) {
+                        covered |= i >= (size_t)fields[f].offset &&
+                                   i < (size_t)(fields[f].offset +
+                                                fields[f].size);
+                }
+                ok &= covered || bytes[i] == byte;
+        }
+        return ok;
+}
+
+/*
+ * name: bump
+ *
+ * description: UArray2soa_applyfun checking that (col, row) is
+ * the next position of the walk in cl and that elem holds round
+ * 1's pixel, then changing elem to round 2's.
+ */
+static void bump(int col, int row, UArray2soa_T soa, void *elem,
+                 void *cl)
+{
+        struct Walk *w = cl;
+        struct Pixel want = pixel_of(col, row, 1);
+        long index = w->col_major ? (long)col * w->height + row
+                                  : (long)row * w->width + col;
+
+        (void)soa;
+        w->ok &= index == w->calls &&
+                 same_fields(elem, &want);
+        w->calls++;
+        want = pixel_of(col, row, 2);
+        memcpy(elem, &want, sizeof(want));
+}
+
+/*
+ * name: check_planes
+ *
+ * description: Returns whether every field of soa's element
+ * (col, row) is in its plane at UArray2soa_row, and equals the
+ * same field of want.
+ */
+static bool check_planes(UArray2soa_T soa, int col, int row,
+                         const struct Pixel *want)
+{
+        bool ok = true;
+
+        for (int f = 0; f < NFIELDS; f++) {
+                UArray2_T plane = UArray2soa_plane(soa, f);
+                const char *line = UArray2soa_row(soa, f, row);
+                const char *elem = line + (long)col * fields[f].size;
+                ok &= elem == UArray2_at(plane, col, row) &&
+                      memcmp(elem, (const char *)want +
+                             fields[f].offset, fields[f].size) == 0;
+        }
+        return ok;
+}
+
+/*
+ * name: check_shape
+ *
+ * description: Runs every check on a width by height UArray2soa,
+ * printing each failure.
+ */
+static bool check_shape(int width, int height)
+{
+        UArray2soa_T soa = UArray2soa_new(width, height,
+                                          sizeof(struct Pixel),
+                                          fields, NFIELDS);
+        struct Pixel zero, seen;
+        bool ok = UArray2soa_width(soa) == width &&
+                  UArray2soa_height(soa) == height &&
+                  UArray2soa_size(soa) == sizeof(struct Pixel) &&
+                  UArray2soa_nfields(soa) == NFIELDS;
+
+        memset(&zero, 0, sizeof(zero));
+        for (int f = 0; f < NFIELDS; f++) {
+                UArray2_T plane = UArray2soa_plane(soa, f);
+                ok &= UArray2_width(plane) == width &&
+                      UArray2_height(plane) == height &&
+                      UArray2_size(plane) == fields[f].size;
+        }
+        for (int row = 0; row < height; row++) {
+                for (int col = 0; col < width; col++) {
+                        ok &= check_planes(soa, col, row, &zero);
+                        struct Pixel p = pixel_of(col, row, 0);
+                        UArray2soa_put(soa, col, row, &p);
+                }
+        }
+        if (!ok) {
+                printf("FAIL %dx%d new array\n", width, height);
+                UArray2soa_free(&soa);
+                return false;
+        }
+
+        /* What put stored, get, at and the planes read back */
+        for (int row = 0; row < height; row++) {
+                for (int col = 0; col < width; col++) {
+                        struct Pixel want = pixel_of(col, row, 0);
+                        memset(&seen, PAD, sizeof(seen));
+                        UArray2soa_get(soa, col, row, &seen);
+                        ok &= same_fields(&seen, &want) &&
+                              padding_is(&seen, PAD);
+                        const struct Pixel *at =
+                                UArray2soa_at(soa, col, row);
+                        ok &= same_fields(at, &want) &&
+                              padding_is(at, 0);
+                        ok &= check_planes(soa, col, row, &want);
+                }
+        }
+        if (!ok) {
+                printf("FAIL %dx%d put and get\n", width, height);
+        }
+
+        /* Writes through the planes are seen by get */
+        for (int row = 0; row < height; row++) {
+                for (int col = 0; col < width; col++) {
+                        struct Pixel p = pixel_of(col, row, 1);
+                        for (int f = 0; f < NFIELDS; f++) {
+                                memcpy(UArray2_at(UArray2soa_plane(soa,
+                                                                   f),
+                                                  col, row),
+                                       (char *)&p + fields[f].offset,
+                                       fields[f].size);
+                        }
+                }
+        }
+        for (int row = 0; row < height && ok; row++) {
+                for (int col = 0; col < width; col++) {
+                        struct Pixel want = pixel_of(col, row, 1);
+                        UArray2soa_get(soa, col, row, &seen);
+                        ok &= same_fields(&seen, &want);
+                }
+        }
+        if (!ok) {
+                printf("FAIL %dx%d plane writes\n", width, height);
+        }
+
+        /* Each map sees round 1 and leaves round 2 behind */
+        for (int cm = 0; cm <= 1 && ok; cm++) {
+                struct Walk w = { width, height, cm, 0, true };
+                if (cm) {
+                        UArray2soa_map_col_major(soa, bump, &w);
+                } else {
+                        UArray2soa_map_row_major(soa, bump, &w);
+                }
+                ok &= w.ok && w.calls == (long)width * height;
+                for (int row = 0; row < height; row++) {
+                        for (int col = 0; col < width; col++) {
+                                struct Pixel want =
+                                        pixel_of(col, row, 2);
+                                ok &= check_planes(soa, col, row,
+                                                   &want);
+                                want = pixel_of(col, row, 1);
+                                UArray2soa_put(soa, col, row, &want);
+                        }
+                }
+                if (!ok) {
+                        printf("FAIL %dx%d map order %d\n", width,
+                               height, cm);
+                }
+        }
+        UArray2soa_free(&soa);
+        return ok && soa == NULL;
+}
+
+/*
+ * name: bad_call
+ *
+ * description: Makes the bad call numbered which, each a checked
+ * runtime error.
+ */
+static void bad_call(int which)
+{
+        static const UArray2soa_field overlap[] = {
+                { 0, 4 }, { 2, 4 }
+        };
+        static const UArray2soa_field outside[] = { { 4, 8 } };
+        static const UArray2soa_field empty[]   = { { 0, 0 } };
+        UArray2soa_T soa = UArray2soa_new(5, 4, sizeof(struct Pixel),
+                                          fields, NFIELDS);
+        struct Pixel p;
+
+        switch (which) {
+        case 0: UArray2soa_new(5, 4, 8, overlap, 2);           break;
+        case 1: UArray2soa_new(5, 4, 8, outside, 1);           break;
+        case 2: UArray2soa_new(5, 4, 8, empty, 1);             break;
+        case 3: UArray2soa_new(5, 4, 8, fields, 0);            break;
+        case 4: UArray2soa_plane(soa, NFIELDS);                break;
+        case 5: UArray2soa_row(soa, 0, 4);                     break;
+        case 6: UArray2soa_get(soa, 5, 0, &p);                 break;
+        case 7: UArray2soa_put(soa, 0, -1, &p);                break;
+        case 8: UArray2soa_at(soa, -1, 0);                     break;
+        case 9: UArray2soa_map_row_major(soa, NULL, NULL);     break;
+        }
+}
+
+/*
+ * name: dies
+ *
+ * description: Makes bad call which in a child process, with its
+ * standard error discarded, and returns whether the child was
+ * killed by a signal rather than exiting.
+ */
+static bool dies(int which)
+{
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0) {
+                if (freopen("/dev/null", "w", stderr) == NULL) {
+                        _exit(0);
+                }
+                bad_call(which);
+                _exit(0);
+        }
+        int status;
+        if (pid < 0 || waitpid(pid, &status, 0) != pid) {
+                return false;
+        }
+        return WIFSIGNALED(status);
+}
+
+int main(void)
+{
+        static const int shapes[][2] = {
+                { 1, 1 }, { 1, 9 }, { 9, 1 }, { 17, 13 }, { 130, 70 },
+                { 1000, 300 }
+        };
+        int nshapes = sizeof(shapes) / sizeof(shapes[0]);
+        bool ok = true;
+
+        for (int s = 0; s < nshapes; s++) {
+                ok &= check_shape(shapes[s][0], shapes[s][1]);
+        }
+        for (int which = 0; which < NBAD; which++) {
+                if (!dies(which)) {
+                        printf("FAIL bad call %d was allowed\n",
+                               which);
+                        ok = false;
+                }
+        }
+
+        printf("The SoA arrays are %sOK!\n", ok ? "" : "NOT ");
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,192 @@
+/*
+ * usesparse.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/18/2026
+ *
+ * Purpose: Checks UArray2_new_sparse. Unwritten elements must read
+ *          as zero through UArray2_get without allocating anything;
+ *          each write must allocate exactly the chunk holding it,
+ *          which UArray2_map_materialized then visits in row-major
+ *          order; and a row-major map must allocate every chunk.
+ *          Element sizes run from 1 byte to more than a chunk, and
+ *          the shapes leave the last chunk short.
+ *
+ * Key Insight: Chunks hold CHUNK_BYTES / size consecutive
+ *          row-major elements (at least one), so the elements
+ *          UArray2_map_materialized must visit after a set of
+ *          writes can be worked out from their row-major indices
+ *          alone.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <uarray2.h>
+
+#define CHUNK_BYTES 4096    /* as in uarray2.c */
+#define WRITES      40      /* scattered writes per array */
+#define MAX_BYTES   (1L << 24)  /* larger arrays are skipped */
+
+/*
+ * Closure for visit: the array's width, the row-major index the
+ * next visited element must have, which chunks were written, how
+ * many elements per chunk, and whether all is well so far.
+ */
+struct Visit {
+        int width;
+        long next;
+        const bool *written;
+        long per_chunk;
+        bool ok;
+};
+
+/*
+ * name: visit
+ *
+ * description: Apply function for UArray2_map_materialized that
+ * checks each visited element lies in a written chunk and that
+ * the elements come in increasing row-major order, skipping
+ * only whole unwritten chunks.
+ */
+static void visit(int col, int row, UArray2_T a, void *elem, void *cl)
+{
+        struct Visit *v = cl;
+        long index = (long)row * v->width + col;
+
+        (void)a;
+        (void)elem;
+        if (index < v->next || !v->written[index / v->per_chunk]) {
+                v->ok = false;
+        }
+        for (long skip = v->next; skip < index; skip++) {
+                if (v->written[skip / v->per_chunk]) {
+                        v->ok = false;  /* a written element missed */
+                }
+        }
+        v->next = index + 1;
+}
+
+/*
+ * name: is_zero
+ *
+ * description: Returns whether the size bytes at elem are all
+ * zero.
+ */
+static bool is_zero(const unsigned char *elem, int size)
+{
+        for (int i = 0; i < size; i++) {
+                if (elem[i] != 0) {
+                        return false;
+                }
+        }
+        return true;
+}
+
+/*
+ * name: count
+ *
+ * description: Apply function counting the elements visited.
+ */
+static void count(int col, int row, UArray2_T a, void *elem, void *cl)
+{
+        (void)col;
+        (void)row;
+        (void)a;
+        (void)elem;
+        (*(long *)cl)++;
+}
+
+/*
+ * name: check_shape
+ *
+ * description: Runs every check on a width by height sparse array
+ * of size-byte elements, printing each failure.
+ */
+static bool check_shape(int width, int height, int size)
+{
+        long length    = (long)width * height;
+        long per_chunk = size < CHUNK_BYTES ? CHUNK_BYTES / size : 1;
+        long nchunks   = (length + per_chunk - 1) / per_chunk;
+        bool *written  = calloc(nchunks, sizeof(*written));
+        UArray2_T a    = UArray2_new_sparse(width, height, size);
+        bool ok        = true;
+        long visited   = 0;
+
+        /* Reads see zeros and allocate nothing */
+        for (int row = 0; row < height; row++) {
+                for (int col = 0; col < width; col++) {
+                        ok &= is_zero(UArray2_get(a, col, row), size);
+                }
+        }
+        UArray2_map_materialized(a, count, &visited);
+        ok &= visited == 0;
+
+        /* Each write allocates just its own chunk */
+        for (int w = 0; w < WRITES; w++) {
+                long index = w == 0 ? length - 1
+                                    : rand() % length;
+                int col = (int)(index % width);
+                int row = (int)(index / width);
+                unsigned char *elem = UArray2_at(a, col, row);
+                elem[size - 1] = (unsigned char)(w + 1);
+                written[index / per_chunk] = true;
+        }
+        for (int row = 0; row < height; row++) {
+                for (int col = 0; col < width; col++) {
+                        long index = (long)row * width + col;
+                        const unsigned char *elem =
+                                UArray2_get(a, col, row);
+                        if (!written[index / per_chunk]) {
+                                ok &= is_zero(elem, size);
+                        }
+                }
+        }
+        struct Visit v = { width, 0, written, per_chunk, true };
+        UArray2_map_materialized(a, visit, &v);
+        for (long skip = v.next; skip < length; skip++) {
+                v.ok &= !written[skip / per_chunk];
+        }
+        ok &= v.ok;
+
+        /* A row-major map hands out pointers, so allocates all */
+        UArray2_map_row_major(a, count, &visited);
+        ok &= visited == length;
+        visited = 0;
+        UArray2_map_materialized(a, count, &visited);
+        ok &= visited == length;
+
+        if (!ok) {
+                printf("FAIL %dx%d size %d\n", width, height, size);
+        }
+        UArray2_free(&a);
+        free(written);
+        return ok;
+}
+
+int main(void)
+{
+        static const int shapes[][2] = {
+                { 1, 1 }, { 7, 3 }, { 1, 3000 }, { 45, 31 },
+                { 333, 77 }, { 1000, 41 }
+        };
+        static const int sizes[] = { 1, 4, 12, 4096, 5000 };
+        int nshapes = sizeof(shapes) / sizeof(shapes[0]);
+        bool ok = true;
+
+        srand(56);
+        for (int s = 0; s < nshapes; s++) {
+                for (int z = 0; z < 5; z++) {
+                        if ((long)shapes[s][0] * shapes[s][1] *
+                            sizes[z] <= MAX_BYTES) {
+                                ok &= check_shape(shapes[s][0],
+                                                  shapes[s][1],
+                                                  sizes[z]);
+                        }
+                }
+        }
+
+        printf("The sparse arrays are %sOK!\n", ok ? "" : "NOT ");
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,162 @@
+/*
+ * usestencil.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/17/2026
+ *
+ * Purpose: Checks UArray2_map_stencil. For arrays of several
+ *          shapes (including ones narrower or shorter than the
+ *          stencil), radii, border modes and layouts, checks that
+ *          apply is called exactly once per element and that every
+ *          neighbour it is shown holds the value the border mode
+ *          promises.
+ *
+ * Key Insight: Element (col, row) holds 1000 * row + col + 1, so
+ *          a neighbour's value says exactly which element it came
+ *          from, and 0 can only mean a constant border.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <uarray2.h>
+
+/*
+ * One stencil run being checked.
+ */
+typedef struct Check {
+        int radius;
+        UArray2_border mode;
+        int *visits;          /* calls per element, row-major */
+        bool ok;
+} Check;
+
+/*
+ * name: expected
+ *
+ * description: Returns the value the stencil must show for
+ * position (col, row), which may lie outside the array.
+ */
+static int expected(int col, int row, int width, int height,
+                    UArray2_border mode)
+{
+        if (col < 0 || col >= width || row < 0 || row >= height) {
+                if (mode == UARRAY2_BORDER_CONSTANT) {
+                        return 0;
+                }
+                if (mode == UARRAY2_BORDER_WRAP) {
+                        col = (col % width + width) % width;
+                        row = (row % height + height) % height;
+                } else {
+                        col = col < 0 ? 0 : col >= width ? width - 1
+                                                         : col;
+                        row = row < 0 ? 0 : row >= height ? height - 1
+                                                          : row;
+                }
+        }
+        return 1000 * row + col + 1;
+}
+
+/*
+ * name: fill
+ *
+ * description: Apply function storing each element's position.
+ */
+static void fill(int col, int row, UArray2_T a, void *elem, void *cl)
+{
+        (void)a;
+        (void)cl;
+        *(int *)elem = 1000 * row + col + 1;
+}
+
+/*
+ * name: check_cell
+ *
+ * description: Stencil function checking every neighbour of
+ * (col, row) and counting the call.
+ */
+static void check_cell(int col, int row, UArray2_T a,
+                       const void *center, long pitch, void *cl)
+{
+        Check *check = cl;
+        int width  = UArray2_width(a);
+        int height = UArray2_height(a);
+        int r = check->radius;
+
+        check->visits[row * width + col]++;
+        for (int dr = -r; dr <= r; dr++) {
+                for (int dc = -r; dc <= r; dc++) {
+                        const char *row_n = (const char *)center +
+                                            dr * pitch;
+                        const int *n = (const int *)row_n + dc;
+                        check->ok &= *n == expected(col + dc, row + dr,
+                                                    width, height,
+                                                    check->mode);
+                }
+        }
+}
+
+/*
+ * name: check_run
+ *
+ * description: Runs one stencil over a and returns whether every
+ * element was visited once with correct neighbours.
+ */
+static bool check_run(UArray2_T a, int radius, UArray2_border mode)
+{
+        int cells = UArray2_width(a) * UArray2_height(a);
+        Check check;
+        check.radius = radius;
+        check.mode   = mode;
+        check.visits = calloc(cells, sizeof(int));
+        check.ok     = true;
+
+        UArray2_map_stencil(a, radius, mode, check_cell, &check);
+        for (int i = 0; i < cells; i++) {
+                check.ok &= check.visits[i] == 1;
+        }
+        free(check.visits);
+        return check.ok;
+}
+
+int main(void)
+{
+        static const int shapes[][2] = {
+                { 3, 10 }, { 10, 3 }, { 1, 1 }, { 2, 5 }, { 7, 9 },
+                { 16, 16 }
+        };
+        int nshapes = sizeof(shapes) / sizeof(shapes[0]);
+        bool ok = true;
+
+        for (int s = 0; s < nshapes; s++) {
+                int width  = shapes[s][0];
+                int height = shapes[s][1];
+                UArray2_T arrays[2] = {
+                        UArray2_new(width, height, sizeof(int)),
+                        UArray2_new_morton(width, height, sizeof(int))
+                };
+                for (int i = 0; i < 2; i++) {
+                        UArray2_map_row_major(arrays[i], fill, NULL);
+                        for (int radius = 0; radius <= 3; radius++) {
+                                for (int mode = UARRAY2_BORDER_CLAMP;
+                                     mode <= UARRAY2_BORDER_CONSTANT;
+                                     mode++) {
+                                        if (check_run(arrays[i], radius,
+                                                      mode)) {
+                                                continue;
+                                        }
+                                        printf("FAIL %dx%d layout %d "
+                                               "radius %d mode %d\n",
+                                               width, height, i,
+                                               radius, mode);
+                                        ok = false;
+                                }
+                        }
+                        UArray2_free(&arrays[i]);
+                }
+        }
+
+        printf("The stencil is %sOK!\n", ok ? "" : "NOT ");
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
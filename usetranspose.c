@@ -0,0 +1,159 @@
+/*
+ * usetranspose.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/17/2026
+ *
+ * Purpose: Checks UArray2_transpose and UArray2_transpose_in_place
+ *          on arrays of many shapes (single rows and columns, odd
+ *          sizes, and ones big enough for several levels of
+ *          recursive blocking), element sizes 1, 2, 4, 8, an odd 12
+ *          and a 100 wider than the in-place swap chunk, and flat,
+ *          Morton and view sources.
+ *
+ * Key Insight: Every byte of element (col, row) is a function of
+ *          col, row and the byte's index, so a transposed element
+ *          that came from the wrong place, or was copied only in
+ *          part, does not match.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <uarray2.h>
+
+/*
+ * name: byte_of
+ *
+ * description: Returns byte i of the element stored at (col, row)
+ * before any transpose.
+ */
+static unsigned char byte_of(int col, int row, int i)
+{
+        return (unsigned char)(col * 7 + row * 131 + i * 29);
+}
+
+/*
+ * name: fill
+ *
+ * description: Apply function storing each element's pattern.
+ */
+static void fill(int col, int row, UArray2_T a, void *elem, void *cl)
+{
+        (void)cl;
+        for (int i = 0; i < UArray2_size(a); i++) {
+                ((unsigned char *)elem)[i] = byte_of(col, row, i);
+        }
+}
+
+/*
+ * name: is_transpose
+ *
+ * description: Returns whether t is the transpose of an array
+ * filled by fill: element (row, col) of t holds the pattern of
+ * (col, row).
+ */
+static bool is_transpose(UArray2_T t, int width, int height, int size)
+{
+        bool ok = UArray2_width(t) == height &&
+                  UArray2_height(t) == width &&
+                  UArray2_size(t) == size;
+
+        for (int row = 0; row < height && ok; row++) {
+                for (int col = 0; col < width; col++) {
+                        const unsigned char *elem =
+                                UArray2_get(t, row, col);
+                        for (int i = 0; i < size; i++) {
+                                ok &= elem[i] == byte_of(col, row, i);
+                        }
+                }
+        }
+        return ok;
+}
+
+/*
+ * name: check_shape
+ *
+ * description: Transposes width by height arrays of the given
+ * element size, flat and Morton, and, if square, in place;
+ * prints and returns false on any mismatch.
+ */
+static bool check_shape(int width, int height, int size)
+{
+        bool ok = true;
+
+        for (int morton = 0; morton <= 1; morton++) {
+                UArray2_T a = morton
+                        ? UArray2_new_morton(width, height, size)
+                        : UArray2_new(width, height, size);
+                UArray2_map_row_major(a, fill, NULL);
+                UArray2_T t = UArray2_transpose(a);
+                if (!is_transpose(t, width, height, size)) {
+                        printf("FAIL %dx%d size %d layout %d\n",
+                               width, height, size, morton);
+                        ok = false;
+                }
+                UArray2_free(&t);
+                UArray2_free(&a);
+        }
+
+        if (width == height) {
+                UArray2_T a = UArray2_new(width, height, size);
+                UArray2_map_row_major(a, fill, NULL);
+                UArray2_transpose_in_place(a);
+                if (!is_transpose(a, width, height, size)) {
+                        printf("FAIL in place %dx%d size %d\n",
+                               width, height, size);
+                        ok = false;
+                }
+                UArray2_free(&a);
+        }
+        return ok;
+}
+
+/*
+ * name: check_view
+ *
+ * description: Transposes a view into the middle of a larger
+ * array, whose rows are not contiguous.
+ */
+static bool check_view(void)
+{
+        UArray2_T parent = UArray2_new(90, 70, 4);
+        UArray2_T view   = UArray2_view(parent, 5, 3, 61, 47);
+        UArray2_map_row_major(view, fill, NULL);
+        UArray2_T t = UArray2_transpose(view);
+        bool ok = is_transpose(t, 61, 47, 4);
+
+        UArray2_free(&t);
+        UArray2_free(&view);
+        UArray2_free(&parent);
+        return ok;
+}
+
+int main(void)
+{
+        static const int shapes[][2] = {
+                { 1, 1 }, { 1, 40 }, { 40, 1 }, { 2, 3 }, { 17, 5 },
+                { 33, 33 }, { 64, 64 }, { 100, 100 }, { 130, 67 },
+                { 257, 129 }
+        };
+        static const int sizes[] = { 1, 2, 4, 8, 12, 100 };
+        int nshapes = sizeof(shapes) / sizeof(shapes[0]);
+        bool ok = true;
+
+        for (int s = 0; s < nshapes; s++) {
+                for (int z = 0; z < 6; z++) {
+                        ok &= check_shape(shapes[s][0], shapes[s][1],
+                                          sizes[z]);
+                }
+        }
+        if (!check_view()) {
+                printf("FAIL view\n");
+                ok = false;
+        }
+
+        printf("The transposes are %sOK!\n", ok ? "" : "NOT ");
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,310 @@
+/*
+ * usetyped.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/18/2026
+ *
+ * Purpose: Checks the typed front ends of uarray2typed.h, for every
+ *          instance declared there and for a struct type declared
+ *          here. On flat, padded, view, Morton and sparse arrays,
+ *          name_set must store what UArray2_get then reads, and
+ *          name_at, name_get and the name_fast_* accessors must
+ *          agree with UArray2_at. On the row-major layouts,
+ *          name_row must point at contiguous elements of its row,
+ *          and the typed maps must visit the same elements in the
+ *          same order as the UArray2 maps. Element size mismatches,
+ *          rows of a Morton array and out-of-bounds indices must be
+ *          checked runtime errors.
+ *
+ * Key Insight: CHECK_TYPED generates one check per instance from
+ *          the same text, as DECLARE_UARRAY2 generates the
+ *          instances, so every type gets exactly the same checks.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <uarray2typed.h>
+
+#define NBAD 8              /* bad calls made by bad_call */
+
+/*
+ * An element type wider than any built-in instance, with padding
+ * the checks must not depend on.
+ */
+struct Cell {
+        double weight;
+        short label;
+};
+
+DECLARE_UARRAY2(Cells, struct Cell)
+
+/*
+ * Closure for the typed map checks: the array, whether the map is
+ * column-major, the position the next call must have, and whether
+ * all is well so far.
+ */
+struct Order {
+        UArray2_T array;
+        bool col_major;
+        int col;
+        int row;
+        bool ok;
+};
+
+/*
+ * name: advance
+ *
+ * description: Checks that the call at (col, row) with elem is the
+ * one o expects, then moves o on to the next position of its
+ * order.
+ */
+static void advance(struct Order *o, int col, int row, void *elem)
+{
+        int width  = UArray2_width(o->array);
+        int height = UArray2_height(o->array);
+
+        o->ok &= col == o->col && row == o->row &&
+                 elem == UArray2_at(o->array, col, row);
+        if (o->col_major) {
+                if (++o->row == height) {
+                        o->row = 0;
+                        o->col++;
+                }
+        } else if (++o->col == width) {
+                o->col = 0;
+                o->row++;
+        }
+}
+
+/*
+ * name: cell_of
+ *
+ * description: Returns the struct Cell stored at (col, row).
+ */
+static struct Cell cell_of(int col, int row)
+{
+        struct Cell c;
+
+        memset(&c, 0, sizeof(c));
+        c.weight = col * 0.5 + row;
+        c.label  = (short)(col - row);
+        return c;
+}
+
+/*
+ * name: same_cell
+ *
+ * description: Returns whether a and b hold the same fields.
+ */
+static bool same_cell(struct Cell a, struct Cell b)
+{
+        return a.weight == b.weight && a.label == b.label;
+}
+
+/*
+ * CHECK_TYPED(name, type, value, same) defines check_name(array,
+ * rows), which runs every check of the name_* front end on array,
+ * whose elements are type; value(col, row) gives the element
+ * stored at (col, row) and same(a, b) compares two elements. The
+ * row and map checks run only if rows is true.
+ */
+#define CHECK_TYPED(name, type, value, same)                           \
+                                                                       \
+static void order_##name(int col, int row, UArray2_T array,            \
+                         type *elem, void *cl)                         \
+{                                                                      \
+        (void)array;                                                   \
+        advance(cl, col, row, elem);                                   \
+}                                                                      \
+                                                                       \
+static bool check_##name(UArray2_T array, bool rows)                   \
+{                                                                      \
+        int width  = UArray2_width(array);                             \
+        int height = UArray2_height(array);                            \
+        bool ok = true;                                                \
+                                                                       \
+        for (int row = 0; row < height; row++) {                       \
+                for (int col = 0; col < width; col++) {                \
+                        name##_set(array, col, row, value(col, row));  \
+                }                                                      \
+        }                                                              \
+        for (int row = 0; row < height; row++) {                       \
+                for (int col = 0; col < width; col++) {                \
+                        type want = value(col, row);                   \
+                        type seen;                                     \
+                        memcpy(&seen, UArray2_get(array, col, row),    \
+                               sizeof(type));                          \
+                        ok &= same(seen, want);                        \
+                        ok &= same(name##_get(array, col, row), want); \
+                        ok &= same(name##_fast_get(array, col, row),   \
+                                   want);                              \
+                        ok &= (void *)name##_at(array, col, row) ==    \
+                              UArray2_at(array, col, row);             \
+                        ok &= (void *)name##_fast_at(array, col,       \
+                                                     row) ==           \
+                              UArray2_at(array, col, row);             \
+                }                                                      \
+        }                                                              \
+        name##_fast_set(array, width - 1, height - 1, value(0, 0));    \
+        ok &= same(name##_get(array, width - 1, height - 1),           \
+                   value(0, 0));                                       \
+        if (!rows) {                                                   \
+                return ok;                                             \
+        }                                                              \
+                                                                       \
+        for (int row = 0; row < height; row++) {                       \
+                type *line = name##_row(array, row);                   \
+                ok &= line == name##_fast_row(array, row);             \
+                for (int col = 0; col < width; col++) {                \
+                        ok &= (void *)&line[col] ==                    \
+                              UArray2_at(array, col, row);             \
+                }                                                      \
+        }                                                              \
+        struct Order by_rows = { array, false, 0, 0, true };           \
+        struct Order by_cols = { array, true, 0, 0, true };            \
+        name##_map_row_major(array, order_##name, &by_rows);           \
+        name##_map_col_major(array, order_##name, &by_cols);           \
+        ok &= by_rows.ok && by_rows.row == height;                     \
+        ok &= by_cols.ok && by_cols.col == width;                      \
+        return ok;                                                     \
+}
+
+#define VALUE_OF(type, col, row) ((type)((col) * 3 + (row) * 5 + 1))
+#define INT_OF(col, row)    VALUE_OF(int, col, row)
+#define U8_OF(col, row)     VALUE_OF(uint8_t, col, row)
+#define U16_OF(col, row)    VALUE_OF(uint16_t, col, row)
+#define FLOAT_OF(col, row)  VALUE_OF(float, col, row)
+#define DOUBLE_OF(col, row) VALUE_OF(double, col, row)
+#define SAME(a, b)          ((a) == (b))
+
+CHECK_TYPED(UArray2_int, int, INT_OF, SAME)
+CHECK_TYPED(UArray2_u8, uint8_t, U8_OF, SAME)
+CHECK_TYPED(UArray2_u16, uint16_t, U16_OF, SAME)
+CHECK_TYPED(UArray2_float, float, FLOAT_OF, SAME)
+CHECK_TYPED(UArray2_double, double, DOUBLE_OF, SAME)
+CHECK_TYPED(Cells, struct Cell, cell_of, same_cell)
+
+/*
+ * name: check_layouts
+ *
+ * description: Runs check on width by height arrays of size-byte
+ * elements in every layout, printing each failure.
+ */
+static bool check_layouts(const char *what, int size, int width,
+                          int height, bool (*check)(UArray2_T, bool))
+{
+        UArray2_T parent = UArray2_new(width + 3, height + 2, size);
+        UArray2_T arrays[] = {
+                UArray2_new(width, height, size),
+                UArray2_new_padded(width, height, size, 1),
+                UArray2_view(parent, 2, 1, width, height),
+                UArray2_new_morton(width, height, size),
+                UArray2_new_sparse(width, height, size)
+        };
+        bool ok = true;
+
+        for (int i = 0; i < 5; i++) {
+                if (!check(arrays[i], i < 3)) {
+                        printf("FAIL %s %dx%d layout %d\n", what,
+                               width, height, i);
+                        ok = false;
+                }
+        }
+        for (int i = 4; i >= 0; i--) {
+                UArray2_free(&arrays[i]);
+        }
+        UArray2_free(&parent);
+        return ok;
+}
+
+/*
+ * name: bad_call
+ *
+ * description: Makes the bad call numbered which, each a checked
+ * runtime error.
+ */
+static void bad_call(int which)
+{
+        UArray2_T ints   = UArray2_int_new(5, 4);
+        UArray2_T bytes  = UArray2_u8_new(5, 4);
+        UArray2_T morton = UArray2_new_morton(5, 4, sizeof(int));
+
+        switch (which) {
+        case 0: UArray2_int_at(bytes, 0, 0);                 break;
+        case 1: UArray2_u8_get(ints, 0, 0);                  break;
+        case 2: UArray2_double_set(ints, 0, 0, 1.0);         break;
+        case 3: UArray2_int_row(morton, 0);                  break;
+        case 4: UArray2_int_row(ints, 4);                    break;
+        case 5: UArray2_int_get(ints, 5, 0);                 break;
+        case 6: UArray2_int_at(ints, 0, -1);                 break;
+        case 7: Cells_map_col_major(ints, order_Cells, NULL); break;
+        }
+}
+
+/*
+ * name: dies
+ *
+ * description: Makes bad call which in a child process, with its
+ * standard error discarded, and returns whether the child was
+ * killed by a signal rather than exiting.
+ */
+static bool dies(int which)
+{
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0) {
+                if (freopen("/dev/null", "w", stderr) == NULL) {
+                        _exit(0);
+                }
+                bad_call(which);
+                _exit(0);
+        }
+        int status;
+        if (pid < 0 || waitpid(pid, &status, 0) != pid) {
+                return false;
+        }
+        return WIFSIGNALED(status);
+}
+
+int main(void)
+{
+        static const int shapes[][2] = {
+                { 1, 1 }, { 1, 9 }, { 9, 1 }, { 17, 13 }, { 130, 70 }
+        };
+        int nshapes = sizeof(shapes) / sizeof(shapes[0]);
+        bool ok = true;
+
+        for (int s = 0; s < nshapes; s++) {
+                int w = shapes[s][0];
+                int h = shapes[s][1];
+                ok &= check_layouts("int", sizeof(int), w, h,
+                                    check_UArray2_int);
+                ok &= check_layouts("u8", sizeof(uint8_t), w, h,
+                                    check_UArray2_u8);
+                ok &= check_layouts("u16", sizeof(uint16_t), w, h,
+                                    check_UArray2_u16);
+                ok &= check_layouts("float", sizeof(float), w, h,
+                                    check_UArray2_float);
+                ok &= check_layouts("double", sizeof(double), w, h,
+                                    check_UArray2_double);
+                ok &= check_layouts("struct", sizeof(struct Cell), w,
+                                    h, check_Cells);
+        }
+        for (int which = 0; which < NBAD; which++) {
+                if (!dies(which)) {
+                        printf("FAIL bad call %d was allowed\n",
+                               which);
+                        ok = false;
+                }
+        }
+
+        printf("The typed accessors are %sOK!\n", ok ? "" : "NOT ");
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
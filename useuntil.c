@@ -0,0 +1,264 @@
+/*
+ * useuntil.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/18/2026
+ *
+ * Purpose: Checks the stopping maps UArray2_map_row_major_until,
+ *          UArray2_map_col_major_until, Bit2_map_row_major_until
+ *          and Bit2_map_col_major_until. Each is stopped at the
+ *          first, last and several other positions, and at the
+ *          first 1 bit of sparse bitmaps, and must return exactly
+ *          that position, having called apply for every earlier
+ *          element in order and for none after it; a map that is
+ *          never stopped must visit everything and return
+ *          {-1, -1}.
+ *
+ * Key Insight: The apply function counts its calls and checks
+ *          each position against the next one of a plain
+ *          row-major or column-major loop, so a map that skips,
+ *          repeats or runs on past the stop is caught by the count
+ *          even when it returns the right position.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <uarray2.h>
+#include <bit2.h>
+
+/*
+ * Closure for the stop functions: the array's shape and order,
+ * the position to stop at ({-1, -1}: never, {-2, -2}: at the
+ * first 1 bit), the calls made so far, and whether all is well.
+ */
+struct Walk {
+        int width;
+        int height;
+        bool col_major;
+        int stop_col;
+        int stop_row;
+        long calls;
+        bool ok;
+};
+
+/*
+ * name: expect_position
+ *
+ * description: Checks that (col, row) is the next position of w's
+ * walk and counts the call.
+ */
+static void expect_position(struct Walk *w, int col, int row)
+{
+        long index = w->col_major ? (long)col * w->height + row
+                                  : (long)row * w->width + col;
+
+        w->ok &= index == w->calls;
+        w->calls++;
+}
+
+/*
+ * name: stop_uarray2
+ *
+ * description: UArray2_stopfun stopping at w's stop position.
+ */
+static int stop_uarray2(int col, int row, UArray2_T a, void *elem,
+                        void *cl)
+{
+        struct Walk *w = cl;
+
+        expect_position(w, col, row);
+        w->ok &= elem == UArray2_at(a, col, row);
+        return col == w->stop_col && row == w->stop_row
+                ? UARRAY2_STOP : UARRAY2_CONTINUE;
+}
+
+/*
+ * name: stop_bit2
+ *
+ * description: Bit2_stopfun stopping at w's stop position, or at
+ * the first 1 bit.
+ */
+static int stop_bit2(int col, int row, Bit2_T bits, int elem,
+                     void *cl)
+{
+        struct Walk *w = cl;
+
+        expect_position(w, col, row);
+        w->ok &= elem == Bit2_get(bits, col, row);
+        if (w->stop_col == -2) {
+                return elem ? BIT2_STOP : BIT2_CONTINUE;
+        }
+        return col == w->stop_col && row == w->stop_row
+                ? BIT2_STOP : BIT2_CONTINUE;
+}
+
+/*
+ * name: expect_stop
+ *
+ * description: Returns whether a walk that returned (col, row)
+ * stopped where w asked, after the right number of calls; want
+ * is the stop position found by a plain loop.
+ */
+static bool expect_stop(struct Walk *w, int col, int row,
+                        int want_col, int want_row)
+{
+        long length = (long)w->width * w->height;
+
+        if (want_col < 0) {
+                return w->ok && col == -1 && row == -1 &&
+                       w->calls == length;
+        }
+        long index = w->col_major
+                ? (long)want_col * w->height + want_row
+                : (long)want_row * w->width + want_col;
+        return w->ok && col == want_col && row == want_row &&
+               w->calls == index + 1;
+}
+
+/*
+ * name: first_one
+ *
+ * description: Finds the first 1 bit of bits in the given order
+ * with a plain loop; sets *col and *row to it, or to -1 if there
+ * is none.
+ */
+static void first_one(Bit2_T bits, bool col_major, int *col, int *row)
+{
+        int width  = Bit2_width(bits);
+        int height = Bit2_height(bits);
+        long length = (long)width * height;
+
+        for (long i = 0; i < length; i++) {
+                int c = (int)(col_major ? i / height : i % width);
+                int r = (int)(col_major ? i % height : i / width);
+                if (Bit2_get(bits, c, r)) {
+                        *col = c;
+                        *row = r;
+                        return;
+                }
+        }
+        *col = -1;
+        *row = -1;
+}
+
+/*
+ * name: check_shape
+ *
+ * description: Runs every stopping map over width by height
+ * arrays and bitmaps, stopping at each of a set of positions and
+ * never, printing each failure.
+ */
+static bool check_shape(int width, int height)
+{
+        int stops[][2] = {
+                { 0, 0 }, { width - 1, height - 1 }, { width - 1, 0 },
+                { 0, height - 1 }, { width / 2, height / 3 },
+                { rand() % width, rand() % height }, { -1, -1 }
+        };
+        int nstops = sizeof(stops) / sizeof(stops[0]);
+        UArray2_T parent = UArray2_new(width + 2, height + 4, 2);
+        UArray2_T arrays[] = {
+                UArray2_new(width, height, 2),
+                UArray2_new_padded(width, height, 2, 1),
+                UArray2_view(parent, 1, 3, width, height),
+                UArray2_new_morton(width, height, 2),
+                UArray2_new_sparse(width, height, 2)
+        };
+        Bit2_T bits = Bit2_new(width, height);
+        bool ok = true;
+
+        for (int s = 0; s < nstops; s++) {
+                for (int cm = 0; cm <= 1; cm++) {
+                        int col = stops[s][0];
+                        int row = stops[s][1];
+                        for (int i = 0; i < 5; i++) {
+                                struct Walk w = { width, height, cm,
+                                                  col, row, 0, true };
+                                UArray2_pos p = cm
+                                        ? UArray2_map_col_major_until(
+                                                  arrays[i],
+                                                  stop_uarray2, &w)
+                                        : UArray2_map_row_major_until(
+                                                  arrays[i],
+                                                  stop_uarray2, &w);
+                                if (!expect_stop(&w, p.col, p.row, col,
+                                                 row)) {
+                                        printf("FAIL %dx%d layout %d "
+                                               "order %d stop (%d, "
+                                               "%d)\n", width, height,
+                                               i, cm, col, row);
+                                        ok = false;
+                                }
+                        }
+                        struct Walk w = { width, height, cm, col, row,
+                                          0, true };
+                        Bit2_pos p = cm
+                                ? Bit2_map_col_major_until(bits,
+                                                           stop_bit2,
+                                                           &w)
+                                : Bit2_map_row_major_until(bits,
+                                                           stop_bit2,
+                                                           &w);
+                        if (!expect_stop(&w, p.col, p.row, col, row)) {
+                                printf("FAIL bitmap %dx%d order %d "
+                                       "stop (%d, %d)\n", width,
+                                       height, cm, col, row);
+                                ok = false;
+                        }
+                }
+        }
+
+        /* Stop at the first 1 bit, with zero words before it */
+        for (int ones = 0; ones <= 2; ones++) {
+                if (ones > 0) {
+                        Bit2_put(bits, rand() % width,
+                                 rand() % height, 1);
+                }
+                for (int cm = 0; cm <= 1; cm++) {
+                        int col, row;
+                        first_one(bits, cm, &col, &row);
+                        struct Walk w = { width, height, cm, -2, -2, 0,
+                                          true };
+                        Bit2_pos p = cm
+                                ? Bit2_map_col_major_until(bits,
+                                                           stop_bit2,
+                                                           &w)
+                                : Bit2_map_row_major_until(bits,
+                                                           stop_bit2,
+                                                           &w);
+                        if (!expect_stop(&w, p.col, p.row, col, row)) {
+                                printf("FAIL bitmap %dx%d order %d "
+                                       "first 1 bit\n", width, height,
+                                       cm);
+                                ok = false;
+                        }
+                }
+        }
+
+        Bit2_free(&bits);
+        for (int i = 4; i >= 0; i--) {
+                UArray2_free(&arrays[i]);
+        }
+        UArray2_free(&parent);
+        return ok;
+}
+
+int main(void)
+{
+        static const int shapes[][2] = {
+                { 1, 1 }, { 1, 9 }, { 9, 1 }, { 7, 5 }, { 63, 4 },
+                { 64, 7 }, { 65, 3 }, { 200, 130 }
+        };
+        int nshapes = sizeof(shapes) / sizeof(shapes[0]);
+        bool ok = true;
+
+        srand(69);
+        for (int s = 0; s < nshapes; s++) {
+                ok &= check_shape(shapes[s][0], shapes[s][1]);
+        }
+
+        printf("The stopping maps are %sOK!\n", ok ? "" : "NOT ");
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
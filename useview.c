@@ -0,0 +1,232 @@
+/*
+ * useview.c
+ *
+ * Authors: Toye Adebayo & Teny Makuach
+ * Date: 10/18/2026
+ *
+ * Purpose: Checks UArray2_view. A view's elements must be its
+ *          parent's elements, not copies: writes through the view,
+ *          through a view of the view, or through the parent must
+ *          be seen by all of them, and writes through a view must
+ *          not touch the parent outside the view's rectangle. The
+ *          views' own bounds must be enforced: reaching past a
+ *          view's edge, or making a view that does not fit, is a
+ *          checked runtime error even where the parent has the
+ *          element.
+ *
+ * Key Insight: A checked runtime error ends the process, so each
+ *          bad call is made in a child process, which must die
+ *          rather than exit normally.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <uarray2.h>
+
+#define WIDTH  37           /* parent width */
+#define HEIGHT 23           /* parent height */
+#define NBAD   10           /* bad calls made by bad_call */
+
+/*
+ * name: value_of
+ *
+ * description: Returns the int first stored at parent element
+ * (col, row).
+ */
+static int value_of(int col, int row)
+{
+        return col * 1000 + row;
+}
+
+/*
+ * name: fill
+ *
+ * description: Apply function storing value_of each element.
+ */
+static void fill(int col, int row, UArray2_T a, void *elem, void *cl)
+{
+        (void)a;
+        (void)cl;
+        *(int *)elem = value_of(col, row);
+}
+
+/*
+ * name: negate
+ *
+ * description: Apply function negating each element.
+ */
+static void negate(int col, int row, UArray2_T a, void *elem, void *cl)
+{
+        (void)col;
+        (void)row;
+        (void)a;
+        (void)cl;
+        *(int *)elem = -*(int *)elem;
+}
+
+/*
+ * name: in_rect
+ *
+ * description: Returns whether (col, row) lies in the width by
+ * height rectangle at (col0, row0).
+ */
+static bool in_rect(int col, int row, int col0, int row0, int width,
+                    int height)
+{
+        return col >= col0 && col < col0 + width &&
+               row >= row0 && row < row0 + height;
+}
+
+/*
+ * name: check_alias
+ *
+ * description: Checks a width by height view at (col0, row0) of a
+ * flat or padded parent, and a view of that view; prints and
+ * returns false on any mismatch.
+ */
+static bool check_alias(int padded, int col0, int row0, int width,
+                        int height)
+{
+        UArray2_T parent = padded
+                ? UArray2_new_padded(WIDTH, HEIGHT, sizeof(int), 2)
+                : UArray2_new(WIDTH, HEIGHT, sizeof(int));
+        UArray2_map_row_major(parent, fill, NULL);
+        UArray2_T view = UArray2_view(parent, col0, row0, width,
+                                      height);
+        bool ok = UArray2_width(view) == width &&
+                  UArray2_height(view) == height &&
+                  UArray2_size(view) == (int)sizeof(int);
+
+        /* The same storage, not a copy */
+        for (int row = 0; row < height; row++) {
+                for (int col = 0; col < width; col++) {
+                        ok &= UArray2_at(view, col, row) ==
+                              UArray2_at(parent, col0 + col,
+                                         row0 + row);
+                }
+        }
+
+        /* Writes through the view reach only its rectangle */
+        UArray2_map_col_major(view, negate, NULL);
+        for (int row = 0; row < HEIGHT; row++) {
+                for (int col = 0; col < WIDTH; col++) {
+                        int value = *(int *)UArray2_at(parent, col,
+                                                       row);
+                        int want  = value_of(col, row);
+                        if (in_rect(col, row, col0, row0, width,
+                                    height)) {
+                                want = -want;
+                        }
+                        ok &= value == want;
+                }
+        }
+
+        /* A view of the view, and writes through the parent */
+        UArray2_T inner = UArray2_view(view, width / 2, height / 2,
+                                       width - width / 2,
+                                       height - height / 2);
+        *(int *)UArray2_at(parent, col0 + width - 1,
+                           row0 + height - 1) = 7;
+        ok &= *(int *)UArray2_at(inner, UArray2_width(inner) - 1,
+                                 UArray2_height(inner) - 1) == 7;
+        *(int *)UArray2_at(inner, 0, 0) = 9;
+        ok &= *(int *)UArray2_at(view, width / 2, height / 2) == 9;
+        ok &= *(int *)UArray2_at(parent, col0 + width / 2,
+                                 row0 + height / 2) == 9;
+
+        UArray2_free(&inner);
+        UArray2_free(&view);
+        UArray2_free(&parent);
+        if (!ok) {
+                printf("FAIL alias %dx%d at (%d, %d) padded %d\n",
+                       width, height, col0, row0, padded);
+        }
+        return ok;
+}
+
+/*
+ * name: bad_call
+ *
+ * description: Makes the bad call numbered which, each a checked
+ * runtime error, on a view at (5, 4) of size 10 by 6 or on a new
+ * view of the parent.
+ */
+static void bad_call(int which)
+{
+        UArray2_T parent = UArray2_new(WIDTH, HEIGHT, sizeof(int));
+        UArray2_T view   = UArray2_view(parent, 5, 4, 10, 6);
+        UArray2_T sparse = UArray2_new_sparse(WIDTH, HEIGHT, 1);
+
+        switch (which) {
+        case 0: UArray2_at(view, 10, 0);                     break;
+        case 1: UArray2_at(view, 0, 6);                      break;
+        case 2: UArray2_at(view, -1, 0);                     break;
+        case 3: UArray2_get(view, 0, -1);                    break;
+        case 4: UArray2_view(parent, WIDTH - 3, 0, 4, 1);    break;
+        case 5: UArray2_view(parent, 0, HEIGHT - 1, 1, 2);   break;
+        case 6: UArray2_view(parent, -1, 0, 1, 1);           break;
+        case 7: UArray2_view(view, 1, 1, 10, 1);             break;
+        case 8: UArray2_view(parent, 0, 0, 0, 1);            break;
+        case 9: UArray2_view(sparse, 0, 0, 1, 1);            break;
+        }
+}
+
+/*
+ * name: dies
+ *
+ * description: Makes bad call which in a child process, with its
+ * standard error discarded, and returns whether the child was
+ * killed by a signal rather than exiting.
+ */
+static bool dies(int which)
+{
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0) {
+                if (freopen("/dev/null", "w", stderr) == NULL) {
+                        _exit(0);
+                }
+                bad_call(which);
+                _exit(0);
+        }
+        int status;
+        if (pid < 0 || waitpid(pid, &status, 0) != pid) {
+                return false;
+        }
+        return WIFSIGNALED(status);
+}
+
+int main(void)
+{
+        static const int rects[][4] = {
+                { 0, 0, WIDTH, HEIGHT }, { 0, 0, 1, 1 },
+                { WIDTH - 1, HEIGHT - 1, 1, 1 }, { 5, 4, 10, 6 },
+                { 3, 0, 1, HEIGHT }, { 0, 11, WIDTH, 1 }
+        };
+        int nrects = sizeof(rects) / sizeof(rects[0]);
+        bool ok = true;
+
+        for (int padded = 0; padded <= 1; padded++) {
+                for (int r = 0; r < nrects; r++) {
+                        ok &= check_alias(padded, rects[r][0],
+                                          rects[r][1], rects[r][2],
+                                          rects[r][3]);
+                }
+        }
+        for (int which = 0; which < NBAD; which++) {
+                if (!dies(which)) {
+                        printf("FAIL bad call %d was allowed\n",
+                               which);
+                        ok = false;
+                }
+        }
+
+        printf("The views are %sOK!\n", ok ? "" : "NOT ");
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}